@@ -0,0 +1,100 @@
+#include "ai.h"
+#include "physics.h"
+#include <cmath>
+
+// Boats sail stern-first relative to Boat.heading, so travel is heading + pi throughout
+
+void InitSkipperFleet(SkipperFleet& fleet, VMGCache& targets) {
+    fleet.count = 0;
+    fleet.targets = &targets;
+    
+    // Drive along the direction of travel for unit apparent wind; the best sheet doesn't
+    // depend on wind speed since the force scales with its square
+    for (int k = 0; k <= SHEET_TABLE_SIZE; k++) {
+        float awa = (float)k / SHEET_TABLE_SIZE * M_PI;
+        Vector2D apparent(-sinf(awa), -cosf(awa));    // travelling north with the wind from awa to starboard
+        float bestDrive = 0.0f, bestSheet = 1.0f;
+        for (int s = 0; s <= 100; s++) {
+            float drive = CalculateSailForce(apparent, M_PI, s / 100.0f).y;
+            if (drive > bestDrive) {
+                bestDrive = drive;
+                bestSheet = s / 100.0f;
+            }
+        }
+        fleet.sheetTable[k] = bestSheet;
+    }
+}
+
+int AddSkipper(SkipperFleet& fleet, int boatIndex) {
+    if (fleet.count >= MAX_BOATS) return -1;
+    int i = fleet.count++;
+    fleet.boat[i] = boatIndex;
+    fleet.side[i] = 1.0f;
+    fleet.sinceTack[i] = SKIPPER_MIN_TACK_INTERVAL;
+    fleet.targetCourse[i] = 0.0f;
+    return i;
+}
+
+// Closest sailable angle off the wind, on the given side, to the relative bearing
+static float SailableAngle(float relativeBearing, float side, float upwindTwa, float downwindTwa) {
+    float angle = fabsf(relativeBearing);
+    if (relativeBearing * side < 0.0f) angle = angle < M_PI / 2 ? 0.0f : M_PI;
+    return fminf(fmaxf(angle, upwindTwa), downwindTwa);
+}
+
+static float CourseVMG(const Boat& boat, float course, const Waypoint& waypoint) {
+    Boat probe = boat;
+    probe.vx = sinf(course);
+    probe.vy = cosf(course);
+    return CalculateVMG(probe, waypoint);
+}
+
+void UpdateSkippers(SkipperFleet& fleet, World& world, float dt) {
+    // Pass 1: tactics. Pick the tack or gybe with the better VMG to the next mark, with
+    // hysteresis so a skipper doesn't flip back and forth on a shifting breeze
+    for (int i = 0; i < fleet.count; i++) {
+        int index = fleet.boat[i];
+        const Boat& boat = world.boats[index];
+        Wind wind = GetBoatWind(world, index);
+        Vector2D apparent = GetApparentWind(wind, boat.vx, boat.vy);
+    
+        fleet.travel[i] = NormalizeAngle(boat.heading + M_PI);
+        fleet.awa[i] = fabsf(NormalizeAngle(atan2f(-apparent.x, -apparent.y) - fleet.travel[i]));
+        fleet.sinceTack[i] += dt;
+    
+        Waypoint waypoint = {0.0f, 0.0f, false};
+        if (world.course) waypoint = GetCourseWaypoint(*world.course, world.progress[index]);
+        if (!waypoint.active) {
+            fleet.targetCourse[i] = fleet.travel[i];
+            continue;
+        }
+    
+        float bearing = atan2f(waypoint.x - boat.x, waypoint.y - boat.y);
+        float relative = NormalizeAngle(bearing - wind.direction);
+        float upwindTwa = GetUpwindTarget(*fleet.targets, wind.speed).twa;
+        float downwindTwa = GetDownwindTarget(*fleet.targets, wind.speed).twa;
+        float side = fleet.side[i];
+        float current = wind.direction + side * SailableAngle(relative, side, upwindTwa, downwindTwa);
+        float other = wind.direction - side * SailableAngle(relative, -side, upwindTwa, downwindTwa);
+    
+        if (fleet.sinceTack[i] >= SKIPPER_MIN_TACK_INTERVAL &&
+            CourseVMG(boat, other, waypoint) > CourseVMG(boat, current, waypoint) + SKIPPER_TACK_MARGIN) {
+            fleet.side[i] = -side;
+            fleet.sinceTack[i] = 0.0f;
+            current = other;
+        }
+        fleet.targetCourse[i] = NormalizeAngle(current);
+    }
+    
+    // Pass 2: helm and trim, straight-line arithmetic over the arrays
+    for (int i = 0; i < fleet.count; i++) {
+        Boat& boat = world.boats[fleet.boat[i]];
+        float error = NormalizeAngle(fleet.targetCourse[i] - fleet.travel[i]);
+        boat.rudder = fminf(fmaxf(error * SKIPPER_RUDDER_GAIN, -1.0f), 1.0f);
+    
+        float bin = fleet.awa[i] / M_PI * SHEET_TABLE_SIZE;
+        int k = (int)bin;
+        if (k >= SHEET_TABLE_SIZE) k = SHEET_TABLE_SIZE - 1;
+        boat.sheet = fleet.sheetTable[k] + (fleet.sheetTable[k + 1] - fleet.sheetTable[k]) * (bin - k);
+    }
+}
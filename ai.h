@@ -0,0 +1,34 @@
+#ifndef AI_H
+#define AI_H
+
+#include "types.h"
+#include "world.h"
+#include "vmg.h"
+
+const int SHEET_TABLE_SIZE = 64;                          // apparent wind angle bins over 0..pi
+const float SKIPPER_RUDDER_GAIN = 2.0f;                   // rudder per radian of heading error
+const float SKIPPER_TACK_MARGIN = 0.05f;                  // VMG gain (fraction of speed) needed to tack or gybe
+const float SKIPPER_MIN_TACK_INTERVAL = 10.0f;            // seconds
+
+// Computer skippers for a whole fleet, structure-of-arrays so one pass reads the boats
+// and wind the physics just produced and writes back only rudder and sheet
+struct SkipperFleet {
+    int count;
+    int boat[MAX_BOATS];             // world boat index
+    float side[MAX_BOATS];           // +1 wind on the starboard side, -1 port
+    float sinceTack[MAX_BOATS];
+    float targetCourse[MAX_BOATS];   // direction of travel being steered
+    
+    // Scratch for the batched pass
+    float travel[MAX_BOATS];
+    float awa[MAX_BOATS];
+    
+    float sheetTable[SHEET_TABLE_SIZE + 1];   // drive-maximising sheet per apparent wind angle
+    VMGCache* targets;                        // upwind and downwind angles per wind speed
+};
+
+void InitSkipperFleet(SkipperFleet& fleet, VMGCache& targets);
+int AddSkipper(SkipperFleet& fleet, int boatIndex);
+void UpdateSkippers(SkipperFleet& fleet, World& world, float dt);
+
+#endif
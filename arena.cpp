@@ -0,0 +1,26 @@
+#include "arena.h"
+#include <cstdlib>
+
+void InitFrameArena(FrameArena& arena, size_t capacity) {
+    arena.memory = (unsigned char*)malloc(capacity);
+    arena.capacity = capacity;
+    arena.used = 0;
+}
+
+void FreeFrameArena(FrameArena& arena) {
+    free(arena.memory);
+    arena.memory = nullptr;
+    arena.capacity = 0;
+    arena.used = 0;
+}
+
+void ResetFrameArena(FrameArena& arena) {
+    arena.used = 0;
+}
+
+void* ArenaAlloc(FrameArena& arena, size_t size, size_t alignment) {
+    size_t start = (arena.used + alignment - 1) & ~(alignment - 1);
+    if (start + size > arena.capacity) return nullptr;
+    arena.used = start + size;
+    return arena.memory + start;
+}
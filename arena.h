@@ -0,0 +1,18 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+
+// Bump allocator reset once per frame; nothing allocated from it outlives the frame
+struct FrameArena {
+    unsigned char* memory;
+    size_t capacity;
+    size_t used;
+};
+
+void InitFrameArena(FrameArena& arena, size_t capacity);
+void FreeFrameArena(FrameArena& arena);
+void ResetFrameArena(FrameArena& arena);
+void* ArenaAlloc(FrameArena& arena, size_t size, size_t alignment = 16);
+
+#endif
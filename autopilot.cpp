@@ -0,0 +1,113 @@
+#include "autopilot.h"
+#include "physics.h"
+#include <cmath>
+
+// Boats sail stern-first relative to Boat.heading, so travel is heading + pi throughout
+
+static float HelmRudder(float heading, float course) {
+    float error = NormalizeAngle(course - (heading + M_PI));
+    return fminf(fmaxf(error * AUTOPILOT_RUDDER_GAIN, -1.0f), 1.0f);
+}
+
+void InitAutopilot(Autopilot& pilot, const Polar& polar, JobPool* pool) {
+    pilot.polar = &polar;
+    pilot.pool = pool;
+    pilot.mode = AUTOPILOT_OFF;
+    pilot.targetCourse = 0.0f;
+    pilot.sinceReplan = AUTOPILOT_INTERVAL;
+    pilot.course = 0.0f;
+    pilot.sheet = 0.5f;
+    pilot.best = 0;
+}
+
+// Holds the course the boat is making when engaged; replans on the next update
+void EngageAutopilot(Autopilot& pilot, const Boat& boat, AutopilotMode mode) {
+    pilot.mode = mode;
+    pilot.targetCourse = NormalizeAngle(boat.heading + M_PI);
+    pilot.sinceReplan = AUTOPILOT_INTERVAL;
+    pilot.course = pilot.targetCourse;
+    pilot.sheet = boat.sheet;
+}
+
+// One job: the candidates at one sheet level, as one batch
+static void RolloutJob(void* context, int job) {
+    Autopilot& pilot = *(Autopilot*)context;
+    const Boat& boat = pilot.start;
+    int first = job * AUTOPILOT_COURSE_OFFSETS;
+    BoatBatch& batch = pilot.rollouts[job];
+    FillBoatBatch(batch, boat, AUTOPILOT_COURSE_OFFSETS);
+    for (int i = 0; i < batch.count; i++) batch.sheet[i] = pilot.candidateSheet[first + i];
+    
+    for (int step = 0; step < AUTOPILOT_STEPS; step++) {
+        for (int i = 0; i < batch.count; i++) batch.rudder[i] = HelmRudder(batch.heading[i], pilot.candidateCourse[first + i]);
+        UpdateBoatBatch(batch, pilot.wind, AUTOPILOT_STEP);
+        if (pilot.toWaypoint) continue;
+    
+        // Course keeping: integrated squared error of the direction of travel
+        for (int i = 0; i < batch.count; i++) {
+            float error = NormalizeAngle(batch.heading[i] + M_PI - pilot.targetCourse);
+            pilot.cost[first + i] += error * error * AUTOPILOT_STEP;
+        }
+    }
+    
+    // Both modes want the most progress along their direction, plus what the end heading would
+    // make good at its polar speed, so a rollout that stalls head to wind isn't worth its speed
+    float horizon = AUTOPILOT_STEPS * AUTOPILOT_STEP;
+    for (int i = 0; i < batch.count; i++) {
+        float endTravel = batch.heading[i] + M_PI;
+        float steady = GetPolarSpeed(*pilot.polar, pilot.wind.speed, NormalizeAngle(endTravel - pilot.wind.direction));
+        float progress = (batch.x[i] - boat.x) * pilot.dirX + (batch.y[i] - boat.y) * pilot.dirY;
+        float onward = steady * (sinf(endTravel) * pilot.dirX + cosf(endTravel) * pilot.dirY);
+        float gain = (progress + onward * AUTOPILOT_TERMINAL_TIME) / (horizon + AUTOPILOT_TERMINAL_TIME);
+        pilot.cost[first + i] -= pilot.toWaypoint ? gain : AUTOPILOT_COURSE_SPEED_WEIGHT * gain;
+    }
+}
+
+void PlanAutopilot(Autopilot& pilot, const Boat& boat, const Wind& wind, const Waypoint& waypoint) {
+    pilot.start = boat;
+    pilot.wind = wind;
+    
+    // Candidate courses fan out from the one being held, or from the boat's course when racing
+    pilot.toWaypoint = pilot.mode == AUTOPILOT_VMG && waypoint.active;
+    float center = pilot.toWaypoint ? boat.heading + M_PI : pilot.targetCourse;
+    for (int c = 0; c < AUTOPILOT_CANDIDATES; c++) {
+        int offset = c % AUTOPILOT_COURSE_OFFSETS - AUTOPILOT_COURSE_OFFSETS / 2;
+        int sheet = c / AUTOPILOT_COURSE_OFFSETS - AUTOPILOT_SHEET_LEVELS / 2;
+        pilot.candidateCourse[c] = NormalizeAngle(center + offset * AUTOPILOT_OFFSET_STEP);
+        pilot.candidateSheet[c] = fminf(fmaxf(boat.sheet + sheet * AUTOPILOT_SHEET_STEP, 0.0f), 1.0f);
+        pilot.cost[c] = 0.0f;
+    }
+    
+    pilot.dirX = sinf(pilot.targetCourse);
+    pilot.dirY = cosf(pilot.targetCourse);
+    if (pilot.toWaypoint) {
+        float dx = waypoint.x - boat.x, dy = waypoint.y - boat.y;
+        float distance = sqrtf(dx*dx + dy*dy);
+        if (distance > 0.1f) {
+            pilot.dirX = dx / distance;
+            pilot.dirY = dy / distance;
+        }
+    }
+    
+    if (pilot.pool) RunJobs(*pilot.pool, RolloutJob, &pilot, AUTOPILOT_JOBS);
+    else for (int j = 0; j < AUTOPILOT_JOBS; j++) RolloutJob(&pilot, j);
+    
+    pilot.best = 0;
+    for (int c = 1; c < AUTOPILOT_CANDIDATES; c++) {
+        if (pilot.cost[c] < pilot.cost[pilot.best]) pilot.best = c;
+    }
+    pilot.course = pilot.candidateCourse[pilot.best];
+    pilot.sheet = pilot.candidateSheet[pilot.best];
+}
+
+// Steers the chosen course every tick between replans, the same helm the rollouts used
+void UpdateAutopilot(Autopilot& pilot, Boat& boat, const Wind& wind, const Waypoint& waypoint, float dt) {
+    if (pilot.mode == AUTOPILOT_OFF) return;
+    pilot.sinceReplan += dt;
+    if (pilot.sinceReplan >= AUTOPILOT_INTERVAL) {
+        pilot.sinceReplan = 0.0f;
+        PlanAutopilot(pilot, boat, wind, waypoint);
+    }
+    boat.rudder = HelmRudder(boat.heading, pilot.course);
+    boat.sheet = pilot.sheet;
+}
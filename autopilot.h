@@ -0,0 +1,57 @@
+#ifndef AUTOPILOT_H
+#define AUTOPILOT_H
+
+#include "types.h"
+#include "boat.h"
+#include "polar.h"
+#include "jobs.h"
+
+const int AUTOPILOT_COURSE_OFFSETS = 25;    // candidate courses either side of the current one
+const float AUTOPILOT_OFFSET_STEP = 10.0f * (float)M_PI / 180.0f;
+const int AUTOPILOT_SHEET_LEVELS = 3;       // current sheet and a step either side
+const int AUTOPILOT_CANDIDATES = AUTOPILOT_COURSE_OFFSETS * AUTOPILOT_SHEET_LEVELS;
+const float AUTOPILOT_SHEET_STEP = 0.1f;
+const int AUTOPILOT_JOBS = AUTOPILOT_SHEET_LEVELS;   // one batch per sheet level, rolled out in parallel
+const float AUTOPILOT_RUDDER_GAIN = 2.0f;   // rudder per radian of course error
+const float AUTOPILOT_STEP = 0.1f;          // rollout time step
+const int AUTOPILOT_STEPS = 40;             // 4 second horizon
+const float AUTOPILOT_INTERVAL = 0.25f;     // seconds between replans
+const float AUTOPILOT_TERMINAL_TIME = 4.0f; // cost-to-go: time sailed on at the end heading
+const float AUTOPILOT_COURSE_SPEED_WEIGHT = 0.01f;   // course keeping still prefers the better trim
+
+enum AutopilotMode {
+    AUTOPILOT_OFF,
+    AUTOPILOT_COURSE,   // hold targetCourse
+    AUTOPILOT_VMG       // best progress to the waypoint
+};
+
+// Receding-horizon autopilot. Every interval each candidate (a course to steer with the
+// proportional helm, and a sheet) is rolled forward from the boat's state as one lane of a
+// batch, and the cheapest is steered until the next replan. The batches run on the job pool.
+struct Autopilot {
+    const Polar* polar;                     // steady speed for the cost-to-go
+    JobPool* pool;                          // optional
+    AutopilotMode mode;
+    float targetCourse;                     // direction of travel to hold
+    float sinceReplan;
+    float course, sheet;                    // candidate being steered
+    int best;
+    
+    float candidateCourse[AUTOPILOT_CANDIDATES];
+    float candidateSheet[AUTOPILOT_CANDIDATES];
+    float cost[AUTOPILOT_CANDIDATES];
+    BoatBatch rollouts[AUTOPILOT_JOBS];
+    
+    // The replan the jobs are working on
+    Boat start;
+    Wind wind;
+    bool toWaypoint;
+    float dirX, dirY;                       // direction progress is measured along
+};
+
+void InitAutopilot(Autopilot& pilot, const Polar& polar, JobPool* pool);
+void EngageAutopilot(Autopilot& pilot, const Boat& boat, AutopilotMode mode);
+void PlanAutopilot(Autopilot& pilot, const Boat& boat, const Wind& wind, const Waypoint& waypoint);
+void UpdateAutopilot(Autopilot& pilot, Boat& boat, const Wind& wind, const Waypoint& waypoint, float dt);
+
+#endif
@@ -0,0 +1,78 @@
+#include "benchmark.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+void InitFrameBenchmark(FrameBenchmark& benchmark, int frames, int warmup) {
+    benchmark.frames = frames;
+    benchmark.warmup = warmup;
+    benchmark.frame = 0;
+    benchmark.updateMs.clear();
+    benchmark.routeMs.clear();
+    benchmark.drawMs.clear();
+    benchmark.frameMs.clear();
+    benchmark.updateMs.reserve(frames);
+    benchmark.routeMs.reserve(frames);
+    benchmark.drawMs.reserve(frames);
+    benchmark.frameMs.reserve(frames);
+}
+
+bool RecordBenchmarkFrame(FrameBenchmark& benchmark, float updateMs, float routeMs, float drawMs,
+                          float frameMs) {
+    if (benchmark.frame++ >= benchmark.warmup) {
+        benchmark.updateMs.push_back(updateMs);
+        benchmark.routeMs.push_back(routeMs);
+        benchmark.drawMs.push_back(drawMs);
+        benchmark.frameMs.push_back(frameMs);
+    }
+    return benchmark.frame < benchmark.warmup + benchmark.frames;
+}
+
+static float Percentile(const std::vector<float>& sorted, float p) {
+    int rank = (int)ceilf(p / 100.0f * sorted.size());
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+TimingSummary SummarizeTimings(const std::vector<float>& samples) {
+    TimingSummary summary = {};
+    if (samples.empty()) return summary;
+    
+    std::vector<float> sorted(samples);
+    std::sort(sorted.begin(), sorted.end());
+    double sum = 0.0;
+    for (float sample : sorted) sum += sample;
+    summary.mean = (float)(sum / sorted.size());
+    summary.p50 = Percentile(sorted, 50.0f);
+    summary.p95 = Percentile(sorted, 95.0f);
+    summary.p99 = Percentile(sorted, 99.0f);
+    summary.max = sorted.back();
+    return summary;
+}
+
+static void WritePhase(FILE* out, const char* name, const TimingSummary& s, bool last) {
+    fprintf(out, "  \"%s\": {\"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f}%s\n",
+            name, s.mean, s.p50, s.p95, s.p99, s.max, last ? "" : ",");
+    printf("%-8s mean %7.3f  p50 %7.3f  p95 %7.3f  p99 %7.3f  max %7.3f ms\n",
+           name, s.mean, s.p50, s.p95, s.p99, s.max);
+}
+
+// JSON to `path`, the same table to stdout
+bool WriteBenchmarkSummary(const FrameBenchmark& benchmark, const BenchmarkScene& scene, const char* path) {
+    FILE* out = fopen(path, "w");
+    if (!out) return false;
+    
+    fprintf(out, "{\n");
+    fprintf(out, "  \"frames\": %d,\n  \"warmup\": %d,\n", (int)benchmark.frameMs.size(), benchmark.warmup);
+    fprintf(out, "  \"scene\": {\"width\": %d, \"height\": %d, \"boats\": %d, \"particles\": %d, "
+                 "\"chevrons\": %d, \"wake_points\": %d},\n",
+            scene.width, scene.height, scene.boats, scene.particles, scene.chevrons, scene.wakePoints);
+    printf("%d frames after %d warmup\n", (int)benchmark.frameMs.size(), benchmark.warmup);
+    WritePhase(out, "update_ms", SummarizeTimings(benchmark.updateMs), false);
+    WritePhase(out, "route_ms", SummarizeTimings(benchmark.routeMs), false);
+    WritePhase(out, "draw_ms", SummarizeTimings(benchmark.drawMs), false);
+    WritePhase(out, "frame_ms", SummarizeTimings(benchmark.frameMs), true);
+    fprintf(out, "}\n");
+    
+    bool ok = !ferror(out);
+    return fclose(out) == 0 && ok;
+}
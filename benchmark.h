@@ -0,0 +1,33 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <vector>
+
+// Frame timings from `sailsim --benchmark`, summarised as nearest-rank percentiles
+struct FrameBenchmark {
+    int frames;              // measured frames
+    int warmup;              // frames run first and thrown away
+    int frame;               // frames run so far, warmup included
+    std::vector<float> updateMs, routeMs, drawMs, frameMs;   // update excludes route planning
+};
+
+// What was on screen, echoed into the summary so runs can be compared like for like
+struct BenchmarkScene {
+    int width, height;
+    int boats;
+    int particles;
+    int chevrons;
+    int wakePoints;
+};
+
+struct TimingSummary {
+    float mean, p50, p95, p99, max;
+};
+
+void InitFrameBenchmark(FrameBenchmark& benchmark, int frames, int warmup);
+bool RecordBenchmarkFrame(FrameBenchmark& benchmark, float updateMs, float routeMs, float drawMs,
+                          float frameMs);   // false when done
+TimingSummary SummarizeTimings(const std::vector<float>& samples);
+bool WriteBenchmarkSummary(const FrameBenchmark& benchmark, const BenchmarkScene& scene, const char* path);
+
+#endif
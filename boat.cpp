@@ -15,14 +15,31 @@ void InitBoat(Boat& boat) {
     boat.length = 5.0f;
     boat.sailAngle = M_PI;
     boat.sailAngularVel = 0.0f;
+    boat.boatClass = BOAT_CLASS_DINGHY;
 }
 
-void UpdateBoat(Boat& boat, const Wind& wind, float dt) {
-    Vector2D apparentWind = GetApparentWind(wind, boat.vx, boat.vy);
+// Coefficients of a built-in class as compile-time constants
+template <const BoatParams& P>
+struct FixedCoefficients {
+    static constexpr BoatCoefficients k = FoldBoatParams(P);
+};
+
+// Coefficients of a registered class, read from the table
+struct TableCoefficients {
+    const BoatCoefficients& k;
+};
+
+// One boat's step, shared by UpdateBoat and the batch so a rollout ends in exactly the state
+// the real boat would reach with the same controls. heel may be null.
+template <typename Coefficients>
+static inline void StepBoatLane(float& x, float& y, float& vx, float& vy, float& heading, float& sailAngle,
+                                float& sailAngularVel, float* heel, float sheet, float rudder,
+                                Vector2D trueWind, float dt, const Coefficients& c) {
+    Vector2D apparentWind = trueWind - Vector2D(vx, vy);
     float windAngle = atan2f(apparentWind.x, apparentWind.y);
     
     // === SAIL DYNAMICS IN WORLD SPACE ===
-    float boomWorld = boat.heading + boat.sailAngle;
+    float boomWorld = heading + sailAngle;
     float targetBoomWorld = NormalizeAngle(windAngle + M_PI);  // Boom wants to point downwind
     
     // Angular error in world space
@@ -31,53 +48,103 @@ void UpdateBoat(Boat& boat, const Wind& wind, float dt) {
     // Spring-damper system
     const float SAIL_DAMPING = 5.0f;
     const float SAIL_SPRING = 10.0f;
-    float sailAcceleration = boomError * SAIL_SPRING - boat.sailAngularVel * SAIL_DAMPING;
+    float sailAcceleration = boomError * SAIL_SPRING - sailAngularVel * SAIL_DAMPING;
     
     // Update sail angular velocity and angle
-    boat.sailAngularVel += sailAcceleration * dt;
-    boat.sailAngle += boat.sailAngularVel * dt;
-    boat.sailAngle = NormalizeAngle(boat.sailAngle);
+    sailAngularVel += sailAcceleration * dt;
+    sailAngle += sailAngularVel * dt;
+    sailAngle = NormalizeAngle(sailAngle);
     
     // Clamp sail by sheet constraint (in boat space)
-    float maxSheetAngle = boat.sheet * M_PI/2;
-    float deviation = NormalizeAngle(boat.sailAngle - M_PI);
+    float maxSheetAngle = sheet * M_PI/2;
+    float deviation = NormalizeAngle(sailAngle - M_PI);
     if (fabs(deviation) > maxSheetAngle) {
-        boat.sailAngle = M_PI + (deviation > 0 ? maxSheetAngle : -maxSheetAngle);
-        boat.sailAngularVel = 0.0f;
+        sailAngle = M_PI + (deviation > 0 ? maxSheetAngle : -maxSheetAngle);
+        sailAngularVel = 0.0f;
     }
     
     // === BOAT PHYSICS ===
-    Vector2D sailForce = CalculateSailForce(apparentWind, boat.heading, boat.sheet);
+    Vector2D sailForce = CalculateSailForce(apparentWind, heading, sheet, c.k.sail);
     
     // Calculate heel
-    boat.heel = CalculateHeelAngle(apparentWind, boat.heading, boat.sailAngle);
+    if (heel) *heel = CalculateHeelAngle(apparentWind, heading, sailAngle, c.k.sail);
     
     // Project force along heading
-    float forceAlongHeading = sailForce.x * sinf(boat.heading) + sailForce.y * cosf(boat.heading);
-    Vector2D effectiveForce(
-        forceAlongHeading * sinf(boat.heading),
-        forceAlongHeading * cosf(boat.heading)
-    );
+    float sinHeading = sinf(heading), cosHeading = cosf(heading);
+    float forceAlongHeading = sailForce.x * sinHeading + sailForce.y * cosHeading;
+    Vector2D effectiveForce(forceAlongHeading * sinHeading, forceAlongHeading * cosHeading);
     
-    Vector2D dragForce = CalculateDrag(boat.vx, boat.vy);
+    Vector2D dragForce = CalculateDrag(vx, vy, c.k.drag);
     Vector2D totalForce = effectiveForce + dragForce;
-    Vector2D acceleration = totalForce * (1.0f / BOAT_MASS);
+    Vector2D acceleration = totalForce * c.k.inverseMass;
     
     // Update velocity
-    boat.vx += acceleration.x * dt;
-    boat.vy += acceleration.y * dt;
+    vx += acceleration.x * dt;
+    vy += acceleration.y * dt;
     
     // Constrain to heading (keel effect)
-    float speedAlongHeading = boat.vx * sinf(boat.heading) + boat.vy * cosf(boat.heading);
-    boat.vx = speedAlongHeading * sinf(boat.heading);
-    boat.vy = speedAlongHeading * cosf(boat.heading);
+    float speedAlongHeading = vx * sinHeading + vy * cosHeading;
+    vx = speedAlongHeading * sinHeading;
+    vy = speedAlongHeading * cosHeading;
     
     // Update position
-    boat.x += boat.vx * dt;
-    boat.y += boat.vy * dt;
+    x += vx * dt;
+    y += vy * dt;
     
     // Update heading from rudder
-    float speed = sqrtf(boat.vx * boat.vx + boat.vy * boat.vy);
-    boat.heading += boat.rudder * RUDDER_EFFECTIVENESS * speed * dt;
-    boat.heading = NormalizeAngle(boat.heading);
-}
\ No newline at end of file
+    float speed = sqrtf(vx * vx + vy * vy);
+    heading += rudder * c.k.rudder * speed * dt;
+    heading = NormalizeAngle(heading);
+}
+
+template <typename Coefficients>
+static void StepBoat(Boat& boat, const Wind& wind, float dt, const Coefficients& c) {
+    StepBoatLane(boat.x, boat.y, boat.vx, boat.vy, boat.heading, boat.sailAngle, boat.sailAngularVel, &boat.heel,
+                 boat.sheet, boat.rudder, GetWindVector(wind), dt, c);
+}
+
+void UpdateBoat(Boat& boat, const Wind& wind, float dt) {
+    switch (boat.boatClass) {
+        case BOAT_CLASS_DINGHY: StepBoat(boat, wind, dt, FixedCoefficients<DINGHY_PARAMS>()); break;
+        case BOAT_CLASS_KEELBOAT: StepBoat(boat, wind, dt, FixedCoefficients<KEELBOAT_PARAMS>()); break;
+        default: StepBoat(boat, wind, dt, TableCoefficients{GetBoatCoefficients(boat.boatClass)}); break;
+    }
+}
+
+// For parameter sweeps, which try more coefficient sets than the class table holds
+void UpdateBoat(Boat& boat, const Wind& wind, float dt, const BoatCoefficients& k) {
+    StepBoat(boat, wind, dt, TableCoefficients{k});
+}
+
+void FillBoatBatch(BoatBatch& batch, const Boat& boat, int count) {
+    batch.count = count < MAX_BOAT_BATCH ? count : MAX_BOAT_BATCH;
+    batch.boatClass = boat.boatClass;
+    for (int i = 0; i < batch.count; i++) {
+        batch.x[i] = boat.x;
+        batch.y[i] = boat.y;
+        batch.vx[i] = boat.vx;
+        batch.vy[i] = boat.vy;
+        batch.heading[i] = boat.heading;
+        batch.sheet[i] = boat.sheet;
+        batch.rudder[i] = boat.rudder;
+        batch.sailAngle[i] = boat.sailAngle;
+        batch.sailAngularVel[i] = boat.sailAngularVel;
+    }
+}
+
+template <typename Coefficients>
+static void StepBoatBatch(BoatBatch& batch, const Wind& wind, float dt, const Coefficients& c) {
+    Vector2D trueWind = GetWindVector(wind);
+    for (int i = 0; i < batch.count; i++) {
+        StepBoatLane(batch.x[i], batch.y[i], batch.vx[i], batch.vy[i], batch.heading[i], batch.sailAngle[i],
+                     batch.sailAngularVel[i], nullptr, batch.sheet[i], batch.rudder[i], trueWind, dt, c);
+    }
+}
+
+void UpdateBoatBatch(BoatBatch& batch, const Wind& wind, float dt) {
+    switch (batch.boatClass) {
+        case BOAT_CLASS_DINGHY: StepBoatBatch(batch, wind, dt, FixedCoefficients<DINGHY_PARAMS>()); break;
+        case BOAT_CLASS_KEELBOAT: StepBoatBatch(batch, wind, dt, FixedCoefficients<KEELBOAT_PARAMS>()); break;
+        default: StepBoatBatch(batch, wind, dt, TableCoefficients{GetBoatCoefficients(batch.boatClass)}); break;
+    }
+}
@@ -3,7 +3,28 @@
 
 #include "types.h"
 
+struct BoatCoefficients;
+
+const int MAX_BOAT_BATCH = 128;
+
+// Structure-of-arrays copies of boats stepped in one wind, for rollouts. Heel is only an
+// output of the step, so it isn't carried.
+struct BoatBatch {
+    int count;
+    int boatClass;
+    float x[MAX_BOAT_BATCH], y[MAX_BOAT_BATCH];
+    float vx[MAX_BOAT_BATCH], vy[MAX_BOAT_BATCH];
+    float heading[MAX_BOAT_BATCH];
+    float sheet[MAX_BOAT_BATCH];
+    float rudder[MAX_BOAT_BATCH];
+    float sailAngle[MAX_BOAT_BATCH];
+    float sailAngularVel[MAX_BOAT_BATCH];
+};
+
 void InitBoat(Boat& boat);
 void UpdateBoat(Boat& boat, const Wind& wind, float dt);
+void UpdateBoat(Boat& boat, const Wind& wind, float dt, const BoatCoefficients& k);   // ignores boatClass
+void FillBoatBatch(BoatBatch& batch, const Boat& boat, int count);
+void UpdateBoatBatch(BoatBatch& batch, const Wind& wind, float dt);
 
 #endif
\ No newline at end of file
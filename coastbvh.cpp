@@ -0,0 +1,205 @@
+#include "coastbvh.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+static void SegmentEnds(const Coastline& coast, const CoastSegmentRef& segment, Vector2D& a, Vector2D& b) {
+    const CoastPolygon& polygon = coast.polygons[segment.polygon];
+    int end = segment.start + 1 == polygon.first + polygon.count ? polygon.first : segment.start + 1;
+    a = coast.vertices[segment.start];
+    b = coast.vertices[end];
+}
+
+void GetCoastSegment(const CoastBVH& bvh, const Coastline& coast, int index, Vector2D& a, Vector2D& b) {
+    SegmentEnds(coast, bvh.segments[index], a, b);
+}
+
+static int BuildNode(CoastBVH& bvh, const Coastline& coast, int first, int count) {
+    int index = bvh.nodeCount++;
+    CoastBVHNode& node = bvh.nodes[index];
+    node.minX = node.minY = INFINITY;
+    node.maxX = node.maxY = -INFINITY;
+    float cMinX = INFINITY, cMinY = INFINITY, cMaxX = -INFINITY, cMaxY = -INFINITY;
+    
+    for (int i = first; i < first + count; i++) {
+        Vector2D a, b;
+        GetCoastSegment(bvh, coast, i, a, b);
+        node.minX = fminf(node.minX, fminf(a.x, b.x));
+        node.minY = fminf(node.minY, fminf(a.y, b.y));
+        node.maxX = fmaxf(node.maxX, fmaxf(a.x, b.x));
+        node.maxY = fmaxf(node.maxY, fmaxf(a.y, b.y));
+        cMinX = fminf(cMinX, a.x + b.x); cMaxX = fmaxf(cMaxX, a.x + b.x);
+        cMinY = fminf(cMinY, a.y + b.y); cMaxY = fmaxf(cMaxY, a.y + b.y);
+    }
+    
+    if (count <= COAST_BVH_LEAF_SIZE) {
+        node.first = first;
+        node.count = count;
+        return index;
+    }
+    
+    // Median split on the longer axis of the segment midpoints
+    bool splitX = cMaxX - cMinX >= cMaxY - cMinY;
+    int half = count / 2;
+    std::nth_element(bvh.segments + first, bvh.segments + first + half, bvh.segments + first + count,
+        [&](const CoastSegmentRef& l, const CoastSegmentRef& r) {
+            Vector2D la, lb, ra, rb;
+            SegmentEnds(coast, l, la, lb);
+            SegmentEnds(coast, r, ra, rb);
+            return splitX ? la.x + lb.x < ra.x + rb.x : la.y + lb.y < ra.y + rb.y;
+        });
+    
+    // nodes[] never reallocates during the build, so the reference stays valid
+    BuildNode(bvh, coast, first, half);
+    int right = BuildNode(bvh, coast, first + half, count - half);
+    bvh.nodes[index].first = right;
+    bvh.nodes[index].count = 0;
+    return index;
+}
+
+void BuildCoastBVH(CoastBVH& bvh, const Coastline& coast) {
+    bvh.segmentCount = coast.vertexCount;
+    bvh.nodeCount = 0;
+    bvh.segments = nullptr;
+    bvh.nodes = nullptr;
+    if (bvh.segmentCount == 0) return;
+    
+    bvh.segments = (CoastSegmentRef*)malloc(bvh.segmentCount * sizeof(CoastSegmentRef));
+    for (int p = 0; p < coast.polygonCount; p++) {
+        for (int i = 0; i < coast.polygons[p].count; i++) {
+            int start = coast.polygons[p].first + i;
+            bvh.segments[start].start = start;
+            bvh.segments[start].polygon = p;
+        }
+    }
+    
+    // Leaves hold at least half the leaf size, so this bounds the node count
+    int maxNodes = 2 * (bvh.segmentCount / (COAST_BVH_LEAF_SIZE / 2) + 1);
+    bvh.nodes = (CoastBVHNode*)malloc(maxNodes * sizeof(CoastBVHNode));
+    BuildNode(bvh, coast, 0, bvh.segmentCount);
+    bvh.nodes = (CoastBVHNode*)realloc(bvh.nodes, bvh.nodeCount * sizeof(CoastBVHNode));
+}
+
+void FreeCoastBVH(CoastBVH& bvh) {
+    free(bvh.nodes);
+    free(bvh.segments);
+    bvh.nodes = nullptr;
+    bvh.segments = nullptr;
+    bvh.nodeCount = 0;
+    bvh.segmentCount = 0;
+}
+
+// Segment indices whose bounds overlap the rectangle; returns how many were written
+int QueryCoastRect(const CoastBVH& bvh, float minX, float minY, float maxX, float maxY, int out[], int maxCount) {
+    if (bvh.nodeCount == 0) return 0;
+    int stack[COAST_BVH_STACK];
+    int top = 0, found = 0;
+    stack[top++] = 0;
+    
+    while (top > 0) {
+        const CoastBVHNode& node = bvh.nodes[stack[--top]];
+        if (node.maxX < minX || node.minX > maxX || node.maxY < minY || node.minY > maxY) continue;
+        if (node.count > 0) {
+            for (int i = node.first; i < node.first + node.count && found < maxCount; i++) out[found++] = i;
+            if (found == maxCount) break;
+        } else {
+            stack[top++] = node.first;
+            stack[top++] = (int)(&node - bvh.nodes) + 1;
+        }
+    }
+    return found;
+}
+
+// Entry distance of the ray into the box, or INFINITY when it misses
+static float RayBoxEntry(const CoastBVHNode& node, Vector2D origin, Vector2D invDir, float maxDistance) {
+    float tx1 = (node.minX - origin.x) * invDir.x, tx2 = (node.maxX - origin.x) * invDir.x;
+    float ty1 = (node.minY - origin.y) * invDir.y, ty2 = (node.maxY - origin.y) * invDir.y;
+    float tmin = fmaxf(fminf(tx1, tx2), fminf(ty1, ty2));
+    float tmax = fminf(fmaxf(tx1, tx2), fmaxf(ty1, ty2));
+    if (tmax < fmaxf(tmin, 0.0f) || tmin > maxDistance) return INFINITY;
+    return fmaxf(tmin, 0.0f);
+}
+
+// First shoreline crossing along a (unit) direction, e.g. "will I clear that headland on this heading"
+bool RaycastCoast(const CoastBVH& bvh, const Coastline& coast, Vector2D origin, Vector2D direction, float maxDistance,
+                  float& hitDistance) {
+    if (bvh.nodeCount == 0) return false;
+    Vector2D invDir(1.0f / direction.x, 1.0f / direction.y);
+    float best = maxDistance;
+    bool hit = false;
+    int stack[COAST_BVH_STACK];
+    int top = 0;
+    stack[top++] = 0;
+    
+    while (top > 0) {
+        const CoastBVHNode& node = bvh.nodes[stack[--top]];
+        if (RayBoxEntry(node, origin, invDir, best) == INFINITY) continue;
+    
+        if (node.count == 0) {
+            stack[top++] = node.first;
+            stack[top++] = (int)(&node - bvh.nodes) + 1;
+            continue;
+        }
+        for (int i = node.first; i < node.first + node.count; i++) {
+            Vector2D a, b;
+            GetCoastSegment(bvh, coast, i, a, b);
+            Vector2D edge = b - a;
+            float denom = direction.x * edge.y - direction.y * edge.x;
+            if (fabsf(denom) < 1e-9f) continue;
+            Vector2D toA = a - origin;
+            float t = (toA.x * edge.y - toA.y * edge.x) / denom;
+            float u = (toA.x * direction.y - toA.y * direction.x) / denom;
+            if (t >= 0.0f && t < best && u >= 0.0f && u <= 1.0f) {
+                best = t;
+                hit = true;
+            }
+        }
+    }
+    if (hit) hitDistance = best;
+    return hit;
+}
+
+static float BoxDistanceSq(const CoastBVHNode& node, float x, float y) {
+    float dx = fmaxf(fmaxf(node.minX - x, x - node.maxX), 0.0f);
+    float dy = fmaxf(fmaxf(node.minY - y, y - node.maxY), 0.0f);
+    return dx*dx + dy*dy;
+}
+
+// Unclamped distance to the closest shoreline point; the SDF only resolves distances near the shore
+float FindNearestShore(const CoastBVH& bvh, const Coastline& coast, float x, float y, Vector2D& closest) {
+    float best = INFINITY;
+    if (bvh.nodeCount == 0) return best;
+    int stack[COAST_BVH_STACK];
+    int top = 0;
+    stack[top++] = 0;
+    
+    while (top > 0) {
+        const CoastBVHNode& node = bvh.nodes[stack[--top]];
+        if (BoxDistanceSq(node, x, y) >= best) continue;
+    
+        if (node.count == 0) {
+            // Push the farther child first so the nearer one tightens the bound sooner
+            int left = (int)(&node - bvh.nodes) + 1;
+            int right = node.first;
+            bool leftNearer = BoxDistanceSq(bvh.nodes[left], x, y) <= BoxDistanceSq(bvh.nodes[right], x, y);
+            stack[top++] = leftNearer ? right : left;
+            stack[top++] = leftNearer ? left : right;
+            continue;
+        }
+        for (int i = node.first; i < node.first + node.count; i++) {
+            Vector2D a, b;
+            GetCoastSegment(bvh, coast, i, a, b);
+            Vector2D edge = b - a;
+            float len = edge.x*edge.x + edge.y*edge.y;
+            float t = len > 0.0f ? ((x - a.x) * edge.x + (y - a.y) * edge.y) / len : 0.0f;
+            t = fminf(fmaxf(t, 0.0f), 1.0f);
+            Vector2D point = a + edge * t;
+            float d = (point.x - x) * (point.x - x) + (point.y - y) * (point.y - y);
+            if (d < best) {
+                best = d;
+                closest = point;
+            }
+        }
+    }
+    return sqrtf(best);
+}
@@ -0,0 +1,41 @@
+#ifndef COASTBVH_H
+#define COASTBVH_H
+
+#include "types.h"
+#include "coastline.h"
+
+const int COAST_BVH_LEAF_SIZE = 4;        // segments per leaf
+const int COAST_BVH_STACK = 64;           // traversal depth; a median split of 2^31 segments needs < 32
+
+// 24 bytes. Interior nodes have count == 0: the left child follows the node directly and
+// first is the index of the right child. Leaves own segments [first, first + count).
+struct CoastBVHNode {
+    float minX, minY, maxX, maxY;
+    int first;
+    int count;
+};
+
+// One coastline edge, from vertex `start` to the next vertex of `polygon` (wrapping)
+struct CoastSegmentRef {
+    int start;
+    int polygon;
+};
+
+// Bounding volume hierarchy over coastline segments, built once at load in depth-first order
+struct CoastBVH {
+    CoastBVHNode* nodes;
+    int nodeCount;
+    CoastSegmentRef* segments;
+    int segmentCount;
+};
+
+void BuildCoastBVH(CoastBVH& bvh, const Coastline& coast);
+void FreeCoastBVH(CoastBVH& bvh);
+
+void GetCoastSegment(const CoastBVH& bvh, const Coastline& coast, int index, Vector2D& a, Vector2D& b);
+int QueryCoastRect(const CoastBVH& bvh, float minX, float minY, float maxX, float maxY, int out[], int maxCount);
+bool RaycastCoast(const CoastBVH& bvh, const Coastline& coast, Vector2D origin, Vector2D direction, float maxDistance,
+                  float& hitDistance);
+float FindNearestShore(const CoastBVH& bvh, const Coastline& coast, float x, float y, Vector2D& closest);
+
+#endif
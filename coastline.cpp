@@ -0,0 +1,326 @@
+#include "coastline.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+void InitCoastline(Coastline& coast) {
+    coast.vertices = nullptr;
+    coast.vertexCount = 0;
+    coast.polygons = nullptr;
+    coast.polygonCount = 0;
+    coast.originX = coast.originY = 0.0f;
+    coast.tilesX = coast.tilesY = 0;
+    coast.tileIndex = nullptr;
+    coast.tileSamples = nullptr;
+    coast.tileCount = 0;
+}
+
+static void FreeCoastSDF(Coastline& coast) {
+    free(coast.tileIndex);
+    free(coast.tileSamples);
+    coast.tileIndex = nullptr;
+    coast.tileSamples = nullptr;
+    coast.tilesX = coast.tilesY = 0;
+    coast.tileCount = 0;
+}
+
+void FreeCoastline(Coastline& coast) {
+    FreeCoastSDF(coast);
+    free(coast.vertices);
+    free(coast.polygons);
+    InitCoastline(coast);
+}
+
+// Polygons may be wound either way; inside is decided by crossings when baking
+void AddCoastPolygon(Coastline& coast, const Vector2D points[], int count, const char* name) {
+    if (count < 3) return;
+    coast.vertices = (Vector2D*)realloc(coast.vertices, (coast.vertexCount + count) * sizeof(Vector2D));
+    coast.polygons = (CoastPolygon*)realloc(coast.polygons, (coast.polygonCount + 1) * sizeof(CoastPolygon));
+    
+    CoastPolygon& polygon = coast.polygons[coast.polygonCount++];
+    polygon.first = coast.vertexCount;
+    polygon.count = count;
+    snprintf(polygon.name, sizeof(polygon.name), "%s", name ? name : "");
+    
+    for (int i = 0; i < count; i++) coast.vertices[coast.vertexCount++] = points[i];
+}
+
+// Text format, one polygon per block, coordinates in meters:
+//   island Gull Rock
+//   120 240
+//   ...
+//   end
+// Blank lines and lines starting with # are ignored.
+bool LoadCoastline(Coastline& coast, const char* fileName) {
+    FILE* file = fopen(fileName, "r");
+    if (!file) return false;
+    
+    int capacity = 64, count = 0;
+    Vector2D* points = (Vector2D*)malloc(capacity * sizeof(Vector2D));
+    char name[32] = "";
+    bool inPolygon = false;
+    char line[256];
+    
+    while (fgets(line, sizeof(line), file)) {
+        char* text = line;
+        while (*text == ' ' || *text == '\t') text++;
+        if (*text == '#' || *text == '\n' || *text == '\r' || *text == '\0') continue;
+    
+        if (strncmp(text, "island", 6) == 0) {
+            text += 6;
+            while (*text == ' ' || *text == '\t') text++;
+            snprintf(name, sizeof(name), "%s", text);
+            name[strcspn(name, "\r\n")] = '\0';
+            count = 0;
+            inPolygon = true;
+        } else if (strncmp(text, "end", 3) == 0) {
+            if (inPolygon) AddCoastPolygon(coast, points, count, name);
+            inPolygon = false;
+        } else if (inPolygon) {
+            float x, y;
+            if (sscanf(text, "%f %f", &x, &y) != 2) continue;
+            if (count == capacity) {
+                capacity *= 2;
+                points = (Vector2D*)realloc(points, capacity * sizeof(Vector2D));
+            }
+            points[count++] = Vector2D(x, y);
+        }
+    }
+    if (inPolygon) AddCoastPolygon(coast, points, count, name);
+    
+    free(points);
+    fclose(file);
+    BakeCoastline(coast);
+    return true;
+}
+
+struct CoastSegment {
+    float ax, ay, bx, by;
+};
+
+static float SegmentDistanceSq(const CoastSegment& s, float px, float py) {
+    float dx = s.bx - s.ax, dy = s.by - s.ay;
+    float len = dx*dx + dy*dy;
+    float t = len > 0.0f ? ((px - s.ax) * dx + (py - s.ay) * dy) / len : 0.0f;
+    t = fminf(fmaxf(t, 0.0f), 1.0f);
+    float cx = s.ax + dx * t - px;
+    float cy = s.ay + dy * t - py;
+    return cx*cx + cy*cy;
+}
+
+static int CompareFloats(const void* a, const void* b) {
+    float fa = *(const float*)a, fb = *(const float*)b;
+    return (fa > fb) - (fa < fb);
+}
+
+// Counting-sort segments into bins (same scheme as the spatial hash) so each tile only
+// looks at the segments that can be within range of it
+static void BinSegments(const CoastSegment* segments, int segmentCount, int binCount, int* binStart, int** binEntries,
+                        const Coastline& coast, bool rowsOnly) {
+    float tileSpan = COAST_TILE_SIZE * COAST_CELL_SIZE;
+    float pad = rowsOnly ? 0.0f : COAST_SDF_RANGE;
+    for (int b = 0; b <= binCount; b++) binStart[b] = 0;
+    
+    for (int pass = 0; pass < 2; pass++) {
+        for (int s = 0; s < segmentCount; s++) {
+            const CoastSegment& seg = segments[s];
+            int ty0 = (int)floorf((fminf(seg.ay, seg.by) - pad - coast.originY) / tileSpan);
+            int ty1 = (int)floorf((fmaxf(seg.ay, seg.by) + pad - coast.originY) / tileSpan);
+            int tx0 = 0, tx1 = 0;
+            if (!rowsOnly) {
+                tx0 = (int)floorf((fminf(seg.ax, seg.bx) - pad - coast.originX) / tileSpan);
+                tx1 = (int)floorf((fmaxf(seg.ax, seg.bx) + pad - coast.originX) / tileSpan);
+            }
+            int width = rowsOnly ? 1 : coast.tilesX;
+            for (int ty = ty0 < 0 ? 0 : ty0; ty <= ty1 && ty < coast.tilesY; ty++) {
+                for (int tx = tx0 < 0 ? 0 : tx0; tx <= tx1 && tx < width; tx++) {
+                    int bin = ty * width + tx;
+                    if (pass == 0) binStart[bin + 1]++;
+                    else (*binEntries)[binStart[bin]++] = s;
+                }
+            }
+        }
+        if (pass == 0) {
+            for (int b = 0; b < binCount; b++) binStart[b + 1] += binStart[b];
+            *binEntries = (int*)malloc((binStart[binCount] + 1) * sizeof(int));
+        }
+    }
+    for (int b = binCount; b > 0; b--) binStart[b] = binStart[b - 1];
+    binStart[0] = 0;
+}
+
+void BakeCoastline(Coastline& coast) {
+    FreeCoastSDF(coast);
+    if (coast.vertexCount == 0) return;
+    
+    int segmentCount = coast.vertexCount;
+    CoastSegment* segments = (CoastSegment*)malloc(segmentCount * sizeof(CoastSegment));
+    float minX = coast.vertices[0].x, maxX = minX;
+    float minY = coast.vertices[0].y, maxY = minY;
+    for (int p = 0; p < coast.polygonCount; p++) {
+        const CoastPolygon& polygon = coast.polygons[p];
+        for (int i = 0; i < polygon.count; i++) {
+            Vector2D a = coast.vertices[polygon.first + i];
+            Vector2D b = coast.vertices[polygon.first + (i + 1) % polygon.count];
+            segments[polygon.first + i] = {a.x, a.y, b.x, b.y};
+            minX = fminf(minX, a.x); maxX = fmaxf(maxX, a.x);
+            minY = fminf(minY, a.y); maxY = fmaxf(maxY, a.y);
+        }
+    }
+    
+    // Grid covers the land plus the clamp range; everything outside it is open water
+    float tileSpan = COAST_TILE_SIZE * COAST_CELL_SIZE;
+    coast.originX = minX - COAST_SDF_RANGE - COAST_CELL_SIZE;
+    coast.originY = minY - COAST_SDF_RANGE - COAST_CELL_SIZE;
+    coast.tilesX = (int)ceilf((maxX + COAST_SDF_RANGE + COAST_CELL_SIZE - coast.originX) / tileSpan);
+    coast.tilesY = (int)ceilf((maxY + COAST_SDF_RANGE + COAST_CELL_SIZE - coast.originY) / tileSpan);
+    int tileTotal = coast.tilesX * coast.tilesY;
+    
+    int* tileStart = (int*)malloc((tileTotal + 1) * sizeof(int));
+    int* tileEntries = nullptr;
+    BinSegments(segments, segmentCount, tileTotal, tileStart, &tileEntries, coast, false);
+    int* rowStart = (int*)malloc((coast.tilesY + 1) * sizeof(int));
+    int* rowEntries = nullptr;
+    BinSegments(segments, segmentCount, coast.tilesY, rowStart, &rowEntries, coast, true);
+    
+    int nearShore = 0;
+    for (int t = 0; t < tileTotal; t++) nearShore += tileStart[t + 1] > tileStart[t];
+    coast.tileIndex = (int*)malloc(tileTotal * sizeof(int));
+    coast.tileSamples = (float*)malloc((size_t)(nearShore > 0 ? nearShore : 1) * COAST_TILE_POINTS * COAST_TILE_POINTS * sizeof(float));
+    
+    int rowWidth = coast.tilesX * COAST_TILE_SIZE + 1;
+    unsigned char* inside = (unsigned char*)malloc(COAST_TILE_POINTS * rowWidth);
+    float* crossings = (float*)malloc((segmentCount + 1) * sizeof(float));
+    
+    for (int ty = 0; ty < coast.tilesY; ty++) {
+        // Inside/outside for every sample row of this tile row, by even-odd crossings along the row
+        for (int j = 0; j < COAST_TILE_POINTS; j++) {
+            float y = coast.originY + (ty * COAST_TILE_SIZE + j) * COAST_CELL_SIZE;
+            int crossingCount = 0;
+            for (int e = rowStart[ty]; e < rowStart[ty + 1]; e++) {
+                const CoastSegment& s = segments[rowEntries[e]];
+                if ((s.ay <= y) != (s.by <= y)) {
+                    crossings[crossingCount++] = s.ax + (y - s.ay) / (s.by - s.ay) * (s.bx - s.ax);
+                }
+            }
+            qsort(crossings, crossingCount, sizeof(float), CompareFloats);
+    
+            int next = 0;
+            for (int i = 0; i < rowWidth; i++) {
+                float x = coast.originX + i * COAST_CELL_SIZE;
+                while (next < crossingCount && crossings[next] < x) next++;
+                inside[j * rowWidth + i] = next & 1;
+            }
+        }
+    
+        for (int tx = 0; tx < coast.tilesX; tx++) {
+            int tile = ty * coast.tilesX + tx;
+            int first = tileStart[tile], last = tileStart[tile + 1];
+            int column = tx * COAST_TILE_SIZE;
+            if (first == last) {
+                coast.tileIndex[tile] = inside[column] ? COAST_TILE_LAND : COAST_TILE_WATER;
+                continue;
+            }
+    
+            float* samples = coast.tileSamples + (size_t)coast.tileCount * COAST_TILE_POINTS * COAST_TILE_POINTS;
+            bool uniform = true;
+            for (int j = 0; j < COAST_TILE_POINTS; j++) {
+                float y = coast.originY + (ty * COAST_TILE_SIZE + j) * COAST_CELL_SIZE;
+                for (int i = 0; i < COAST_TILE_POINTS; i++) {
+                    float x = coast.originX + (column + i) * COAST_CELL_SIZE;
+                    float best = COAST_SDF_RANGE * COAST_SDF_RANGE;
+                    for (int e = first; e < last; e++) best = fminf(best, SegmentDistanceSq(segments[tileEntries[e]], x, y));
+                    float d = sqrtf(best);
+                    if (d < COAST_SDF_RANGE) uniform = false;
+                    samples[j * COAST_TILE_POINTS + i] = inside[j * rowWidth + column + i] ? -d : d;
+                }
+            }
+            // Segments nearby but never within range: nothing worth storing
+            if (uniform) coast.tileIndex[tile] = inside[column] ? COAST_TILE_LAND : COAST_TILE_WATER;
+            else coast.tileIndex[tile] = coast.tileCount++;
+        }
+    }
+    
+    if (coast.tileCount > 0) {
+        coast.tileSamples = (float*)realloc(coast.tileSamples, (size_t)coast.tileCount * COAST_TILE_POINTS * COAST_TILE_POINTS * sizeof(float));
+    }
+    free(crossings);
+    free(inside);
+    free(rowEntries);
+    free(rowStart);
+    free(tileEntries);
+    free(tileStart);
+    free(segments);
+}
+
+// Signed distance to the nearest shore: one tile lookup and a bilinear blend
+float GetShoreDistance(const Coastline& coast, float x, float y) {
+    if (!coast.tileIndex) return COAST_SDF_RANGE;
+    float gx = (x - coast.originX) / COAST_CELL_SIZE;
+    float gy = (y - coast.originY) / COAST_CELL_SIZE;
+    int tx = (int)floorf(gx / COAST_TILE_SIZE);
+    int ty = (int)floorf(gy / COAST_TILE_SIZE);
+    if (tx < 0 || ty < 0 || tx >= coast.tilesX || ty >= coast.tilesY) return COAST_SDF_RANGE;
+    
+    int index = coast.tileIndex[ty * coast.tilesX + tx];
+    if (index == COAST_TILE_WATER) return COAST_SDF_RANGE;
+    if (index == COAST_TILE_LAND) return -COAST_SDF_RANGE;
+    
+    float lx = gx - tx * COAST_TILE_SIZE;
+    float ly = gy - ty * COAST_TILE_SIZE;
+    int i = (int)lx;
+    int j = (int)ly;
+    if (i > COAST_TILE_SIZE - 1) i = COAST_TILE_SIZE - 1;
+    if (j > COAST_TILE_SIZE - 1) j = COAST_TILE_SIZE - 1;
+    float fx = lx - i;
+    float fy = ly - j;
+    
+    const float* s = coast.tileSamples + (size_t)index * COAST_TILE_POINTS * COAST_TILE_POINTS + j * COAST_TILE_POINTS + i;
+    float a = s[0] + (s[1] - s[0]) * fx;
+    float b = s[COAST_TILE_POINTS] + (s[COAST_TILE_POINTS + 1] - s[COAST_TILE_POINTS]) * fx;
+    return a + (b - a) * fy;
+}
+
+// Direction away from land (gradient of the distance field)
+Vector2D GetShoreNormal(const Coastline& coast, float x, float y) {
+    const float h = COAST_CELL_SIZE * 0.5f;
+    float dx = GetShoreDistance(coast, x + h, y) - GetShoreDistance(coast, x - h, y);
+    float dy = GetShoreDistance(coast, x, y + h) - GetShoreDistance(coast, x, y - h);
+    return Vector2D(dx, dy).normalized();
+}
+
+// Whether a straight leg stays at least `margin` off the shore, stepping by the distance field
+bool IsPathClear(const Coastline& coast, float ax, float ay, float bx, float by, float margin) {
+    if (!coast.tileIndex) return true;
+    float dx = bx - ax, dy = by - ay;
+    float length = sqrtf(dx*dx + dy*dy);
+    if (length > 0.0f) {
+        dx /= length;
+        dy /= length;
+    }
+    
+    float s = 0.0f;
+    while (true) {
+        float d = GetShoreDistance(coast, ax + dx * s, ay + dy * s);
+        if (d < margin) return false;
+        if (s >= length) return true;
+        s = fminf(s + fmaxf(d - margin, COAST_CELL_SIZE * 0.5f), length);
+    }
+}
+
+// Speed multiplier for wind that has crossed land on its way here. Marches upwind,
+// stepping by the distance field so open water is skipped in a few lookups.
+float GetLandWindFactor(const Coastline& coast, float x, float y, float windX, float windY) {
+    if (!coast.tileIndex) return 1.0f;
+    Vector2D upwind = Vector2D(-windX, -windY).normalized();
+    if (upwind.x == 0.0f && upwind.y == 0.0f) return 1.0f;
+    
+    float s = 0.0f;
+    while (s < LAND_BLANKET_LENGTH) {
+        float d = GetShoreDistance(coast, x + upwind.x * s, y + upwind.y * s);
+        if (d <= 0.0f) return 1.0f - LAND_BLANKET_DEFICIT * (1.0f - s / LAND_BLANKET_LENGTH);
+        s += fmaxf(d, COAST_CELL_SIZE);
+    }
+    return 1.0f;
+}
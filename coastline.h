@@ -0,0 +1,46 @@
+#ifndef COASTLINE_H
+#define COASTLINE_H
+
+#include "types.h"
+
+const int COAST_TILE_SIZE = 32;                   // SDF cells per tile side
+const int COAST_TILE_POINTS = COAST_TILE_SIZE + 1; // samples per side, edges duplicated so tiles stand alone
+const float COAST_CELL_SIZE = 2.0f;               // meters between SDF samples
+const float COAST_SDF_RANGE = 32.0f;              // distances are clamped to +-this; tiles beyond it are not stored
+const int COAST_TILE_WATER = -1;
+const int COAST_TILE_LAND = -2;
+const float LAND_BLANKET_LENGTH = 150.0f;         // how far downwind of land the breeze is disturbed
+const float LAND_BLANKET_DEFICIT = 0.6f;          // speed lost right in the lee of the shore
+
+struct CoastPolygon {
+    int first, count;                             // range in Coastline::vertices
+    char name[32];
+};
+
+// Land as closed polygons, plus a sparse tiled signed distance field baked from them
+// at load time. Distances are positive over water and negative on land.
+struct Coastline {
+    Vector2D* vertices;
+    int vertexCount;
+    CoastPolygon* polygons;
+    int polygonCount;
+    
+    float originX, originY;                       // world position of SDF sample (0, 0)
+    int tilesX, tilesY;
+    int* tileIndex;                               // per tile: slot in tileSamples, or COAST_TILE_WATER/LAND
+    float* tileSamples;                           // COAST_TILE_POINTS^2 distances per stored tile
+    int tileCount;
+};
+
+void InitCoastline(Coastline& coast);
+bool LoadCoastline(Coastline& coast, const char* fileName);
+void AddCoastPolygon(Coastline& coast, const Vector2D points[], int count, const char* name);
+void BakeCoastline(Coastline& coast);
+void FreeCoastline(Coastline& coast);
+
+float GetShoreDistance(const Coastline& coast, float x, float y);
+Vector2D GetShoreNormal(const Coastline& coast, float x, float y);
+bool IsPathClear(const Coastline& coast, float ax, float ay, float bx, float by, float margin);
+float GetLandWindFactor(const Coastline& coast, float x, float y, float windX, float windY);
+
+#endif
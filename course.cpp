@@ -0,0 +1,188 @@
+#include "course.h"
+#include <cmath>
+#include <cstdlib>
+
+void InitCourse(Course& course) {
+    course.legs = nullptr;
+    course.legCount = 0;
+    course.buoys = nullptr;
+    course.buoyCount = 0;
+    course.gridX = course.gridY = 0.0f;
+    course.gridWidth = course.gridHeight = 0;
+    course.cellStart = nullptr;
+    course.cellBuoys = nullptr;
+}
+
+void FreeCourse(Course& course) {
+    free(course.legs);
+    free(course.buoys);
+    free(course.cellStart);
+    free(course.cellBuoys);
+    InitCourse(course);
+}
+
+static void AddBuoy(Course& course, float x, float y, int leg) {
+    course.buoys = (CourseBuoy*)realloc(course.buoys, (course.buoyCount + 1) * sizeof(CourseBuoy));
+    course.buoys[course.buoyCount++] = {x, y, leg};
+}
+
+static int AddLeg(Course& course, CourseLegType type, float ax, float ay, float bx, float by) {
+    course.legs = (CourseLeg*)realloc(course.legs, (course.legCount + 1) * sizeof(CourseLeg));
+    course.legs[course.legCount] = {type, ax, ay, bx, by, MARK_ZONE_RADIUS};
+    AddBuoy(course, ax, ay, course.legCount);
+    if (type != LEG_MARK) AddBuoy(course, bx, by, course.legCount);
+    return course.legCount++;
+}
+
+int AddCourseMark(Course& course, float x, float y) {
+    return AddLeg(course, LEG_MARK, x, y, x, y);
+}
+
+int AddCourseGate(Course& course, float ax, float ay, float bx, float by) {
+    return AddLeg(course, LEG_GATE, ax, ay, bx, by);
+}
+
+int AddCourseFinish(Course& course, float ax, float ay, float bx, float by) {
+    return AddLeg(course, LEG_FINISH, ax, ay, bx, by);
+}
+
+// Counting sort of buoys into a uniform grid over the course bounds
+void BuildCourseGrid(Course& course) {
+    free(course.cellStart);
+    free(course.cellBuoys);
+    course.cellStart = nullptr;
+    course.cellBuoys = nullptr;
+    course.gridWidth = course.gridHeight = 0;
+    if (course.buoyCount == 0) return;
+    
+    float minX = course.buoys[0].x, maxX = minX, minY = course.buoys[0].y, maxY = minY;
+    for (int i = 1; i < course.buoyCount; i++) {
+        minX = fminf(minX, course.buoys[i].x); maxX = fmaxf(maxX, course.buoys[i].x);
+        minY = fminf(minY, course.buoys[i].y); maxY = fmaxf(maxY, course.buoys[i].y);
+    }
+    course.gridX = minX;
+    course.gridY = minY;
+    course.gridWidth = (int)((maxX - minX) / COURSE_GRID_CELL) + 1;
+    course.gridHeight = (int)((maxY - minY) / COURSE_GRID_CELL) + 1;
+    int cells = course.gridWidth * course.gridHeight;
+    
+    course.cellStart = (int*)calloc(cells + 1, sizeof(int));
+    course.cellBuoys = (int*)malloc(course.buoyCount * sizeof(int));
+    int* cellOf = (int*)malloc(course.buoyCount * sizeof(int));
+    for (int i = 0; i < course.buoyCount; i++) {
+        int cx = (int)((course.buoys[i].x - minX) / COURSE_GRID_CELL);
+        int cy = (int)((course.buoys[i].y - minY) / COURSE_GRID_CELL);
+        cellOf[i] = cy * course.gridWidth + cx;
+        course.cellStart[cellOf[i] + 1]++;
+    }
+    for (int c = 0; c < cells; c++) course.cellStart[c + 1] += course.cellStart[c];
+    for (int i = 0; i < course.buoyCount; i++) course.cellBuoys[course.cellStart[cellOf[i]]++] = i;
+    for (int c = cells; c > 0; c--) course.cellStart[c] = course.cellStart[c - 1];
+    course.cellStart[0] = 0;
+    free(cellOf);
+}
+
+void ResetCourseProgress(CourseProgress& progress, const Boat& boat) {
+    progress.nextLeg = 0;
+    progress.finishTime = -1.0f;
+    progress.prevX = boat.x;
+    progress.prevY = boat.y;
+    progress.markTouches = 0;
+    progress.touchingBuoy = -1;
+}
+
+// Earliest fraction of the segment p0 -> p0 + d, at or after tStart, that completes the leg; -1 if none
+static float SweepLeg(const CourseLeg& leg, float px, float py, float dx, float dy, float tStart) {
+    if (leg.type == LEG_MARK) {
+        float ox = px + dx * tStart - leg.ax, oy = py + dy * tStart - leg.ay;
+        float a = dx*dx + dy*dy;
+        float b = dx*ox + dy*oy;
+        float c = ox*ox + oy*oy - leg.radius * leg.radius;
+        if (c <= 0.0f) return tStart;        // already inside the zone
+        float disc = b*b - a*c;
+        if (a <= 0.0f || disc < 0.0f) return -1.0f;
+        float t = tStart + (-b - sqrtf(disc)) / a;
+        if (t < tStart || t > 1.0f) return -1.0f;
+        return t;
+    }
+    
+    // Line and gate: forward across the normal, which points left of a -> b rotated counter-clockwise
+    float lx = leg.bx - leg.ax, ly = leg.by - leg.ay;
+    float nx = -ly, ny = lx;
+    float s0 = (px + dx * tStart - leg.ax) * nx + (py + dy * tStart - leg.ay) * ny;
+    float s1 = (px + dx - leg.ax) * nx + (py + dy - leg.ay) * ny;
+    if (!(s0 < 0.0f && s1 >= 0.0f)) return -1.0f;
+    float t = tStart + (1.0f - tStart) * s0 / (s0 - s1);
+    float qx = px + dx * t - leg.ax, qy = py + dy * t - leg.ay;
+    float u = (qx * lx + qy * ly) / (lx*lx + ly*ly);
+    return u >= 0.0f && u <= 1.0f ? t : -1.0f;
+}
+
+static int FindTouchedBuoy(const Course& course, float px, float py, float dx, float dy) {
+    if (course.gridWidth == 0) return -1;
+    float reach = MARK_TOUCH_DISTANCE;
+    int cx0 = (int)floorf((fminf(px, px + dx) - reach - course.gridX) / COURSE_GRID_CELL);
+    int cx1 = (int)floorf((fmaxf(px, px + dx) + reach - course.gridX) / COURSE_GRID_CELL);
+    int cy0 = (int)floorf((fminf(py, py + dy) - reach - course.gridY) / COURSE_GRID_CELL);
+    int cy1 = (int)floorf((fmaxf(py, py + dy) + reach - course.gridY) / COURSE_GRID_CELL);
+    if (cx0 < 0) cx0 = 0;
+    if (cy0 < 0) cy0 = 0;
+    if (cx1 >= course.gridWidth) cx1 = course.gridWidth - 1;
+    if (cy1 >= course.gridHeight) cy1 = course.gridHeight - 1;
+    
+    float len = dx*dx + dy*dy;
+    for (int cy = cy0; cy <= cy1; cy++) {
+        for (int cx = cx0; cx <= cx1; cx++) {
+            int cell = cy * course.gridWidth + cx;
+            for (int e = course.cellStart[cell]; e < course.cellStart[cell + 1]; e++) {
+                const CourseBuoy& buoy = course.buoys[course.cellBuoys[e]];
+                float t = len > 0.0f ? ((buoy.x - px) * dx + (buoy.y - py) * dy) / len : 0.0f;
+                t = fminf(fmaxf(t, 0.0f), 1.0f);
+                float ex = px + dx * t - buoy.x, ey = py + dy * t - buoy.y;
+                if (ex*ex + ey*ey <= reach * reach) return course.cellBuoys[e];
+            }
+        }
+    }
+    return -1;
+}
+
+// Tests each boat's motion since the last call as a swept segment, so nothing is missed no
+// matter how far a boat moves in one tick; several legs can complete in the same tick.
+// Returns the number of legs completed.
+int UpdateCourseProgress(const Course& course, const Boat boats[], CourseProgress progress[], int count, float time, float dt) {
+    int completed = 0;
+    for (int i = 0; i < count; i++) {
+        CourseProgress& p = progress[i];
+        float dx = boats[i].x - p.prevX;
+        float dy = boats[i].y - p.prevY;
+    
+        float t = 0.0f;
+        while (p.nextLeg < course.legCount) {
+            const CourseLeg& leg = course.legs[p.nextLeg];
+            t = SweepLeg(leg, p.prevX, p.prevY, dx, dy, t);
+            if (t < 0.0f) break;
+            p.nextLeg++;
+            completed++;
+            if (p.nextLeg == course.legCount) p.finishTime = time + t * dt;
+        }
+    
+        int touched = FindTouchedBuoy(course, p.prevX, p.prevY, dx, dy);
+        if (touched >= 0 && touched != p.touchingBuoy) p.markTouches++;
+        p.touchingBuoy = touched;
+    
+        p.prevX = boats[i].x;
+        p.prevY = boats[i].y;
+    }
+    return completed;
+}
+
+// Where to steer for the next leg: the mark itself, or the middle of a gate or line
+Waypoint GetCourseWaypoint(const Course& course, const CourseProgress& progress) {
+    Waypoint waypoint = {0.0f, 0.0f, false};
+    if (progress.nextLeg >= course.legCount) return waypoint;
+    const CourseLeg& leg = course.legs[progress.nextLeg];
+    waypoint.x = (leg.ax + leg.bx) * 0.5f;
+    waypoint.y = (leg.ay + leg.by) * 0.5f;
+    waypoint.active = true;
+    return waypoint;
+}
@@ -0,0 +1,61 @@
+#ifndef COURSE_H
+#define COURSE_H
+
+#include "types.h"
+
+const float MARK_ZONE_RADIUS = 10.0f;      // passing this close to a mark counts as rounding it
+const float MARK_TOUCH_DISTANCE = 1.5f;    // hull centerline to buoy center for a touch (penalty)
+const float COURSE_GRID_CELL = 32.0f;
+
+enum CourseLegType {
+    LEG_MARK,       // reach within the zone radius of (ax, ay)
+    LEG_GATE,       // pass between (ax, ay) and (bx, by)
+    LEG_FINISH      // cross the line from (ax, ay) to (bx, by)
+};
+
+// Gates and finish lines count when crossed with `a` on the left (port) hand and `b` on the right
+struct CourseLeg {
+    CourseLegType type;
+    float ax, ay, bx, by;
+    float radius;
+};
+
+// Every physical buoy of the course, for touch detection
+struct CourseBuoy {
+    float x, y;
+    int leg;
+};
+
+// Ordered legs plus a uniform grid over the buoys, rebuilt by BuildCourseGrid after editing
+struct Course {
+    CourseLeg* legs;
+    int legCount;
+    CourseBuoy* buoys;
+    int buoyCount;
+    
+    float gridX, gridY;
+    int gridWidth, gridHeight;
+    int* cellStart;                // gridWidth * gridHeight + 1
+    int* cellBuoys;
+};
+
+struct CourseProgress {
+    int nextLeg;                   // == legCount once finished
+    float finishTime;              // interpolated inside the tick, -1 until finished
+    float prevX, prevY;            // position at the start of the tick being tested
+    int markTouches;
+    int touchingBuoy;              // buoy in contact last tick, so one touch is counted once
+};
+
+void InitCourse(Course& course);
+int AddCourseMark(Course& course, float x, float y);
+int AddCourseGate(Course& course, float ax, float ay, float bx, float by);
+int AddCourseFinish(Course& course, float ax, float ay, float bx, float by);
+void BuildCourseGrid(Course& course);
+void FreeCourse(Course& course);
+
+void ResetCourseProgress(CourseProgress& progress, const Boat& boat);
+int UpdateCourseProgress(const Course& course, const Boat boats[], CourseProgress progress[], int count, float time, float dt);
+Waypoint GetCourseWaypoint(const Course& course, const CourseProgress& progress);
+
+#endif
@@ -0,0 +1,509 @@
+#include "distsweep.h"
+#include "jobs.h"
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <vector>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Every message is a header and `length` bytes of payload. Both ends are the same build,
+// so structs go over the wire as they are.
+enum SweepMessage {
+    SWEEP_MSG_CONFIG = 1,     // to worker: WireConfig, targets, track samples
+    SWEEP_MSG_RANGE,          // to worker: first run, end run
+    SWEEP_MSG_SHRINK,         // to worker: new end for the range in progress
+    SWEEP_MSG_DONE,           // to worker: exit
+    SWEEP_MSG_READY,          // to coordinator: wants a range
+    SWEEP_MSG_RESULTS         // to coordinator: SweepResult rows, in run order
+};
+
+struct MessageHeader {
+    unsigned int type;
+    unsigned int length;
+};
+
+struct WireConfig {
+    BoatParams base;
+    SweepAxis axes[SWEEP_PARAM_COUNT];
+    int seedCount;
+    unsigned long long firstSeed;
+    float windNoise;
+    int targetCount;
+    int trackCount;
+};
+
+static bool SendAll(int fd, const void* data, size_t size) {
+    const char* bytes = (const char*)data;
+    while (size > 0) {
+        ssize_t sent = send(fd, bytes, size, 0);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        bytes += sent;
+        size -= sent;
+    }
+    return true;
+}
+
+static bool RecvAll(int fd, void* data, size_t size) {
+    char* bytes = (char*)data;
+    while (size > 0) {
+        ssize_t got = recv(fd, bytes, size, 0);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return false;
+        bytes += got;
+        size -= got;
+    }
+    return true;
+}
+
+static bool SendMessage(int fd, unsigned int type, const void* payload, unsigned int length) {
+    MessageHeader header = {type, length};
+    return SendAll(fd, &header, sizeof(header)) && (length == 0 || SendAll(fd, payload, length));
+}
+
+static bool RecvMessage(int fd, MessageHeader& header, std::vector<char>& payload) {
+    if (!RecvAll(fd, &header, sizeof(header))) return false;
+    payload.resize(header.length);
+    return header.length == 0 || RecvAll(fd, payload.data(), header.length);
+}
+
+// Listening or connected stream socket for "unix:/path" or "host:port"
+static int OpenSocket(const char* address, bool listening) {
+    if (strncmp(address, "unix:", 5) == 0) {
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, address + 5, sizeof(addr.sun_path) - 1);
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+        if (listening) unlink(addr.sun_path);
+        bool ok = listening ? bind(fd, (sockaddr*)&addr, sizeof(addr)) == 0 && listen(fd, 64) == 0
+                            : connect(fd, (sockaddr*)&addr, sizeof(addr)) == 0;
+        if (!ok) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+    
+    const char* colon = strrchr(address, ':');
+    if (!colon) return -1;
+    char host[256];
+    size_t hostLength = colon - address < (long)sizeof(host) - 1 ? colon - address : sizeof(host) - 1;
+    memcpy(host, address, hostLength);
+    host[hostLength] = '\0';
+    
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (listening) hints.ai_flags = AI_PASSIVE;
+    addrinfo* list;
+    if (getaddrinfo(host[0] ? host : nullptr, colon + 1, &hints, &list) != 0) return -1;
+    
+    int fd = -1;
+    for (addrinfo* info = list; info && fd < 0; info = info->ai_next) {
+        fd = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+        if (fd < 0) continue;
+        int one = 1;
+        bool ok;
+        if (listening) {
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+            ok = bind(fd, info->ai_addr, info->ai_addrlen) == 0 && listen(fd, 64) == 0;
+        } else {
+            ok = connect(fd, info->ai_addr, info->ai_addrlen) == 0;
+            if (ok) setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+        if (!ok) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(list);
+    return fd;
+}
+
+// === WORKER ===
+
+static bool ReadConfig(const std::vector<char>& payload, SweepConfig& config,
+                       std::vector<SpeedTarget>& targets, std::vector<TrackSample>& track) {
+    WireConfig wire;
+    if (payload.size() < sizeof(wire)) return false;
+    memcpy(&wire, payload.data(), sizeof(wire));
+    if (wire.targetCount < 0 || wire.trackCount < 0) return false;
+    size_t targetBytes = (size_t)wire.targetCount * sizeof(SpeedTarget);
+    size_t trackBytes = (size_t)wire.trackCount * sizeof(TrackSample);
+    if (payload.size() != sizeof(wire) + targetBytes + trackBytes) return false;
+    
+    targets.resize(wire.targetCount);
+    track.resize(wire.trackCount);
+    memcpy(targets.data(), payload.data() + sizeof(wire), targetBytes);
+    memcpy(track.data(), payload.data() + sizeof(wire) + targetBytes, trackBytes);
+    
+    config = {};
+    config.base = wire.base;
+    memcpy(config.axes, wire.axes, sizeof(config.axes));
+    config.seedCount = wire.seedCount;
+    config.firstSeed = wire.firstSeed;
+    config.windNoise = wire.windNoise;
+    config.targets = wire.targetCount > 0 ? targets.data() : nullptr;
+    config.targetCount = wire.targetCount;
+    config.track = wire.trackCount > 0 ? track.data() : nullptr;
+    config.trackCount = wire.trackCount;
+    return true;
+}
+
+// Works through one range a batch at a time, checking between batches whether the
+// coordinator has given the back of it to someone else. Returns false once told to exit.
+static bool WorkRange(int fd, const SweepConfig& config, JobPool& pool, int first, int end, bool& ok) {
+    std::vector<SweepResult> results(SWEEP_WORKER_BATCH);
+    MessageHeader header;
+    std::vector<char> payload;
+    
+    for (int next = first; next < end; ) {
+        pollfd waiting = {fd, POLLIN, 0};
+        while (poll(&waiting, 1, 0) > 0) {
+            if (!RecvMessage(fd, header, payload)) return ok = false;
+            if (header.type == SWEEP_MSG_DONE) return false;
+            if (header.type == SWEEP_MSG_SHRINK && payload.size() == sizeof(int)) {
+                int shrunk;
+                memcpy(&shrunk, payload.data(), sizeof(shrunk));
+                if (shrunk < end) end = shrunk;
+            }
+        }
+        if (next >= end) break;
+    
+        int count = end - next < SWEEP_WORKER_BATCH ? end - next : SWEEP_WORKER_BATCH;
+        EvaluateSweepRuns(config, pool, next, count, results.data());
+        if (!SendMessage(fd, SWEEP_MSG_RESULTS, results.data(), count * sizeof(SweepResult))) return ok = false;
+        next += count;
+    }
+    return true;
+}
+
+int RunSweepWorker(const char* address, int threads) {
+    signal(SIGPIPE, SIG_IGN);
+    
+    // A remote worker may come up before its coordinator
+    int fd = -1;
+    for (int attempt = 0; attempt < 50 && fd < 0; attempt++) {
+        fd = OpenSocket(address, false);
+        if (fd < 0) usleep(100000);
+    }
+    if (fd < 0) {
+        fprintf(stderr, "worker: can't connect to %s\n", address);
+        return 1;
+    }
+    
+    MessageHeader header;
+    std::vector<char> payload;
+    SweepConfig config;
+    std::vector<SpeedTarget> targets;
+    std::vector<TrackSample> track;
+    if (!RecvMessage(fd, header, payload) || header.type != SWEEP_MSG_CONFIG || !ReadConfig(payload, config, targets, track)) {
+        fprintf(stderr, "worker: bad configuration from %s\n", address);
+        close(fd);
+        return 1;
+    }
+    
+    static JobPool pool;
+    InitJobPoolThreads(pool, threads);
+    bool ok = SendMessage(fd, SWEEP_MSG_READY, nullptr, 0);
+    while (ok && RecvMessage(fd, header, payload)) {
+        if (header.type == SWEEP_MSG_DONE) break;
+        if (header.type != SWEEP_MSG_RANGE || payload.size() != 2 * sizeof(int)) continue;   // stale shrink
+    
+        int range[2];
+        memcpy(range, payload.data(), sizeof(range));
+        if (!WorkRange(fd, config, pool, range[0], range[1], ok)) break;
+        ok = SendMessage(fd, SWEEP_MSG_READY, nullptr, 0);
+    }
+    ShutdownJobPool(pool);
+    close(fd);
+    return ok ? 0 : 1;
+}
+
+// === COORDINATOR ===
+
+struct PendingRange {
+    int first, end;
+    int attempts;             // workers that died holding it
+};
+
+struct WorkerLink {
+    int fd;
+    bool busy;
+    int progress, end;        // part of the current range not yet reported
+    int attempts;
+    std::vector<char> inbox;
+};
+
+struct Coordinator {
+    const SweepConfig* config;
+    int runCount;
+    std::vector<char> configMessage;
+    int listenFd;
+    std::vector<WorkerLink> links;
+    std::deque<PendingRange> queue;
+    
+    // Merge: results are held until every earlier run is in, then written in order
+    int frontier;
+    std::map<int, SweepResult> reorder;
+    std::vector<SweepResult> group;
+    FILE* out;
+    SweepResult best;
+    bool failed;
+    
+    // Local workers
+    const char* address;
+    int workerThreads;
+    int localAlive;
+    int respawns;
+};
+
+static std::vector<char> BuildConfigMessage(const SweepConfig& config) {
+    WireConfig wire = {};
+    wire.base = config.base;
+    memcpy(wire.axes, config.axes, sizeof(wire.axes));
+    wire.seedCount = config.seedCount;
+    wire.firstSeed = config.firstSeed;
+    wire.windNoise = config.windNoise;
+    wire.targetCount = config.targets ? config.targetCount : 0;
+    wire.trackCount = config.track ? config.trackCount : 0;
+    
+    size_t targetBytes = (size_t)wire.targetCount * sizeof(SpeedTarget);
+    size_t trackBytes = (size_t)wire.trackCount * sizeof(TrackSample);
+    std::vector<char> message(sizeof(wire) + targetBytes + trackBytes);
+    memcpy(message.data(), &wire, sizeof(wire));
+    if (targetBytes) memcpy(message.data() + sizeof(wire), config.targets, targetBytes);
+    if (trackBytes) memcpy(message.data() + sizeof(wire) + targetBytes, config.track, trackBytes);
+    return message;
+}
+
+static void SpawnLocalWorker(Coordinator& coordinator) {
+    fflush(nullptr);
+    pid_t pid = fork();
+    if (pid == 0) {
+        // The child mustn't keep the coordinator's ends open, or nobody would see it die
+        close(coordinator.listenFd);
+        for (const WorkerLink& link : coordinator.links) close(link.fd);
+        _exit(RunSweepWorker(coordinator.address, coordinator.workerThreads));
+    }
+    if (pid > 0) coordinator.localAlive++;
+}
+
+static void AcceptResult(Coordinator& coordinator, const SweepResult& result) {
+    int run = (int)result.run;
+    // Stolen and requeued ranges can come back twice
+    if (run < coordinator.frontier || run >= coordinator.runCount || coordinator.reorder.count(run)) return;
+    coordinator.reorder[run] = result;
+    
+    while (!coordinator.reorder.empty() && coordinator.reorder.begin()->first == coordinator.frontier) {
+        const SweepResult& next = coordinator.reorder.begin()->second;
+        if (next.rmsError < coordinator.best.rmsError) coordinator.best = next;
+        coordinator.group.push_back(next);
+        coordinator.reorder.erase(coordinator.reorder.begin());
+        coordinator.frontier++;
+        if ((int)coordinator.group.size() == SWEEP_BLOCK_RUNS) {
+            WriteSweepRowGroup(coordinator.out, coordinator.group.data(), SWEEP_BLOCK_RUNS);
+            coordinator.group.clear();
+        }
+    }
+}
+
+static void SendRange(WorkerLink& link, int first, int end, int attempts) {
+    int range[2] = {first, end};
+    link.busy = true;
+    link.progress = first;
+    link.end = end;
+    link.attempts = attempts;
+    SendMessage(link.fd, SWEEP_MSG_RANGE, range, sizeof(range));
+}
+
+static bool CanDequeue(const Coordinator& coordinator) {
+    return !coordinator.queue.empty() && coordinator.queue.front().first < coordinator.frontier + SWEEP_REORDER_RUNS;
+}
+
+// From the queue if its next range is within the reorder window, otherwise the back half of
+// the biggest range still out. The batch the victim is working on now is left alone.
+static void AssignWork(Coordinator& coordinator, WorkerLink& link) {
+    if (CanDequeue(coordinator)) {
+        PendingRange range = coordinator.queue.front();
+        coordinator.queue.pop_front();
+        SendRange(link, range.first, range.end, range.attempts);
+        return;
+    }
+    
+    WorkerLink* victim = nullptr;
+    int mostLeft = 2 * SWEEP_WORKER_BATCH;
+    for (WorkerLink& other : coordinator.links) {
+        if (!other.busy || &other == &link) continue;
+        int left = other.end - other.progress - SWEEP_WORKER_BATCH;
+        if (left >= mostLeft) {
+            mostLeft = left;
+            victim = &other;
+        }
+    }
+    if (!victim) return;
+    
+    int middle = victim->end - mostLeft / 2;
+    int end = victim->end;
+    victim->end = middle;
+    SendMessage(victim->fd, SWEEP_MSG_SHRINK, &middle, sizeof(middle));
+    SendRange(link, middle, end, victim->attempts);
+}
+
+static void DropLink(Coordinator& coordinator, int index) {
+    WorkerLink& link = coordinator.links[index];
+    if (link.busy && link.progress < link.end) {
+        PendingRange range = {link.progress, link.end, link.attempts + 1};
+        fprintf(stderr, "sweep: lost a worker, runs %d-%d queued again\n", range.first, range.end - 1);
+        if (range.attempts >= SWEEP_MAX_ATTEMPTS) {
+            fprintf(stderr, "sweep: runs %d-%d failed %d times, giving up\n", range.first, range.end - 1, range.attempts);
+            coordinator.failed = true;
+        }
+        // In run order, so the range holding up the merge is always the next one handed out
+        auto at = coordinator.queue.begin();
+        while (at != coordinator.queue.end() && at->first < range.first) ++at;
+        coordinator.queue.insert(at, range);
+    }
+    close(link.fd);
+    coordinator.links.erase(coordinator.links.begin() + index);
+}
+
+// Returns false if the worker sent something malformed
+static bool HandleMessages(Coordinator& coordinator, WorkerLink& link) {
+    size_t offset = 0;
+    while (link.inbox.size() - offset >= sizeof(MessageHeader)) {
+        MessageHeader header;
+        memcpy(&header, link.inbox.data() + offset, sizeof(header));
+        if (link.inbox.size() - offset - sizeof(header) < header.length) break;
+        const char* payload = link.inbox.data() + offset + sizeof(header);
+    
+        if (header.type == SWEEP_MSG_READY) {
+            link.busy = false;
+            AssignWork(coordinator, link);
+        } else if (header.type == SWEEP_MSG_RESULTS && header.length % sizeof(SweepResult) == 0) {
+            for (size_t i = 0; i < header.length / sizeof(SweepResult); i++) {
+                SweepResult result;
+                memcpy(&result, payload + i * sizeof(SweepResult), sizeof(result));
+                AcceptResult(coordinator, result);
+                if ((int)result.run + 1 > link.progress) link.progress = result.run + 1;
+            }
+        } else {
+            return false;
+        }
+        offset += sizeof(header) + header.length;
+    }
+    link.inbox.erase(link.inbox.begin(), link.inbox.begin() + offset);
+    return true;
+}
+
+static void ReapLocalWorkers(Coordinator& coordinator) {
+    int status;
+    while (waitpid(-1, &status, WNOHANG) > 0) {
+        coordinator.localAlive--;
+        if (coordinator.frontier < coordinator.runCount && coordinator.respawns < SWEEP_MAX_RESPAWNS) {
+            coordinator.respawns++;
+            SpawnLocalWorker(coordinator);
+        }
+    }
+}
+
+bool RunSweepCoordinator(const SweepConfig& config, const char* address, int localWorkers, int workerThreads,
+                         FILE* out, SweepResult& best) {
+    signal(SIGPIPE, SIG_IGN);
+    Coordinator coordinator = {};
+    coordinator.config = &config;
+    coordinator.runCount = GetSweepRunCount(config);
+    if (coordinator.runCount < 0) return false;
+    coordinator.configMessage = BuildConfigMessage(config);
+    coordinator.listenFd = OpenSocket(address, true);
+    coordinator.out = out;
+    coordinator.best.rmsError = INFINITY;
+    coordinator.address = address;
+    coordinator.workerThreads = workerThreads;
+    if (coordinator.listenFd < 0) {
+        fprintf(stderr, "sweep: can't listen on %s\n", address);
+        return false;
+    }
+    
+    for (int first = 0; first < coordinator.runCount; first += SWEEP_CHUNK_RUNS) {
+        int end = first + SWEEP_CHUNK_RUNS < coordinator.runCount ? first + SWEEP_CHUNK_RUNS : coordinator.runCount;
+        coordinator.queue.push_back({first, end, 0});
+    }
+    for (int i = 0; i < localWorkers; i++) SpawnLocalWorker(coordinator);
+    
+    WriteSweepHeader(out);
+    std::vector<pollfd> fds;
+    std::vector<char> buffer(1 << 16);
+    while (coordinator.frontier < coordinator.runCount && !coordinator.failed) {
+        if (localWorkers > 0 && coordinator.localAlive == 0 && coordinator.links.empty()) {
+            fprintf(stderr, "sweep: no workers left\n");
+            coordinator.failed = true;
+            break;
+        }
+    
+        fds.clear();
+        fds.push_back({coordinator.listenFd, POLLIN, 0});
+        for (const WorkerLink& link : coordinator.links) fds.push_back({link.fd, POLLIN, 0});
+        if (poll(fds.data(), fds.size(), 100) < 0 && errno != EINTR) break;
+    
+        // Walk backwards so dropping a link doesn't shift the ones still to visit
+        for (int i = (int)coordinator.links.size() - 1; i >= 0; i--) {
+            if (!(fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            WorkerLink& link = coordinator.links[i];
+            ssize_t got = recv(link.fd, buffer.data(), buffer.size(), 0);
+            if (got <= 0) {
+                if (got < 0 && errno == EINTR) continue;
+                DropLink(coordinator, i);
+                continue;
+            }
+            link.inbox.insert(link.inbox.end(), buffer.data(), buffer.data() + got);
+            if (!HandleMessages(coordinator, link)) DropLink(coordinator, i);
+        }
+    
+        if (fds[0].revents & POLLIN) {
+            int fd = accept(coordinator.listenFd, nullptr, nullptr);
+            if (fd >= 0) {
+                int one = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                if (SendMessage(fd, SWEEP_MSG_CONFIG, coordinator.configMessage.data(), coordinator.configMessage.size())) {
+                    // Busy with an empty range until its first ready, so nothing is sent before then
+                    WorkerLink link = {fd, true, 0, 0, 0, {}};
+                    coordinator.links.push_back(link);
+                } else {
+                    close(fd);
+                }
+            }
+        }
+    
+        // Ranges queued again by a dropped link, or let in as the merge moves on, go to whoever is idle
+        for (WorkerLink& link : coordinator.links) {
+            if (!link.busy && CanDequeue(coordinator)) AssignWork(coordinator, link);
+        }
+        ReapLocalWorkers(coordinator);
+    }
+    
+    for (WorkerLink& link : coordinator.links) {
+        SendMessage(link.fd, SWEEP_MSG_DONE, nullptr, 0);
+        close(link.fd);
+    }
+    coordinator.links.clear();
+    close(coordinator.listenFd);
+    if (strncmp(address, "unix:", 5) == 0) unlink(address + 5);
+    while (coordinator.localAlive > 0 && wait(nullptr) > 0) coordinator.localAlive--;
+    
+    if (coordinator.failed) return false;
+    if (!coordinator.group.empty()) WriteSweepRowGroup(out, coordinator.group.data(), (int)coordinator.group.size());
+    best = coordinator.best;
+    return WriteSweepEnd(out);
+}
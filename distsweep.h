@@ -0,0 +1,28 @@
+#ifndef DISTSWEEP_H
+#define DISTSWEEP_H
+
+#include "sweep.h"
+#include <cstdio>
+
+// Sweeps spread over worker processes, on this machine or others (POSIX sockets).
+// Addresses are "unix:/path/to/socket" or "host:port"; a coordinator listening on
+// ":port" accepts from any interface.
+//
+// Workers pull ranges of runs and stream results back in small batches. A worker that runs out
+// of ranges takes the back half of whichever worker has the most left, and that worker is told
+// to stop early. A worker that dies has its unfinished range queued again. Results are merged
+// back into run order as they arrive, so the output is the same file a local sweep writes.
+// Ranges are only handed out up to SWEEP_REORDER_RUNS past the first unfinished run, which
+// bounds what the merge holds; past that, idle workers split what the others are working on.
+
+const int SWEEP_CHUNK_RUNS = 4096;         // runs per range handed out from the queue
+const int SWEEP_WORKER_BATCH = 256;        // runs per results message
+const int SWEEP_REORDER_RUNS = 32 * SWEEP_CHUNK_RUNS;   // how far ahead of the merge ranges go out
+const int SWEEP_MAX_ATTEMPTS = 3;          // a range that has killed this many workers fails the sweep
+const int SWEEP_MAX_RESPAWNS = 16;         // replacements forked for local workers that die
+
+bool RunSweepCoordinator(const SweepConfig& config, const char* address, int localWorkers, int workerThreads,
+                         FILE* out, SweepResult& best);
+int RunSweepWorker(const char* address, int threads);
+
+#endif
@@ -0,0 +1,84 @@
+#include "dynres.h"
+#include <rlgl.h>
+#include <cmath>
+
+const float DYNRES_RAISE_DELAY = 2.0f;        // seconds under budget before scaling up
+const float DYNRES_MAX_RAISE_DELAY = 16.0f;
+
+void InitDynamicResolution(DynamicResolution& dynres, int width, int height, float frameBudget) {
+    dynres.target = LoadRenderTexture(width, height);
+    SetTextureFilter(dynres.target.texture, TEXTURE_FILTER_BILINEAR);
+    dynres.fullWidth = width;
+    dynres.fullHeight = height;
+    dynres.scale = DYNRES_MAX_SCALE;
+    dynres.frameBudget = frameBudget;
+    dynres.smoothedFrameTime = frameBudget;
+    dynres.cooldown = 0.0f;
+    dynres.headroomTime = 0.0f;
+    dynres.raiseDelay = DYNRES_RAISE_DELAY;
+    dynres.justRaised = false;
+}
+
+void UnloadDynamicResolution(DynamicResolution& dynres) {
+    UnloadRenderTexture(dynres.target);
+}
+
+void UpdateDynamicResolution(DynamicResolution& dynres, float frameTime) {
+    // No GPU timer queries in raylib, so steer on the smoothed frame time against the budget
+    dynres.smoothedFrameTime += (frameTime - dynres.smoothedFrameTime) * 0.1f;
+    
+    dynres.cooldown -= frameTime;
+    if (dynres.cooldown > 0.0f) return;
+    
+    if (dynres.smoothedFrameTime > dynres.frameBudget * 1.1f) {
+        if (dynres.scale > DYNRES_MIN_SCALE) {
+            // Dropping right after a raise means the raise was too optimistic; wait longer next time
+            if (dynres.justRaised) {
+                dynres.raiseDelay = fminf(dynres.raiseDelay * 2.0f, DYNRES_MAX_RAISE_DELAY);
+            }
+            dynres.scale = fmaxf(dynres.scale - DYNRES_STEP, DYNRES_MIN_SCALE);
+            dynres.cooldown = 0.25f;
+        }
+        dynres.headroomTime = 0.0f;
+        dynres.justRaised = false;
+    } else if (dynres.smoothedFrameTime < dynres.frameBudget * 1.02f) {
+        dynres.headroomTime += frameTime;
+        if (dynres.headroomTime > 1.0f) dynres.justRaised = false;
+        if (dynres.headroomTime > dynres.raiseDelay && dynres.scale < DYNRES_MAX_SCALE) {
+            dynres.scale = fminf(dynres.scale + DYNRES_STEP, DYNRES_MAX_SCALE);
+            dynres.cooldown = 0.5f;
+            dynres.headroomTime = 0.0f;
+            dynres.justRaised = true;
+        } else if (dynres.headroomTime > DYNRES_MAX_RAISE_DELAY) {
+            dynres.raiseDelay = DYNRES_RAISE_DELAY;
+        }
+    }
+}
+
+int GetSceneRenderWidth(const DynamicResolution& dynres) {
+    return (int)roundf(dynres.fullWidth * dynres.scale);
+}
+
+int GetSceneRenderHeight(const DynamicResolution& dynres) {
+    return (int)roundf(dynres.fullHeight * dynres.scale);
+}
+
+void BeginSceneRender(const DynamicResolution& dynres) {
+    BeginTextureMode(dynres.target);
+    // Same aspect as the full target, so BeginMode3D's projection still fits
+    rlViewport(0, 0, GetSceneRenderWidth(dynres), GetSceneRenderHeight(dynres));
+}
+
+void EndSceneRender(const DynamicResolution& dynres) {
+    EndTextureMode();
+}
+
+void DrawSceneUpscaled(const DynamicResolution& dynres) {
+    float width = (float)GetSceneRenderWidth(dynres);
+    float height = (float)GetSceneRenderHeight(dynres);
+    
+    // Render textures are stored bottom-up, hence the negative source height
+    Rectangle source = {0.0f, 0.0f, width, -height};
+    Rectangle dest = {0.0f, 0.0f, (float)dynres.fullWidth, (float)dynres.fullHeight};
+    DrawTexturePro(dynres.target.texture, source, dest, (Vector2){0, 0}, 0.0f, WHITE);
+}
@@ -0,0 +1,33 @@
+#ifndef DYNRES_H
+#define DYNRES_H
+
+#include <raylib.h>
+
+const float DYNRES_MIN_SCALE = 0.5f;
+const float DYNRES_MAX_SCALE = 1.0f;
+const float DYNRES_STEP = 0.05f;
+
+// 3D scene is drawn into the lower-left corner of a full-size render texture,
+// sized by the current scale, then stretched over the window
+struct DynamicResolution {
+    RenderTexture2D target;
+    int fullWidth, fullHeight;
+    float scale;
+    float frameBudget;         // seconds
+    float smoothedFrameTime;
+    float cooldown;            // seconds until the next scale change is allowed
+    float headroomTime;        // how long frames have been under budget
+    float raiseDelay;          // headroom needed before scaling back up
+    bool justRaised;
+};
+
+void InitDynamicResolution(DynamicResolution& dynres, int width, int height, float frameBudget);
+void UnloadDynamicResolution(DynamicResolution& dynres);
+void UpdateDynamicResolution(DynamicResolution& dynres, float frameTime);
+int GetSceneRenderWidth(const DynamicResolution& dynres);
+int GetSceneRenderHeight(const DynamicResolution& dynres);
+void BeginSceneRender(const DynamicResolution& dynres);
+void EndSceneRender(const DynamicResolution& dynres);
+void DrawSceneUpscaled(const DynamicResolution& dynres);
+
+#endif
@@ -0,0 +1,143 @@
+#include "fleetrendering.h"
+#include <raymath.h>
+#include <cmath>
+
+static Material MakeInstancedMaterial(const Shader& shader, Color color) {
+    Material material = LoadMaterialDefault();
+    material.shader = shader;
+    material.maps[MATERIAL_MAP_DIFFUSE].color = color;
+    return material;
+}
+
+void InitFleetRenderer(FleetRenderer& renderer, const Model& hullModel, const Shader& instanceShader) {
+    renderer.instanceShader = instanceShader;
+    renderer.instanceShader.locs[SHADER_LOC_MATRIX_MVP] = GetShaderLocation(instanceShader, "mvp");
+    renderer.instanceShader.locs[SHADER_LOC_MATRIX_MODEL] = GetShaderLocationAttrib(instanceShader, "instanceTransform");
+
+    renderer.hullModel = hullModel;
+    for (int i = 0; i < renderer.hullModel.materialCount; i++) {
+        renderer.hullModel.materials[i].shader = renderer.instanceShader;
+    }
+
+    // Same dimensions as the sail DrawBoat3D uses
+    renderer.sailMesh = GenMeshCube(0.2f, 3.0f, 4.0f);
+    renderer.simpleHullMesh = GenMeshCube(1.2f, 0.8f, 5.0f);
+    renderer.billboardMesh = GenMeshPoly(3, 0.5f);
+
+    renderer.sailMaterial = MakeInstancedMaterial(renderer.instanceShader, YELLOW);
+    renderer.simpleHullMaterial = MakeInstancedMaterial(renderer.instanceShader, WHITE);
+    renderer.billboardMaterial = MakeInstancedMaterial(renderer.instanceShader, WHITE);
+
+    for (int lod = 0; lod < LOD_COUNT; lod++) renderer.bucketCount[lod] = 0;
+}
+
+void UnloadFleetRenderer(FleetRenderer& renderer) {
+    UnloadMesh(renderer.sailMesh);
+    UnloadMesh(renderer.simpleHullMesh);
+    UnloadMesh(renderer.billboardMesh);
+    MemFree(renderer.sailMaterial.maps);
+    MemFree(renderer.simpleHullMaterial.maps);
+    MemFree(renderer.billboardMaterial.maps);
+    UnloadShader(renderer.instanceShader);
+}
+
+void ComputeFleetTransforms(FleetRenderer& renderer, const Boat boats[], int count, const Camera3D& camera, int screenHeight) {
+    static float sinHeading[MAX_FLEET_BOATS], cosHeading[MAX_FLEET_BOATS];
+    static float sinHeel[MAX_FLEET_BOATS], cosHeel[MAX_FLEET_BOATS];
+    static float sinSail[MAX_FLEET_BOATS], cosSail[MAX_FLEET_BOATS];
+    static float screenLength[MAX_FLEET_BOATS];
+
+    if (count > MAX_FLEET_BOATS) count = MAX_FLEET_BOATS;
+
+    // Pass 1: all trig and screen sizes in straight loops the compiler can vectorize
+    for (int i = 0; i < count; i++) {
+        sinHeading[i] = sinf(boats[i].heading);
+        cosHeading[i] = cosf(boats[i].heading);
+        sinHeel[i] = sinf(boats[i].heel);
+        cosHeel[i] = cosf(boats[i].heel);
+        sinSail[i] = sinf(boats[i].sailAngle);
+        cosSail[i] = cosf(boats[i].sailAngle);
+    }
+
+    float viewHeight = 2.0f * tanf(camera.fovy * 0.5f * DEG2RAD);
+    for (int i = 0; i < count; i++) {
+        float worldPerScreen = camera.fovy;
+        if (camera.projection == CAMERA_PERSPECTIVE) {
+            float dx = boats[i].x - camera.position.x;
+            float dy = -camera.position.y;
+            float dz = -boats[i].y - camera.position.z;
+            worldPerScreen = sqrtf(dx*dx + dy*dy + dz*dz) * viewHeight;
+        }
+        screenLength[i] = boats[i].length * screenHeight / worldPerScreen;
+    }
+
+    for (int lod = 0; lod < LOD_COUNT; lod++) renderer.bucketCount[lod] = 0;
+
+    // Pass 2: closed form of DrawBoat3D's matrix chain, written straight into the LOD buckets.
+    // Hull = T(x,0,-y) * RotY(pi - heading) * RotZ(-heel)
+    // Sail = Hull * T(0,2,0) * RotY(-sailAngle) * T(0,0,-2)
+    for (int i = 0; i < count; i++) {
+        int lod = screenLength[i] >= LOD_FULL_PIXELS ? LOD_FULL :
+                  screenLength[i] >= LOD_SIMPLE_PIXELS ? LOD_SIMPLE : LOD_BILLBOARD;
+        int slot = renderer.bucketCount[lod]++;
+
+        float sa = sinHeading[i], ca = -cosHeading[i];   // sin/cos(pi - heading)
+        float sb = -sinHeel[i], cb = cosHeel[i];         // sin/cos(-heel)
+        float tx = boats[i].x, tz = -boats[i].y;
+
+        Matrix& hull = renderer.hullTransforms[lod][slot];
+        if (lod == LOD_BILLBOARD) {
+            // Flat marker: yaw only, scaled to boat length
+            float s = boats[i].length;
+            hull = (Matrix){
+                ca*s, 0.0f, sa*s, tx,
+                0.0f, s,    0.0f, 0.0f,
+                -sa*s, 0.0f, ca*s, tz,
+                0.0f, 0.0f, 0.0f, 1.0f
+            };
+            continue;
+        }
+
+        hull = (Matrix){
+            ca*cb,  -ca*sb, sa,   tx,
+            sb,     cb,     0.0f, 0.0f,
+            -sa*cb, sa*sb,  ca,   tz,
+            0.0f,   0.0f,   0.0f, 1.0f
+        };
+
+        float sc = -sinSail[i], cc = cosSail[i];         // sin/cos(-sailAngle)
+        float ox = -2.0f * sc, oy = 2.0f, oz = -2.0f * cc;
+        renderer.sailTransforms[lod][slot] = (Matrix){
+            hull.m0*cc - hull.m8*sc,  hull.m4, hull.m0*sc + hull.m8*cc,  tx + hull.m0*ox + hull.m4*oy + hull.m8*oz,
+            hull.m1*cc - hull.m9*sc,  hull.m5, hull.m1*sc + hull.m9*cc,  hull.m1*ox + hull.m5*oy + hull.m9*oz,
+            hull.m2*cc - hull.m10*sc, hull.m6, hull.m2*sc + hull.m10*cc, tz + hull.m2*ox + hull.m6*oy + hull.m10*oz,
+            0.0f, 0.0f, 0.0f, 1.0f
+        };
+
+        if (lod == LOD_FULL) hull = MatrixMultiply(renderer.hullModel.transform, hull);
+    }
+}
+
+void DrawFleet3D(FleetRenderer& renderer, const Boat boats[], int count, const Camera3D& camera, int screenHeight) {
+    ComputeFleetTransforms(renderer, boats, count, camera, screenHeight);
+
+    int fullCount = renderer.bucketCount[LOD_FULL];
+    if (fullCount > 0) {
+        const Model& hull = renderer.hullModel;
+        for (int m = 0; m < hull.meshCount; m++) {
+            DrawMeshInstanced(hull.meshes[m], hull.materials[hull.meshMaterial[m]], renderer.hullTransforms[LOD_FULL], fullCount);
+        }
+        DrawMeshInstanced(renderer.sailMesh, renderer.sailMaterial, renderer.sailTransforms[LOD_FULL], fullCount);
+    }
+
+    int simpleCount = renderer.bucketCount[LOD_SIMPLE];
+    if (simpleCount > 0) {
+        DrawMeshInstanced(renderer.simpleHullMesh, renderer.simpleHullMaterial, renderer.hullTransforms[LOD_SIMPLE], simpleCount);
+        DrawMeshInstanced(renderer.sailMesh, renderer.sailMaterial, renderer.sailTransforms[LOD_SIMPLE], simpleCount);
+    }
+
+    int billboardCount = renderer.bucketCount[LOD_BILLBOARD];
+    if (billboardCount > 0) {
+        DrawMeshInstanced(renderer.billboardMesh, renderer.billboardMaterial, renderer.hullTransforms[LOD_BILLBOARD], billboardCount);
+    }
+}
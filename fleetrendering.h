@@ -0,0 +1,41 @@
+#ifndef FLEETRENDERING_H
+#define FLEETRENDERING_H
+
+#include "types.h"
+#include <raylib.h>
+
+const int MAX_FLEET_BOATS = 512;
+
+// Detail level picked per boat from its on-screen length
+enum BoatLOD {
+    LOD_FULL,         // sailboat.glb hull + sail
+    LOD_SIMPLE,       // box hull + sail
+    LOD_BILLBOARD,    // flat marker on the water
+    LOD_COUNT
+};
+
+const float LOD_FULL_PIXELS = 40.0f;     // Boat length on screen needed for full model
+const float LOD_SIMPLE_PIXELS = 12.0f;   // Below this the boat is just a marker
+
+struct FleetRenderer {
+    Shader instanceShader;
+    Model hullModel;
+    Mesh sailMesh;
+    Mesh simpleHullMesh;
+    Mesh billboardMesh;
+    Material sailMaterial;
+    Material simpleHullMaterial;
+    Material billboardMaterial;
+    
+    // Per-LOD instance buckets, rebuilt every frame
+    Matrix hullTransforms[LOD_COUNT][MAX_FLEET_BOATS];
+    Matrix sailTransforms[LOD_COUNT][MAX_FLEET_BOATS];
+    int bucketCount[LOD_COUNT];
+};
+
+void InitFleetRenderer(FleetRenderer& renderer, const Model& hullModel, const Shader& instanceShader);
+void UnloadFleetRenderer(FleetRenderer& renderer);
+void ComputeFleetTransforms(FleetRenderer& renderer, const Boat boats[], int count, const Camera3D& camera, int screenHeight);
+void DrawFleet3D(FleetRenderer& renderer, const Boat boats[], int count, const Camera3D& camera, int screenHeight);
+
+#endif
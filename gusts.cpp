@@ -0,0 +1,104 @@
+#include "gusts.h"
+#include "rng.h"
+#include <cmath>
+
+const int GUST_MASK = GUST_TILE_SIZE - 1;
+const int GUST_OCTAVES = 3;
+const int GUST_BASE_LATTICE = 4;         // lattice cells across the tile for the coarsest octave
+
+static float SmoothStep(float t) {
+    return t * t * (3.0f - 2.0f * t);
+}
+
+// Value noise on a lattice that wraps every `period` cells, so the tile repeats seamlessly
+static float LatticeNoise(const float* lattice, int period, float u, float v) {
+    int i = (int)u;
+    int j = (int)v;
+    float fx = SmoothStep(u - i);
+    float fy = SmoothStep(v - j);
+    int i1 = (i + 1) % period;
+    int j1 = (j + 1) % period;
+    
+    float a = lattice[j * period + i] + (lattice[j * period + i1] - lattice[j * period + i]) * fx;
+    float b = lattice[j1 * period + i] + (lattice[j1 * period + i1] - lattice[j1 * period + i]) * fx;
+    return a + (b - a) * fy;
+}
+
+static void FillNoiseLayer(float* out, Rng& rng) {
+    float lattice[GUST_TILE_SIZE * GUST_TILE_SIZE];
+    for (int t = 0; t < GUST_TILE_SIZE * GUST_TILE_SIZE; t++) out[t] = 0.0f;
+    
+    float amplitude = 1.0f, total = 0.0f;
+    for (int octave = 0; octave < GUST_OCTAVES; octave++) {
+        int period = GUST_BASE_LATTICE << octave;
+        for (int k = 0; k < period * period; k++) lattice[k] = RandomRange(rng, -1.0f, 1.0f);
+    
+        float scale = (float)period / GUST_TILE_SIZE;
+        for (int y = 0; y < GUST_TILE_SIZE; y++) {
+            for (int x = 0; x < GUST_TILE_SIZE; x++) {
+                out[y * GUST_TILE_SIZE + x] += amplitude * LatticeNoise(lattice, period, x * scale, y * scale);
+            }
+        }
+        total += amplitude;
+        amplitude *= 0.5f;
+    }
+    
+    // Stretch to the full -1..1 range so the amplitudes mean what they say
+    float peak = 0.0f;
+    for (int t = 0; t < GUST_TILE_SIZE * GUST_TILE_SIZE; t++) peak = fmaxf(peak, fabsf(out[t]));
+    float norm = peak > 0.0f ? 1.0f / peak : 1.0f / total;
+    for (int t = 0; t < GUST_TILE_SIZE * GUST_TILE_SIZE; t++) out[t] *= norm;
+}
+
+// Scratch is on the stack so several threads can bake patterns at once
+void InitGustModel(GustModel& gusts, unsigned long long seed) {
+    float speedNoise[GUST_TILE_SIZE * GUST_TILE_SIZE];
+    float directionNoise[GUST_TILE_SIZE * GUST_TILE_SIZE];
+    
+    Rng rng;
+    SeedRng(rng, seed);
+    FillNoiseLayer(speedNoise, rng);
+    FillNoiseLayer(directionNoise, rng);
+    
+    for (int t = 0; t < GUST_TILE_SIZE * GUST_TILE_SIZE; t++) {
+        float shift = directionNoise[t] * GUST_DIRECTION_AMPLITUDE;
+        gusts.texels[t].gain = 1.0f + speedNoise[t] * GUST_SPEED_AMPLITUDE;
+        gusts.texels[t].cosShift = cosf(shift);
+        gusts.texels[t].sinShift = sinf(shift);
+    }
+}
+
+// Scales and veers/backs each wind vector in place. The pattern is sampled at the point
+// it was before being blown `offset` downwind, so gusts and lulls march down the course with the breeze.
+void ApplyGusts(const GustModel& gusts, const float xs[], const float ys[], int count, Vector2D offset,
+                float windX[], float windY[]) {
+    float invTexel = 1.0f / GUST_TEXEL_SIZE;
+    
+    for (int i = 0; i < count; i++) {
+        float gx = (xs[i] - offset.x) * invTexel;
+        float gy = (ys[i] - offset.y) * invTexel;
+        float floorX = floorf(gx);
+        float floorY = floorf(gy);
+        float fx = gx - floorX;
+        float fy = gy - floorY;
+        int x0 = (int)floorX & GUST_MASK;
+        int y0 = (int)floorY & GUST_MASK;
+        int x1 = (x0 + 1) & GUST_MASK;
+        int y1 = (y0 + 1) & GUST_MASK;
+    
+        const GustTexel& a = gusts.texels[y0 * GUST_TILE_SIZE + x0];
+        const GustTexel& b = gusts.texels[y0 * GUST_TILE_SIZE + x1];
+        const GustTexel& c = gusts.texels[y1 * GUST_TILE_SIZE + x0];
+        const GustTexel& d = gusts.texels[y1 * GUST_TILE_SIZE + x1];
+        float w00 = (1.0f - fx) * (1.0f - fy), w10 = fx * (1.0f - fy);
+        float w01 = (1.0f - fx) * fy, w11 = fx * fy;
+    
+        float gain = a.gain * w00 + b.gain * w10 + c.gain * w01 + d.gain * w11;
+        float cs = a.cosShift * w00 + b.cosShift * w10 + c.cosShift * w01 + d.cosShift * w11;
+        float sn = a.sinShift * w00 + b.sinShift * w10 + c.sinShift * w01 + d.sinShift * w11;
+    
+        float vx = windX[i], vy = windY[i];
+        windX[i] = gain * (vx * cs - vy * sn);
+        windY[i] = gain * (vx * sn + vy * cs);
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef GUSTS_H
+#define GUSTS_H
+
+#include "types.h"
+
+const int GUST_TILE_SIZE = 64;               // texels per side, power of two so wrapping is a mask
+const float GUST_TEXEL_SIZE = 20.0f;         // meters, so one tile covers 1.28 km before repeating
+const float GUST_SPEED_AMPLITUDE = 0.25f;    // +-25% of the local wind speed
+const float GUST_DIRECTION_AMPLITUDE = 8.0f * (float)M_PI / 180.0f;
+
+// Baked per texel so a query is four fetches and a blend, no noise evaluation or trig
+struct GustTexel {
+    float gain;
+    float cosShift, sinShift;
+};
+
+// Frozen-turbulence gust pattern: one tileable noise tile blown downwind with the mean breeze
+struct GustModel {
+    GustTexel texels[GUST_TILE_SIZE * GUST_TILE_SIZE];
+};
+
+void InitGustModel(GustModel& gusts, unsigned long long seed);
+void ApplyGusts(const GustModel& gusts, const float xs[], const float ys[], int count, Vector2D offset,
+                float windX[], float windY[]);
+
+#endif
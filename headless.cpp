@@ -0,0 +1,510 @@
+// sailsim_headless: the simulation without a window, for batch work on servers.
+//   g++ -O2 headless.cpp sweep.cpp distsweep.cpp montecarlo.cpp stats.cpp regress.cpp tracklog.cpp trackreader.cpp
+//       world.cpp course.cpp ai.cpp vmg.cpp polar.cpp windfield.cpp gusts.cpp windshadow.cpp coastline.cpp boat.cpp physics.cpp jobs.cpp -o sailsim_headless -lpthread
+//
+//   sailsim_headless sweep (--targets FILE | --track FILE) [options]
+//     --class dinghy|keelboat   base parameters for fields that aren't swept
+//     --density, --drag, --hull, --sail, --efficiency, --mass, --rudder  MIN:MAX:COUNT or VALUE
+//     --seeds N, --seed FIRST   scenario seeds per combination (track replay wind noise)
+//     --wind-noise F            wind speed jitter per track sample, fraction of recorded
+//     --threads N               0 = one per core
+//     --out FILE                columnar results, default sweep.col
+//     --listen ADDRESS          coordinate worker processes instead of running here
+//     --local-workers N         fork N workers on this machine, --threads each
+//
+//   sailsim_headless worker --connect ADDRESS [--threads N]
+//
+//   sailsim_headless regress [--golden DIR] [--record] [--only NAME] [--tolerance SCALE]
+//     steps the scripted scenarios and compares every tick with DIR/NAME.gold, by default the
+//     committed golden/ directory (run from the top of the tree). --record rewrites them, for a
+//     physics change that is meant to move the trajectories; commit the new files with it.
+//
+//   sailsim_headless log FILE [--from SECONDS] [--to SECONDS] [--print] [--threads N]
+//     summary of a session log (sailsim --log), or of a stretch of it; --print lists the records
+//
+//   sailsim_headless race [options]
+//     --fleet CLASS:N,...       e.g. dinghy:8,keelboat:4 (default dinghy:12)
+//     --wind SPEED:DIRECTION    mean breeze, m/s and degrees from (default 8:0)
+//     --speed-sd, --direction-sd, --shift-sd, --pressure-sd, --shift-interval, --no-gusts
+//     --beat METRES, --laps N   windward-leeward course from the start line (default 400, 2)
+//     --coast FILE              venue coastline
+//     --runs N, --seed S, --threads N, --dt SECONDS, --max-time SECONDS
+#include "types.h"
+#include "physics.h"
+#include "jobs.h"
+#include "sweep.h"
+#include "distsweep.h"
+#include "montecarlo.h"
+#include "regress.h"
+#include "trackreader.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+const float DEG_TO_RAD = (float)M_PI / 180.0f;
+
+static SpeedTarget targets[MAX_SPEED_TARGETS];
+static TrackSample track[MAX_TRACK_SAMPLES];
+
+static bool ParseAxis(const char* text, SweepAxis& axis) {
+    if (sscanf(text, "%f:%f:%d", &axis.min, &axis.max, &axis.count) == 3) return axis.count > 0;
+    axis.max = axis.min = (float)atof(text);
+    axis.count = 1;
+    return true;
+}
+
+static int SweepCommand(int argc, char** argv) {
+    SweepConfig config = {};
+    config.base = DINGHY_PARAMS;
+    config.seedCount = 1;
+    config.firstSeed = 1;
+    int threads = 0;
+    const char* outPath = "sweep.col";
+    const char* targetPath = nullptr;
+    const char* trackPath = nullptr;
+    const char* listenAddress = nullptr;
+    int localWorkers = 0;
+    
+    for (int i = 0; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            fprintf(stderr, "sweep: %s needs a value\n", arg);
+            return 2;
+        }
+        i++;
+    
+        bool known = true;
+        if (strcmp(arg, "--targets") == 0) targetPath = value;
+        else if (strcmp(arg, "--track") == 0) trackPath = value;
+        else if (strcmp(arg, "--out") == 0) outPath = value;
+        else if (strcmp(arg, "--threads") == 0) threads = atoi(value);
+        else if (strcmp(arg, "--listen") == 0) listenAddress = value;
+        else if (strcmp(arg, "--local-workers") == 0) localWorkers = atoi(value);
+        else if (strcmp(arg, "--seeds") == 0) config.seedCount = atoi(value);
+        else if (strcmp(arg, "--seed") == 0) config.firstSeed = strtoull(value, nullptr, 10);
+        else if (strcmp(arg, "--wind-noise") == 0) config.windNoise = (float)atof(value);
+        else if (strcmp(arg, "--class") == 0) config.base = strcmp(value, "keelboat") == 0 ? KEELBOAT_PARAMS : DINGHY_PARAMS;
+        else known = false;
+    
+        for (int p = 0; p < SWEEP_PARAM_COUNT && !known; p++) {
+            if (strncmp(arg, "--", 2) == 0 && strcmp(arg + 2, SWEEP_PARAM_NAMES[p]) == 0) {
+                if (!ParseAxis(value, config.axes[p])) {
+                    fprintf(stderr, "sweep: bad range '%s' for %s\n", value, arg);
+                    return 2;
+                }
+                known = true;
+            }
+        }
+        if (!known) {
+            fprintf(stderr, "sweep: unknown option %s\n", arg);
+            return 2;
+        }
+    }
+    
+    if (trackPath) {
+        config.trackCount = LoadTrack(trackPath, track, MAX_TRACK_SAMPLES);
+        config.track = track;
+        if (config.trackCount < 2) {
+            fprintf(stderr, "sweep: need at least two samples in %s\n", trackPath);
+            return 1;
+        }
+    } else if (targetPath) {
+        config.targetCount = LoadSpeedTargets(targetPath, targets, MAX_SPEED_TARGETS);
+        config.targets = targets;
+        if (config.targetCount < 1) {
+            fprintf(stderr, "sweep: no targets in %s\n", targetPath);
+            return 1;
+        }
+    } else {
+        fprintf(stderr, "sweep: give --targets or --track\n");
+        return 2;
+    }
+    
+    int runCount = GetSweepRunCount(config);
+    if (runCount < 0) {
+        fprintf(stderr, "sweep: the grid has more than %d runs\n", SWEEP_MAX_RUNS);
+        return 2;
+    }
+    
+    FILE* out = fopen(outPath, "wb");
+    if (!out) {
+        fprintf(stderr, "sweep: can't write %s\n", outPath);
+        return 1;
+    }
+    
+    SweepResult best;
+    bool ok;
+    if (listenAddress) {
+        printf("%d runs, coordinating on %s\n", runCount, listenAddress);
+        ok = RunSweepCoordinator(config, listenAddress, localWorkers, threads, out, best);
+    } else {
+        static JobPool pool;
+        InitJobPoolThreads(pool, threads);
+        printf("%d runs on %d threads\n", runCount, (int)pool.workers.size() + 1);
+        ok = RunSweep(config, pool, out, best);
+        ShutdownJobPool(pool);
+    }
+    fclose(out);
+    if (!ok) {
+        fprintf(stderr, "sweep: failed, %s is incomplete\n", outPath);
+        return 1;
+    }
+    
+    printf("best run %u (seed %u): rms %.4f, max %.4f\n", best.run, best.seed, best.rmsError, best.maxError);
+    BoatParams params = best.params;
+    const float values[SWEEP_PARAM_COUNT] = {params.waterDensity, params.dragCoefficient, params.hullArea,
+        params.sailArea, params.sailEfficiency, params.mass, params.rudderEffectiveness};
+    for (int p = 0; p < SWEEP_PARAM_COUNT; p++) printf("  %-10s %g\n", SWEEP_PARAM_NAMES[p], values[p]);
+    return 0;
+}
+
+static bool ParseFleet(const char* text, RaceSetup& setup) {
+    setup.boatCount = 0;
+    while (*text) {
+        char name[32];
+        int count, used;
+        if (sscanf(text, "%31[^:]:%d%n", name, &count, &used) != 2 || count < 0) return false;
+        int boatClass = strcmp(name, "keelboat") == 0 ? BOAT_CLASS_KEELBOAT : BOAT_CLASS_DINGHY;
+        for (int i = 0; i < count && setup.boatCount < MAX_RACE_FLEET; i++) setup.boatClass[setup.boatCount++] = boatClass;
+        text += used;
+        if (*text == ',') text++;
+    }
+    return setup.boatCount > 0;
+}
+
+// SPEED:DIRECTION, direction in degrees
+static void ParseWind(const char* text, Wind& wind) {
+    float direction = 0.0f;
+    sscanf(text, "%f:%f", &wind.speed, &direction);
+    wind.direction = direction * DEG_TO_RAD;
+}
+
+// Ends a, b so the line is crossed going `travel` with a to port
+static void LineAcross(float cx, float cy, float travel, float width, float& ax, float& ay, float& bx, float& by) {
+    float lx = cosf(travel) * width * 0.5f, ly = -sinf(travel) * width * 0.5f;
+    ax = cx - lx;
+    ay = cy - ly;
+    bx = cx + lx;
+    by = cy + ly;
+}
+
+// Windward mark, then a leeward gate at the start between laps, finishing downwind through the start line
+static void BuildWindwardLeeward(Course& course, float windward, float beat, int laps) {
+    float markX = sinf(windward) * beat, markY = cosf(windward) * beat;
+    float ax, ay, bx, by;
+    for (int lap = 0; lap < laps; lap++) {
+        AddCourseMark(course, markX, markY);
+        if (lap + 1 < laps) {
+            LineAcross(0.0f, 0.0f, windward + M_PI, 30.0f, ax, ay, bx, by);
+            AddCourseGate(course, ax, ay, bx, by);
+        }
+    }
+    LineAcross(0.0f, 0.0f, windward + M_PI, 200.0f, ax, ay, bx, by);
+    AddCourseFinish(course, ax, ay, bx, by);
+    BuildCourseGrid(course);
+}
+
+static int RaceCommand(int argc, char** argv) {
+    RaceSetup setup = {};
+    ParseFleet("dinghy:12", setup);
+    setup.startSpacing = 8.0f;
+    setup.dt = 0.05f;
+    setup.maxTime = 3600.0f;
+    setup.runs = 1000;
+    setup.seed = 1;
+    WindUncertainty& wind = setup.wind;
+    wind.mean = {8.0f, 0.0f};
+    wind.speedSpread = 1.0f;
+    wind.directionSpread = 5.0f * DEG_TO_RAD;
+    wind.shiftSpread = 4.0f * DEG_TO_RAD;
+    wind.pressureSpread = 0.05f;
+    wind.shiftInterval = 120.0f;
+    wind.gusts = true;
+    float beat = 400.0f;
+    int laps = 2;
+    int threads = 0;
+    const char* coastPath = nullptr;
+    bool fleetOk = true;
+    
+    for (int i = 0; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--no-gusts") == 0) {
+            wind.gusts = false;
+            continue;
+        }
+        const char* value = i + 1 < argc ? argv[++i] : nullptr;
+        if (!value) {
+            fprintf(stderr, "race: %s needs a value\n", arg);
+            return 2;
+        }
+    
+        if (strcmp(arg, "--fleet") == 0) fleetOk = ParseFleet(value, setup);
+        else if (strcmp(arg, "--wind") == 0) ParseWind(value, wind.mean);
+        else if (strcmp(arg, "--speed-sd") == 0) wind.speedSpread = (float)atof(value);
+        else if (strcmp(arg, "--direction-sd") == 0) wind.directionSpread = (float)atof(value) * DEG_TO_RAD;
+        else if (strcmp(arg, "--shift-sd") == 0) wind.shiftSpread = (float)atof(value) * DEG_TO_RAD;
+        else if (strcmp(arg, "--pressure-sd") == 0) wind.pressureSpread = (float)atof(value);
+        else if (strcmp(arg, "--shift-interval") == 0) wind.shiftInterval = (float)atof(value);
+        else if (strcmp(arg, "--beat") == 0) beat = (float)atof(value);
+        else if (strcmp(arg, "--laps") == 0) laps = atoi(value) > 0 ? atoi(value) : 1;
+        else if (strcmp(arg, "--coast") == 0) coastPath = value;
+        else if (strcmp(arg, "--runs") == 0) setup.runs = atoi(value);
+        else if (strcmp(arg, "--seed") == 0) setup.seed = strtoull(value, nullptr, 10);
+        else if (strcmp(arg, "--threads") == 0) threads = atoi(value);
+        else if (strcmp(arg, "--dt") == 0) setup.dt = (float)atof(value);
+        else if (strcmp(arg, "--max-time") == 0) setup.maxTime = (float)atof(value);
+        else {
+            fprintf(stderr, "race: unknown option %s\n", arg);
+            return 2;
+        }
+    }
+    
+    if (!fleetOk) {
+        fprintf(stderr, "race: bad --fleet, expected e.g. dinghy:8,keelboat:4\n");
+        return 2;
+    }
+    
+    static Coastline coast;
+    InitCoastline(coast);
+    if (coastPath) {
+        if (!LoadCoastline(coast, coastPath)) {
+            fprintf(stderr, "race: can't load %s\n", coastPath);
+            return 1;
+        }
+        setup.coast = &coast;
+    }
+    
+    static Course course;
+    InitCourse(course);
+    BuildWindwardLeeward(course, wind.mean.direction, beat, laps);
+    setup.course = &course;
+    // Start line just to leeward of the finish
+    setup.startX = -sinf(wind.mean.direction) * 20.0f;
+    setup.startY = -cosf(wind.mean.direction) * 20.0f;
+    
+    static JobPool pool;
+    InitJobPoolThreads(pool, threads);
+    printf("%d races of %d boats on %d threads\n", setup.runs, setup.boatCount, (int)pool.workers.size() + 1);
+    
+    static RaceEstimate estimate;
+    EstimateRace(setup, pool, estimate);
+    ShutdownJobPool(pool);
+    
+    printf("boat class     win%%  finish%%    mean      sd     p10     p50     p90\n");
+    for (int i = 0; i < setup.boatCount; i++) {
+        const BoatRaceStats& stats = estimate.boats[i];
+        printf("%4d %-8s %5.1f  %6.1f  %6.1f  %6.1f  %6.1f  %6.1f  %6.1f\n", i,
+               setup.boatClass[i] == BOAT_CLASS_KEELBOAT ? "keelboat" : "dinghy",
+               100.0 * stats.wins / estimate.runs, 100.0 * stats.finishes / estimate.runs,
+               stats.finishTime.mean, GetStandardDeviation(stats.finishTime),
+               GetQuantile(stats.finishP10), GetQuantile(stats.finishP50), GetQuantile(stats.finishP90));
+    }
+    printf("\nleg splits, mean (sd) seconds\n");
+    for (int i = 0; i < setup.boatCount; i++) {
+        printf("%4d", i);
+        for (int leg = 0; leg < estimate.legCount; leg++) {
+            const RunningStats& split = estimate.boats[i].split[leg];
+            printf("  %6.1f (%4.1f)", split.mean, GetStandardDeviation(split));
+        }
+        printf("\n");
+    }
+    FreeCourse(course);
+    return 0;
+}
+
+static int WorkerCommand(int argc, char** argv) {
+    const char* address = nullptr;
+    int threads = 0;
+    for (int i = 0; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--connect") == 0) address = argv[i + 1];
+        else if (strcmp(argv[i], "--threads") == 0) threads = atoi(argv[i + 1]);
+    }
+    if (!address) {
+        fprintf(stderr, "worker: give --connect ADDRESS\n");
+        return 2;
+    }
+    return RunSweepWorker(address, threads);
+}
+
+static int RegressCommand(int argc, char** argv) {
+    const char* goldenDir = "golden";
+    const char* only = nullptr;
+    bool record = false;
+    float toleranceScale = 1.0f;
+    for (int i = 0; i < argc; i++) {
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (strcmp(argv[i], "--record") == 0) record = true;
+        else if (strcmp(argv[i], "--golden") == 0 && value) goldenDir = argv[++i];
+        else if (strcmp(argv[i], "--only") == 0 && value) only = argv[++i];
+        else if (strcmp(argv[i], "--tolerance") == 0 && value) toleranceScale = (float)atof(argv[++i]);
+        else {
+            fprintf(stderr, "regress: bad option %s\n", argv[i]);
+            return 2;
+        }
+    }
+    int failures = 0, ran = 0;
+    Trajectory actual, golden;
+    for (int s = 0; s < REGRESSION_SCENARIO_COUNT; s++) {
+        const RegressionScenario& scenario = REGRESSION_SCENARIOS[s];
+        if (only && strcmp(only, scenario.name) != 0) continue;
+        ran++;
+    
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/%s.gold", goldenDir, scenario.name);
+        RunRegressionScenario(scenario, actual);
+    
+        if (record) {
+            if (!SaveTrajectory(path, actual)) {
+                fprintf(stderr, "regress: can't write %s\n", path);
+                return 1;
+            }
+            printf("%-16s recorded %d ticks\n", scenario.name, actual.tickCount);
+            continue;
+        }
+        if (!LoadTrajectory(path, golden)) {
+            printf("%-16s MISSING %s\n", scenario.name, path);
+            failures++;
+            continue;
+        }
+    
+        TrajectoryComparison comparison;
+        CompareTrajectories(golden, actual, toleranceScale, comparison);
+        if (!comparison.diverged) {
+            printf("%-16s ok  max error: position %.2g m, speed %.2g m/s, heading %.2g rad\n", scenario.name,
+                   fmaxf(comparison.maxError[TRAJECTORY_X], comparison.maxError[TRAJECTORY_Y]),
+                   fmaxf(comparison.maxError[TRAJECTORY_VX], comparison.maxError[TRAJECTORY_VY]),
+                   comparison.maxError[TRAJECTORY_HEADING]);
+            continue;
+        }
+    
+        failures++;
+        if (comparison.field < 0) {
+            printf("%-16s DIVERGED golden has %d ticks of %g s, this run %d of %g s\n", scenario.name,
+                   golden.tickCount, golden.dt, actual.tickCount, actual.dt);
+        } else {
+            int f = comparison.field;
+            printf("%-16s DIVERGED at tick %d (t=%.3f s): %s golden %.9g, now %.9g (tolerance %g)\n", scenario.name,
+                   comparison.tick, (comparison.tick + 1) * actual.dt, TRAJECTORY_FIELD_NAMES[f],
+                   comparison.expected, comparison.actual, TRAJECTORY_TOLERANCES[f] * toleranceScale);
+        }
+    }
+    
+    if (ran == 0) {
+        fprintf(stderr, "regress: no scenario named %s\n", only);
+        return 2;
+    }
+    if (!record) printf("%d of %d scenarios match\n", ran - failures, ran);
+    return failures > 0 ? 1 : 0;
+}
+
+// Per-chunk totals, folded in chunk order afterwards so the summary doesn't depend on threads
+struct LogChunkStats {
+    long long records;
+    float maxSpeed;
+    double vmgSum;
+    double distance;
+};
+
+struct LogScan {
+    double from, to;
+    std::vector<LogChunkStats> chunks;
+};
+
+static void ScanLogChunk(void* context, const TrackReader& reader, int chunk) {
+    LogScan& scan = *(LogScan*)context;
+    LogChunkStats stats = {};
+    TrackCursor cursor;
+    TrackRecord record;
+    bool moving = false;
+    float lastX = 0.0f, lastY = 0.0f;
+    OpenTrackChunk(reader, chunk, cursor);
+    while (NextTrackRecord(cursor, record)) {
+        if (record.time < scan.from || record.time > scan.to) continue;
+        stats.records++;
+        stats.maxSpeed = fmaxf(stats.maxSpeed, hypotf(record.vx, record.vy));
+        stats.vmgSum += record.vmg;
+        if (moving) stats.distance += hypotf(record.x - lastX, record.y - lastY);
+        lastX = record.x;
+        lastY = record.y;
+        moving = true;
+    }
+    scan.chunks[chunk] = stats;
+}
+
+static int LogCommand(int argc, char** argv) {
+    const char* path = nullptr;
+    double from = -INFINITY, to = INFINITY;
+    bool print = false;
+    int threads = 0;
+    for (int i = 0; i < argc; i++) {
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (strcmp(argv[i], "--print") == 0) print = true;
+        else if (strcmp(argv[i], "--from") == 0 && value) from = atof(argv[++i]);
+        else if (strcmp(argv[i], "--to") == 0 && value) to = atof(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && value) threads = atoi(argv[++i]);
+        else if (argv[i][0] != '-' && !path) path = argv[i];
+        else {
+            fprintf(stderr, "log: bad option %s\n", argv[i]);
+            return 2;
+        }
+    }
+    
+    static TrackReader reader;
+    if (!path || !OpenTrackReader(reader, path)) {
+        fprintf(stderr, "log: can't read %s\n", path ? path : "(no file given)");
+        return 1;
+    }
+    printf("%s: %lld records in %d chunks, %.1f to %.1f s%s\n", path, reader.recordCount, (int)reader.index.size(),
+           GetTrackStartTime(reader), GetTrackEndTime(reader), reader.indexed ? "" : " (no index, chunks walked)");
+    
+    if (print) {
+        for (int f = 0; f < TRACK_FIELD_COUNT; f++) printf("%s%s", f ? " " : "# ", TRACK_FIELD_NAMES[f]);
+        printf("\n");
+        TrackCursor cursor;
+        TrackRecord r;
+        if (SeekTrack(reader, from, to, cursor)) {
+            while (NextTrackRecord(cursor, r)) {
+                printf("%.4f %.3f %.3f %.3f %.3f %.4f %.4f %.4f %.3f %.3f %.4f %.3f %.4f %.4f %u\n", r.time, r.x, r.y,
+                       r.vx, r.vy, r.heading, r.heel, r.sailAngle, r.sailAngularVel, r.apparentWindSpeed,
+                       r.apparentWindAngle, r.vmg, r.rudder, r.sheet, r.flags);
+            }
+        }
+        CloseTrackReader(reader);
+        return 0;
+    }
+    
+    LogScan scan;
+    scan.from = from;
+    scan.to = to;
+    scan.chunks.assign(reader.index.size(), LogChunkStats{});
+    static JobPool pool;
+    InitJobPoolThreads(pool, threads);
+    ScanTrackChunks(reader, pool, from, to, ScanLogChunk, &scan);
+    ShutdownJobPool(pool);
+    
+    LogChunkStats total = {};
+    for (const LogChunkStats& stats : scan.chunks) {
+        total.records += stats.records;
+        total.maxSpeed = fmaxf(total.maxSpeed, stats.maxSpeed);
+        total.vmgSum += stats.vmgSum;
+        total.distance += stats.distance;   // the step across each chunk boundary is left out
+    }
+    printf("%lld records in range: max speed %.2f m/s, mean VMG %.2f m/s, %.0f m sailed\n", total.records,
+           total.maxSpeed, total.records > 0 ? total.vmgSum / total.records : 0.0, total.distance);
+    CloseTrackReader(reader);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && strcmp(argv[1], "sweep") == 0) return SweepCommand(argc - 2, argv + 2);
+    if (argc >= 2 && strcmp(argv[1], "worker") == 0) return WorkerCommand(argc - 2, argv + 2);
+    if (argc >= 2 && strcmp(argv[1], "race") == 0) return RaceCommand(argc - 2, argv + 2);
+    if (argc >= 2 && strcmp(argv[1], "regress") == 0) return RegressCommand(argc - 2, argv + 2);
+    if (argc >= 2 && strcmp(argv[1], "log") == 0) return LogCommand(argc - 2, argv + 2);
+    
+    fprintf(stderr, "usage: %s sweep|worker|race|regress|log [options]\n", argv[0]);
+    return 2;
+}
@@ -0,0 +1,57 @@
+#include "idle.h"
+#include <raylib.h>
+
+void InitIdlePolicy(IdlePolicy& policy) {
+    policy.simRate = 60.0f;
+    policy.activeFps = 60.0f;
+    policy.idleFps = 10.0f;
+    policy.backgroundFps = 15.0f;
+    policy.suspendedPollRate = 4.0f;
+    policy.idleDelay = 2.0f;
+}
+
+void InitIdleState(IdleState& state) {
+    state.mode = RENDER_ACTIVE;
+    state.stillTime = 0.0f;
+    state.lastRenderTime = 0.0;
+}
+
+RenderMode UpdateIdleState(IdleState& state, const IdlePolicy& policy, bool sceneChanging, float dt) {
+    state.stillTime = sceneChanging ? 0.0f : state.stillTime + dt;
+    
+    if (IsWindowHidden() || IsWindowMinimized()) {
+        state.mode = RENDER_SUSPENDED;
+    } else if (!IsWindowFocused()) {
+        state.mode = RENDER_BACKGROUND;
+    } else if (state.stillTime > policy.idleDelay) {
+        state.mode = RENDER_IDLE;
+    } else {
+        state.mode = RENDER_ACTIVE;
+    }
+    return state.mode;
+}
+
+static float GetModeFps(const IdleState& state, const IdlePolicy& policy) {
+    switch (state.mode) {
+        case RENDER_IDLE: return policy.idleFps;
+        case RENDER_BACKGROUND: return policy.backgroundFps;
+        case RENDER_SUSPENDED: return 0.0f;
+        default: return policy.activeFps;
+    }
+}
+
+bool ShouldRenderFrame(const IdleState& state, const IdlePolicy& policy, double now) {
+    float fps = GetModeFps(state, policy);
+    if (fps <= 0.0f) return false;
+    // Small slack so timer jitter doesn't push a frame to the next wakeup
+    return now - state.lastRenderTime >= 1.0 / fps - 0.001;
+}
+
+double GetNextWakeTime(const IdleState& state, const IdlePolicy& policy, double now) {
+    float fps = GetModeFps(state, policy);
+    if (fps <= 0.0f) return now + 1.0 / policy.suspendedPollRate;
+    
+    // The simulation catches up on its fixed tick after each wakeup, so there is
+    // no need to wake more often than frames are drawn
+    return state.lastRenderTime + 1.0 / fps;
+}
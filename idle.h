@@ -0,0 +1,32 @@
+#ifndef IDLE_H
+#define IDLE_H
+
+enum RenderMode {
+    RENDER_ACTIVE,       // something is moving or being steered
+    RENDER_IDLE,         // nothing has changed for a while
+    RENDER_BACKGROUND,   // window visible but unfocused
+    RENDER_SUSPENDED     // window hidden or minimized, no rendering at all
+};
+
+struct IdlePolicy {
+    float simRate;          // simulation ticks per second, independent of rendering
+    float activeFps;
+    float idleFps;
+    float backgroundFps;
+    float suspendedPollRate;  // wakeups per second to poll events and catch up the sim
+    float idleDelay;          // seconds without change before dropping to idleFps
+};
+
+struct IdleState {
+    RenderMode mode;
+    float stillTime;
+    double lastRenderTime;
+};
+
+void InitIdlePolicy(IdlePolicy& policy);
+void InitIdleState(IdleState& state);
+RenderMode UpdateIdleState(IdleState& state, const IdlePolicy& policy, bool sceneChanging, float dt);
+bool ShouldRenderFrame(const IdleState& state, const IdlePolicy& policy, double now);
+double GetNextWakeTime(const IdleState& state, const IdlePolicy& policy, double now);
+
+#endif
@@ -1,20 +1,126 @@
 #include "input.h"
 #include <raylib.h>
 #include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static const InputScript* activeScript = nullptr;
+static unsigned int scriptKeys = 0;
+static unsigned int scriptPressed = 0;
+
+static bool IsHeld(unsigned int key, int first, int second) {
+    if (activeScript) return (scriptKeys & key) != 0;
+    return IsKeyDown(first) || IsKeyDown(second);
+}
 
 void HandleInput(Boat& boat, float dt) {
-    if (IsKeyDown(KEY_LEFT) || IsKeyDown(KEY_A)) {
+    if (IsHeld(INPUT_RUDDER_LEFT, KEY_LEFT, KEY_A)) {
         boat.rudder = -1.0f;
-    } else if (IsKeyDown(KEY_RIGHT) || IsKeyDown(KEY_D)) {
+    } else if (IsHeld(INPUT_RUDDER_RIGHT, KEY_RIGHT, KEY_D)) {
         boat.rudder = 1.0f;
     } else {
         boat.rudder = 0.0f;
     }
     
-    if (IsKeyDown(KEY_W) || IsKeyDown(KEY_UP)) {
+    if (IsHeld(INPUT_SHEET_IN, KEY_W, KEY_UP)) {
         boat.sheet = fmaxf(0.0f, boat.sheet - 0.5f * dt);
     }
-    if (IsKeyDown(KEY_S) || IsKeyDown(KEY_DOWN)) {
+    if (IsHeld(INPUT_SHEET_OUT, KEY_S, KEY_DOWN)) {
         boat.sheet = fminf(1.0f, boat.sheet + 0.5f * dt);
     }
-}
\ No newline at end of file
+}
+
+bool HasControlInput() {
+    return IsHeld(INPUT_RUDDER_LEFT, KEY_LEFT, KEY_A) || IsHeld(INPUT_RUDDER_RIGHT, KEY_RIGHT, KEY_D) ||
+           IsHeld(INPUT_SHEET_IN, KEY_W, KEY_UP) || IsHeld(INPUT_SHEET_OUT, KEY_S, KEY_DOWN);
+}
+
+bool HasSteeringInput() {
+    return IsHeld(INPUT_RUDDER_LEFT, KEY_LEFT, KEY_A) || IsHeld(INPUT_RUDDER_RIGHT, KEY_RIGHT, KEY_D);
+}
+
+// Edge-triggered, so poll once per frame rather than per simulation step
+bool IsAutopilotKeyPressed() {
+    if (activeScript) return (scriptPressed & INPUT_AUTOPILOT) != 0;
+    return IsKeyPressed(KEY_P);
+}
+
+bool IsCourseHoldKeyPressed() {
+    if (activeScript) return (scriptPressed & INPUT_COURSE_HOLD) != 0;
+    return IsKeyPressed(KEY_H);
+}
+
+// Twenty seconds at 60 Hz: steer both ways, trim in and out, then a spell on each autopilot
+void InitDefaultInputScript(InputScript& script) {
+    static const InputEvent EVENTS[] = {
+        {0, 0},
+        {120, INPUT_RUDDER_LEFT}, {150, 0},
+        {300, INPUT_SHEET_IN}, {360, 0},
+        {420, INPUT_RUDDER_RIGHT}, {480, 0},
+        {600, INPUT_SHEET_OUT}, {660, 0},
+        {720, INPUT_AUTOPILOT}, {721, 0},
+        {900, INPUT_AUTOPILOT}, {901, 0},
+        {902, INPUT_COURSE_HOLD}, {903, 0},
+        {1080, INPUT_COURSE_HOLD}, {1081, 0},
+    };
+    script.eventCount = (int)(sizeof(EVENTS) / sizeof(EVENTS[0]));
+    memcpy(script.events, EVENTS, sizeof(EVENTS));
+    script.length = 1200;
+}
+
+// One event per line, "TICK key key ...", keys from left right in out autopilot hold; "TICK"
+// alone releases everything and "TICK repeat" ends the script. '#' starts a comment.
+bool LoadInputScript(InputScript& script, const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+    
+    static const char* const NAMES[] = {"left", "right", "in", "out", "autopilot", "hold"};
+    script.eventCount = 0;
+    script.length = 0;
+    char line[256];
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file)) {
+        char* comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+        char* word = strtok(line, " \t\r\n");
+        if (!word) continue;
+    
+        InputEvent event = {atoi(word), 0};
+        while ((word = strtok(nullptr, " \t\r\n"))) {
+            if (strcmp(word, "repeat") == 0) {
+                script.length = event.tick;
+                continue;
+            }
+            int k = 0;
+            while (k < 6 && strcmp(word, NAMES[k]) != 0) k++;
+            if (k == 6) ok = false;
+            else event.keys |= 1u << k;
+        }
+        if (script.length == 0) {
+            if (script.eventCount == MAX_INPUT_EVENTS) ok = false;
+            else script.events[script.eventCount++] = event;
+        }
+    }
+    fclose(file);
+    
+    if (script.length == 0 && script.eventCount > 0) script.length = script.events[script.eventCount - 1].tick + 1;
+    return ok && script.eventCount > 0;
+}
+
+void SetInputScript(const InputScript* script) {
+    activeScript = script;
+    scriptKeys = scriptPressed = 0;
+}
+
+void AdvanceInputScript(int tick) {
+    if (!activeScript || activeScript->length <= 0) return;
+    int t = tick % activeScript->length;
+    
+    unsigned int keys = 0;
+    for (int i = 0; i < activeScript->eventCount && activeScript->events[i].tick <= t; i++) {
+        keys = activeScript->events[i].keys;
+    }
+    scriptPressed = keys & ~scriptKeys;
+    scriptKeys = keys;
+}
@@ -3,6 +3,41 @@
 
 #include "types.h"
 
+// Controls a script can hold, as bits. The autopilot and course hold keys count as pressed
+// on the tick they go down.
+enum InputKey {
+    INPUT_RUDDER_LEFT = 1,
+    INPUT_RUDDER_RIGHT = 2,
+    INPUT_SHEET_IN = 4,
+    INPUT_SHEET_OUT = 8,
+    INPUT_AUTOPILOT = 16,
+    INPUT_COURSE_HOLD = 32
+};
+
+const int MAX_INPUT_EVENTS = 256;
+
+// Keys held from `tick` until the next event
+struct InputEvent {
+    int tick;
+    unsigned int keys;
+};
+
+struct InputScript {
+    int eventCount;
+    InputEvent events[MAX_INPUT_EVENTS];
+    int length;          // ticks before the script starts over
+};
+
 void HandleInput(Boat& boat, float dt);
+bool HasControlInput();
+bool HasSteeringInput();
+bool IsAutopilotKeyPressed();
+bool IsCourseHoldKeyPressed();
+
+// With a script set, the functions above read it instead of the keyboard
+void InitDefaultInputScript(InputScript& script);
+bool LoadInputScript(InputScript& script, const char* path);
+void SetInputScript(const InputScript* script);   // nullptr hands back to the keyboard
+void AdvanceInputScript(int tick);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,175 @@
+#include "jobs.h"
+
+static void FinishJob(JobPool& pool) {
+    if (pool.remaining.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        pool.done.notify_all();
+    }
+}
+
+static unsigned long long PackRange(unsigned int begin, unsigned int end) {
+    return begin | (unsigned long long)end << 32;
+}
+
+// Owner side: next index from the front of its own range
+static bool PopRange(std::atomic<unsigned long long>& range, int& index) {
+    unsigned long long packed = range.load();
+    while (true) {
+        unsigned int begin = (unsigned int)packed, end = (unsigned int)(packed >> 32);
+        if (begin >= end) return false;
+        if (range.compare_exchange_weak(packed, PackRange(begin + 1, end))) {
+            index = (int)begin;
+            return true;
+        }
+    }
+}
+
+// Thief side: the back half of the victim's range becomes the thief's own
+static bool StealRange(std::atomic<unsigned long long>& victim, std::atomic<unsigned long long>& own) {
+    unsigned long long packed = victim.load();
+    while (true) {
+        unsigned int begin = (unsigned int)packed, end = (unsigned int)(packed >> 32);
+        if (begin >= end) return false;
+        unsigned int middle = begin + (end - begin) / 2;
+        if (victim.compare_exchange_weak(packed, PackRange(begin, middle))) {
+            own.store(PackRange(middle, end));
+            return true;
+        }
+    }
+}
+
+static void RunPendingJobs(JobPool& pool, int self) {
+    if (pool.stealing) {
+        int participants = (int)pool.workers.size() + 1;
+        while (true) {
+            int index;
+            while (PopRange(pool.ranges[self], index)) {
+                pool.func(pool.context, index);
+                FinishJob(pool);
+            }
+            bool stole = false;
+            for (int i = 1; i < participants && !stole; i++) {
+                stole = StealRange(pool.ranges[(self + i) % participants], pool.ranges[self]);
+            }
+            if (!stole) return;
+        }
+    }
+    
+    while (true) {
+        int index = pool.nextJob.fetch_add(1);
+        if (index >= pool.jobCount) break;
+        
+        pool.func(pool.context, index);
+        FinishJob(pool);
+    }
+}
+
+static void WorkerLoop(JobPool* pool, int self) {
+    std::unique_lock<std::mutex> lock(pool->mutex);
+    int seenGeneration = pool->generation;
+    
+    while (true) {
+        pool->wake.wait(lock, [&] { return pool->quit || pool->generation != seenGeneration; });
+        if (pool->quit) return;
+        
+        seenGeneration = pool->generation;
+        pool->activeWorkers++;
+        lock.unlock();
+        
+        RunPendingJobs(*pool, self);
+        
+        lock.lock();
+        pool->activeWorkers--;
+        if (pool->activeWorkers == 0) pool->done.notify_all();
+    }
+}
+
+static void StartJobPool(JobPool& pool, int threadCount) {
+    if (threadCount > MAX_JOB_THREADS - 1) threadCount = MAX_JOB_THREADS - 1;
+    
+    pool.func = nullptr;
+    pool.context = nullptr;
+    pool.jobCount = 0;
+    pool.nextJob = 0;
+    pool.remaining = 0;
+    pool.activeWorkers = 0;
+    pool.generation = 0;
+    pool.quit = false;
+    pool.stealing = false;
+    
+    for (int i = 0; i < threadCount; i++) {
+        pool.workers.emplace_back(WorkerLoop, &pool, i);
+    }
+}
+
+void InitJobPool(JobPool& pool, int threadCount) {
+    if (threadCount <= 0) {
+        threadCount = (int)std::thread::hardware_concurrency() - 1;
+        if (threadCount < 1) threadCount = 1;
+    }
+    StartJobPool(pool, threadCount);
+}
+
+// For --threads style options, where the thread that submits the jobs is one of them
+void InitJobPoolThreads(JobPool& pool, int threads) {
+    if (threads <= 0) InitJobPool(pool, 0);
+    else StartJobPool(pool, threads - 1);
+}
+
+void ShutdownJobPool(JobPool& pool) {
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        pool.quit = true;
+    }
+    pool.wake.notify_all();
+    for (std::thread& worker : pool.workers) worker.join();
+    pool.workers.clear();
+}
+
+static void StartBatch(JobPool& pool, JobFunc func, void* context, int count, bool stealing) {
+    std::unique_lock<std::mutex> lock(pool.mutex);
+    
+    // A worker that woke late for the previous batch must leave it before the counters are reset
+    pool.done.wait(lock, [&] { return pool.activeWorkers == 0; });
+    
+    pool.stealing = stealing;
+    if (stealing) {
+        int participants = (int)pool.workers.size() + 1;
+        for (int i = 0; i < participants; i++) {
+            pool.ranges[i].store(PackRange((unsigned int)((long long)count * i / participants),
+                                           (unsigned int)((long long)count * (i + 1) / participants)));
+        }
+    }
+    pool.func = func;
+    pool.context = context;
+    pool.jobCount = count;
+    pool.nextJob = 0;
+    pool.remaining = count;
+    pool.generation++;
+    pool.wake.notify_all();
+}
+
+void SubmitJobs(JobPool& pool, JobFunc func, void* context, int count) {
+    StartBatch(pool, func, context, count, false);
+}
+
+// The submitting thread drains the last range
+void WaitJobs(JobPool& pool) {
+    RunPendingJobs(pool, (int)pool.workers.size());
+    
+    // Workers may still be finishing their last job or about to observe an exhausted batch
+    std::unique_lock<std::mutex> lock(pool.mutex);
+    pool.done.wait(lock, [&] { return pool.remaining == 0 && pool.activeWorkers == 0; });
+}
+
+void RunJobs(JobPool& pool, JobFunc func, void* context, int count) {
+    SubmitJobs(pool, func, context, count);
+    WaitJobs(pool);
+}
+
+// For batches of uneven, long jobs: each thread works through its own block and only touches
+// shared state when it runs out
+void RunJobsStealing(JobPool& pool, JobFunc func, void* context, int count) {
+    StartBatch(pool, func, context, count, true);
+    WaitJobs(pool);
+}
@@ -0,0 +1,45 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef void (*JobFunc)(void* context, int index);
+
+const int MAX_JOB_THREADS = 64;   // workers plus the submitting thread
+
+// Fixed set of worker threads running one parallel-for batch at a time.
+// The submitting thread helps drain the batch while it waits. Batches either hand out indices
+// from one shared counter, or (stealing) give each thread its own contiguous range and let
+// threads that run dry take half of someone else's.
+struct JobPool {
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    
+    JobFunc func;
+    void* context;
+    int jobCount;
+    std::atomic<int> nextJob;
+    std::atomic<int> remaining;
+    int activeWorkers;
+    int generation;
+    bool quit;
+    
+    bool stealing;
+    std::atomic<unsigned long long> ranges[MAX_JOB_THREADS];   // begin | end << 32, per thread
+};
+
+void InitJobPool(JobPool& pool, int threadCount);  // 0 = one per core, minus the caller
+void InitJobPoolThreads(JobPool& pool, int threads);   // counts the caller: 0 = one per core, 1 = no workers
+void ShutdownJobPool(JobPool& pool);
+void SubmitJobs(JobPool& pool, JobFunc func, void* context, int count);
+void WaitJobs(JobPool& pool);
+void RunJobs(JobPool& pool, JobFunc func, void* context, int count);
+void RunJobsStealing(JobPool& pool, JobFunc func, void* context, int count);
+
+#endif
@@ -0,0 +1,174 @@
+#include "landrendering.h"
+#include <raymath.h>
+#include <rlgl.h>
+#include <cmath>
+#include <cstdlib>
+
+// Land inside one SDF cell: the square clipped against the zero contour, corners
+// counter-clockwise. Up to eight points, fan-triangulated.
+static int ClipCell(const float corner[4][2], const float d[4], float out[8][2]) {
+    int count = 0;
+    for (int k = 0; k < 4; k++) {
+        int n = (k + 1) & 3;
+        if (d[k] < 0.0f) {
+            out[count][0] = corner[k][0];
+            out[count][1] = corner[k][1];
+            count++;
+        }
+        if ((d[k] < 0.0f) != (d[n] < 0.0f)) {
+            float t = d[k] / (d[k] - d[n]);
+            out[count][0] = corner[k][0] + (corner[n][0] - corner[k][0]) * t;
+            out[count][1] = corner[k][1] + (corner[n][1] - corner[k][1]) * t;
+            count++;
+        }
+    }
+    return count;
+}
+
+static void PushLandVertex(Mesh& mesh, float x, float y) {
+    int v = mesh.vertexCount++;
+    mesh.vertices[v * 3 + 0] = x;
+    mesh.vertices[v * 3 + 1] = LAND_HEIGHT;
+    mesh.vertices[v * 3 + 2] = -y;
+    mesh.normals[v * 3 + 0] = 0.0f;
+    mesh.normals[v * 3 + 1] = 1.0f;
+    mesh.normals[v * 3 + 2] = 0.0f;
+}
+
+static void PushLandPolygon(Mesh& mesh, const float points[][2], int count) {
+    for (int k = 1; k + 1 < count; k++) {
+        PushLandVertex(mesh, points[0][0], points[0][1]);
+        PushLandVertex(mesh, points[k][0], points[k][1]);
+        PushLandVertex(mesh, points[k + 1][0], points[k + 1][1]);
+    }
+}
+
+static void BuildChunkMesh(LandChunk& chunk, const Coastline& coast, int tx0, int ty0) {
+    // Worst case six triangles per cell
+    int maxVertices = LAND_CHUNK_TILES * LAND_CHUNK_TILES * COAST_TILE_SIZE * COAST_TILE_SIZE * 18;
+    Mesh mesh = {0};
+    mesh.vertices = (float*)MemAlloc(maxVertices * 3 * sizeof(float));
+    mesh.normals = (float*)MemAlloc(maxVertices * 3 * sizeof(float));
+    float tileSpan = COAST_TILE_SIZE * COAST_CELL_SIZE;
+    
+    for (int ty = ty0; ty < ty0 + LAND_CHUNK_TILES && ty < coast.tilesY; ty++) {
+        for (int tx = tx0; tx < tx0 + LAND_CHUNK_TILES && tx < coast.tilesX; tx++) {
+            int index = coast.tileIndex[ty * coast.tilesX + tx];
+            float x0 = coast.originX + tx * tileSpan;
+            float y0 = coast.originY + ty * tileSpan;
+            if (index == COAST_TILE_WATER) continue;
+            if (index == COAST_TILE_LAND) {
+                float quad[4][2] = {{x0, y0}, {x0 + tileSpan, y0}, {x0 + tileSpan, y0 + tileSpan}, {x0, y0 + tileSpan}};
+                PushLandPolygon(mesh, quad, 4);
+                continue;
+            }
+    
+            const float* samples = coast.tileSamples + (size_t)index * COAST_TILE_POINTS * COAST_TILE_POINTS;
+            for (int j = 0; j < COAST_TILE_SIZE; j++) {
+                for (int i = 0; i < COAST_TILE_SIZE; i++) {
+                    const float* s = samples + j * COAST_TILE_POINTS + i;
+                    float d[4] = {s[0], s[1], s[COAST_TILE_POINTS + 1], s[COAST_TILE_POINTS]};
+                    if (d[0] >= 0.0f && d[1] >= 0.0f && d[2] >= 0.0f && d[3] >= 0.0f) continue;
+    
+                    float cx = x0 + i * COAST_CELL_SIZE, cy = y0 + j * COAST_CELL_SIZE;
+                    float corner[4][2] = {{cx, cy}, {cx + COAST_CELL_SIZE, cy},
+                                          {cx + COAST_CELL_SIZE, cy + COAST_CELL_SIZE}, {cx, cy + COAST_CELL_SIZE}};
+                    float clipped[8][2];
+                    PushLandPolygon(mesh, clipped, ClipCell(corner, d, clipped));
+                }
+            }
+        }
+    }
+    
+    mesh.triangleCount = mesh.vertexCount / 3;
+    chunk.minX = coast.originX + tx0 * tileSpan;
+    chunk.minY = coast.originY + ty0 * tileSpan;
+    chunk.maxX = chunk.minX + LAND_CHUNK_TILES * tileSpan;
+    chunk.maxY = chunk.minY + LAND_CHUNK_TILES * tileSpan;
+    chunk.mesh = mesh;
+}
+
+// Land meshes come from the distance field, so they match exactly what boats collide with
+void InitLandRenderer(LandRenderer& renderer, const Coastline& coast) {
+    int chunksX = (coast.tilesX + LAND_CHUNK_TILES - 1) / LAND_CHUNK_TILES;
+    int chunksY = (coast.tilesY + LAND_CHUNK_TILES - 1) / LAND_CHUNK_TILES;
+    renderer.chunks = (LandChunk*)malloc((chunksX * chunksY > 0 ? chunksX * chunksY : 1) * sizeof(LandChunk));
+    renderer.chunkCount = 0;
+    renderer.visibleSegments = (int*)malloc(MAX_VISIBLE_SHORE_SEGMENTS * sizeof(int));
+    renderer.visibleChunkCount = 0;
+    renderer.visibleSegmentCount = 0;
+    
+    for (int cy = 0; cy < chunksY; cy++) {
+        for (int cx = 0; cx < chunksX; cx++) {
+            LandChunk chunk;
+            BuildChunkMesh(chunk, coast, cx * LAND_CHUNK_TILES, cy * LAND_CHUNK_TILES);
+            if (chunk.mesh.vertexCount == 0) {
+                MemFree(chunk.mesh.vertices);
+                MemFree(chunk.mesh.normals);
+                continue;
+            }
+            chunk.mesh.vertices = (float*)MemRealloc(chunk.mesh.vertices, chunk.mesh.vertexCount * 3 * sizeof(float));
+            chunk.mesh.normals = (float*)MemRealloc(chunk.mesh.normals, chunk.mesh.vertexCount * 3 * sizeof(float));
+            UploadMesh(&chunk.mesh, false);
+            renderer.chunks[renderer.chunkCount++] = chunk;
+        }
+    }
+    
+    renderer.material = LoadMaterialDefault();
+    renderer.material.maps[MATERIAL_MAP_DIFFUSE].color = (Color){194, 178, 128, 255};
+}
+
+void UnloadLandRenderer(LandRenderer& renderer) {
+    for (int i = 0; i < renderer.chunkCount; i++) UnloadMesh(renderer.chunks[i].mesh);
+    free(renderer.chunks);
+    free(renderer.visibleSegments);
+    UnloadMaterial(renderer.material);
+    renderer.chunks = nullptr;
+    renderer.chunkCount = 0;
+}
+
+// Bounds of the camera footprint on the water, in sim coordinates
+static void GetGroundViewRect(const Camera3D& camera, float& minX, float& minY, float& maxX, float& maxY) {
+    Vector2 corners[4] = {
+        {0.0f, 0.0f}, {(float)GetScreenWidth(), 0.0f},
+        {0.0f, (float)GetScreenHeight()}, {(float)GetScreenWidth(), (float)GetScreenHeight()}
+    };
+    minX = minY = INFINITY;
+    maxX = maxY = -INFINITY;
+    
+    for (int i = 0; i < 4; i++) {
+        Ray ray = GetScreenToWorldRay(corners[i], camera);
+        // Rays that never reach the water (looking at the horizon) are capped at a far distance
+        float t = ray.direction.y < -1e-4f ? -ray.position.y / ray.direction.y : 2000.0f;
+        float x = ray.position.x + ray.direction.x * t;
+        float y = -(ray.position.z + ray.direction.z * t);
+        minX = fminf(minX, x); maxX = fmaxf(maxX, x);
+        minY = fminf(minY, y); maxY = fmaxf(maxY, y);
+    }
+}
+
+void DrawLand3D(LandRenderer& renderer, const Coastline& coast, const CoastBVH& bvh, const Camera3D& camera) {
+    float minX, minY, maxX, maxY;
+    GetGroundViewRect(camera, minX, minY, maxX, maxY);
+    
+    renderer.visibleChunkCount = 0;
+    for (int i = 0; i < renderer.chunkCount; i++) {
+        const LandChunk& chunk = renderer.chunks[i];
+        if (chunk.maxX < minX || chunk.minX > maxX || chunk.maxY < minY || chunk.minY > maxY) continue;
+        DrawMesh(chunk.mesh, renderer.material, MatrixIdentity());
+        renderer.visibleChunkCount++;
+    }
+    
+    // Surf line from the exact polygons, only the segments the BVH says are on screen
+    int count = QueryCoastRect(bvh, minX, minY, maxX, maxY, renderer.visibleSegments, MAX_VISIBLE_SHORE_SEGMENTS);
+    renderer.visibleSegmentCount = count;
+    rlBegin(RL_LINES);
+    rlColor4ub(255, 255, 255, 200);
+    for (int i = 0; i < count; i++) {
+        Vector2D a, b;
+        GetCoastSegment(bvh, coast, renderer.visibleSegments[i], a, b);
+        rlVertex3f(a.x, LAND_HEIGHT + 0.1f, -a.y);
+        rlVertex3f(b.x, LAND_HEIGHT + 0.1f, -b.y);
+    }
+    rlEnd();
+}
@@ -0,0 +1,30 @@
+#ifndef LANDRENDERING_H
+#define LANDRENDERING_H
+
+#include "coastline.h"
+#include "coastbvh.h"
+#include <raylib.h>
+
+const int LAND_CHUNK_TILES = 4;             // SDF tiles per chunk side, one mesh and draw call per chunk
+const int MAX_VISIBLE_SHORE_SEGMENTS = 65536;
+const float LAND_HEIGHT = 0.3f;
+
+struct LandChunk {
+    Mesh mesh;
+    float minX, minY, maxX, maxY;
+};
+
+struct LandRenderer {
+    LandChunk* chunks;
+    int chunkCount;
+    Material material;
+    int* visibleSegments;                   // scratch for the BVH query each frame
+    int visibleChunkCount;                  // stats from the last draw
+    int visibleSegmentCount;
+};
+
+void InitLandRenderer(LandRenderer& renderer, const Coastline& coast);
+void UnloadLandRenderer(LandRenderer& renderer);
+void DrawLand3D(LandRenderer& renderer, const Coastline& coast, const CoastBVH& bvh, const Camera3D& camera);
+
+#endif
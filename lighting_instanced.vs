@@ -0,0 +1,17 @@
+#version 330
+
+in vec3 vertexPosition;
+in vec3 vertexNormal;
+in mat4 instanceTransform;
+
+uniform mat4 mvp;
+
+out vec3 fragNormal;
+out vec3 fragPos;
+
+void main()
+{
+    fragPos = vec3(instanceTransform * vec4(vertexPosition, 1.0));
+    fragNormal = mat3(instanceTransform) * vertexNormal;
+    gl_Position = mvp * instanceTransform * vec4(vertexPosition, 1.0);
+}
@@ -7,30 +7,169 @@
 #include "rendering.h"
 #include "wake.h"
 #include "wavechevrons.h"
+#include "fleetrendering.h"
+#include "renderprep.h"
+#include "jobs.h"
+#include "dynres.h"
+#include "telemetry.h"
+#include "idle.h"
+#include "world.h"
+#include "windfield.h"
+#include "gusts.h"
+#include "coastline.h"
+#include "coastbvh.h"
+#include "landrendering.h"
+#include "course.h"
+#include "ai.h"
+#include "polar.h"
+#include "routing.h"
+#include "vmg.h"
+#include "autopilot.h"
+#include "benchmark.h"
+#include "tracklog.h"
 #include <cmath>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 const int SCREEN_WIDTH = 1200;
 const int SCREEN_HEIGHT = 800;
+const int FLEET_SIZE = 24;
 
-int main() {
+const float WIND_SHIFT_PERIOD = 240.0f;   // seconds for a full left-right-left oscillation
+const float WIND_SHIFT_ANGLE = 10.0f * DEG2RAD;
+const int WIND_KEYFRAMES = 4;
+const float WIND_KEY_SPACING = WIND_SHIFT_PERIOD / WIND_KEYFRAMES;
+const float FORECAST_ERROR = 4.0f * DEG2RAD;   // how far a forecast update can move a keyframe
+const float ROUTE_REFRESH = 20.0f;        // seconds between replans from the player's position
+const int ROUTE_FRONTS_PER_TICK = 4;      // a long or hopeless plan is spread over several ticks
+
+static Wind GetForecastWind(const Wind& mean, int key) {
+    Wind keyWind = mean;
+    keyWind.direction = mean.direction - WIND_SHIFT_ANGLE * cosf(key * 2 * M_PI / WIND_KEYFRAMES);
+    return keyWind;
+}
+
+// Pressure bands across the course on top of the forecast breeze at each keyframe
+static Vector2D VenueWind(void* user, float x, float y, float time) {
+    const Wind* forecast = (const Wind*)user;
+    const Wind& mean = forecast[(int)(time / WIND_KEY_SPACING + 0.5f) % WIND_KEYFRAMES];
+    Wind local;
+    local.speed = mean.speed * (1.0f + 0.2f * sinf(x / 150.0f + y / 400.0f));
+    local.direction = mean.direction;
+    return GetWindVector(local);
+}
+
+// --benchmark N runs N frames of a fixed scene from a scripted helm and writes frame time
+// percentiles. Every frame draws and steps the simulation once, with no pacing and the
+// resolution pinned. Needs only a GL context, e.g. on a GPU-less box:
+//   xvfb-run -a env LIBGL_ALWAYS_SOFTWARE=1 ./sailsim --benchmark 3000
+// --benchmark-warmup N, --benchmark-out FILE (benchmark.json), --input-script FILE (see input.cpp)
+// --log FILE records the player's boat every simulation tick, see tracklog.h
+int main(int argc, char** argv) {
+    IdlePolicy idlePolicy;
+    InitIdlePolicy(idlePolicy);
+    int benchmarkFrames = 0;
+    int benchmarkWarmup = 120;
+    const char* benchmarkPath = "benchmark.json";
+    const char* scriptPath = nullptr;
+    const char* logPath = nullptr;
+    for (int i = 1; i < argc - 1; i++) {
+        if (strcmp(argv[i], "--sim-rate") == 0) idlePolicy.simRate = fmaxf((float)atof(argv[++i]), 1.0f);
+        else if (strcmp(argv[i], "--benchmark") == 0) benchmarkFrames = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--benchmark-warmup") == 0) benchmarkWarmup = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--benchmark-out") == 0) benchmarkPath = argv[++i];
+        else if (strcmp(argv[i], "--input-script") == 0) scriptPath = argv[++i];
+        else if (strcmp(argv[i], "--log") == 0) logPath = argv[++i];
+    }
+    bool benchmarking = benchmarkFrames > 0;
+    
+    static InputScript inputScript;
+    static FrameBenchmark benchmark;
+    if (benchmarking) {
+        if (scriptPath && !LoadInputScript(inputScript, scriptPath)) {
+            fprintf(stderr, "can't read input script %s\n", scriptPath);
+            return 1;
+        }
+        if (!scriptPath) InitDefaultInputScript(inputScript);
+        SetInputScript(&inputScript);
+        InitFrameBenchmark(benchmark, benchmarkFrames, benchmarkWarmup);
+    }
+    
+    static TrackLog trackLog;
+    if (logPath && !OpenTrackLog(trackLog, logPath)) {
+        fprintf(stderr, "can't write log %s\n", logPath);
+        return 1;
+    }
+    
+    // Keep ticking while minimized; frame pacing is done by the idle policy, not SetTargetFPS
+    SetConfigFlags(FLAG_WINDOW_ALWAYS_RUN);
     InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Sailing Simulator");
-    SetTargetFPS(60);
+    if (benchmarking) SetRandomSeed(1);   // after InitWindow, which seeds from the clock
     
     Model boatModel = LoadModel("sailboat.glb");
-
-    Shader lightShader = LoadShader("lighting.vs", "lighting.fs");
-    boatModel.materials[0].shader = lightShader;
-
-    Mesh sailMesh = GenMeshCube(0.2f, 3.0f, 4.0f);
-    Model sailModel = LoadModelFromMesh(sailMesh);
-    sailModel.materials[0].shader = lightShader;
+    Shader instanceShader = LoadShader("lighting_instanced.vs", "lighting.fs");
+    
+    static FleetRenderer fleetRenderer;
+    InitFleetRenderer(fleetRenderer, boatModel, instanceShader);
+    
+    static JobPool jobPool;
+    InitJobPool(jobPool, 0);
+    
+    static RenderPrep renderPrep;
+    InitRenderPrep(renderPrep, jobPool);
+    
+    DynamicResolution dynres;
+    InitDynamicResolution(dynres, SCREEN_WIDTH, SCREEN_HEIGHT, 1.0f / 60.0f);
     
-    Boat boat;
-    InitBoat(boat);
+    static Telemetry telemetry;
+    InitTelemetry(telemetry, SCREEN_WIDTH);
+    float updateMs = 0.0f;
+    float drawMs = 0.0f;
+    
+    IdleState idleState;
+    InitIdleState(idleState);
+    RenderMode lastRenderedMode = RENDER_SUSPENDED;
+    const float simDt = 1.0f / idlePolicy.simRate;
+    double simAccumulator = 0.0;
+    double lastLoopTime = GetTime();
+    
+    static World world;
+    InitWorld(world);
+    Boat playerBoat;
+    InitBoat(playerBoat);
+    AddBoat(world, playerBoat);
+    // Rest of the fleet on a line astern of the player
+    SpawnStartLine(world, FLEET_SIZE - 1, 0.0f, -20.0f, M_PI / 2, 8.0f, M_PI / 4);
+    Boat& boat = world.boats[0];
+    
+    // Land is optional: without a venue file the race area is open water
+    static Coastline coastline;
+    InitCoastline(coastline);
+    if (LoadCoastline(coastline, "islands.coast")) world.coast = &coastline;
+    static CoastBVH coastBVH;
+    BuildCoastBVH(coastBVH, coastline);
+    static LandRenderer landRenderer;
+    InitLandRenderer(landRenderer, coastline);
     
     Wind wind = {15.0f, 0.0f};
-    float windTimer = 0.0f;
+    float simTime = 0.0f;
+    
+    static WindField windField;
+    InitWindField(windField, wind, 25.0f);
+    windField.period = WIND_SHIFT_PERIOD;
+    static Wind forecast[WIND_KEYFRAMES];
+    for (int k = 0; k < WIND_KEYFRAMES; k++) {
+        forecast[k] = GetForecastWind(wind, k);
+        SetWindFieldKeyframe(windField, k, k * WIND_KEY_SPACING, forecast[k]);
+    }
+    SetWindFieldGenerator(windField, VenueWind, forecast);
+    float forecastAge = 0.0f;
+    
+    // Gust pattern is baked once; it just slides downwind during the race
+    static GustModel gusts;
+    InitGustModel(gusts, benchmarking ? 1ull : (unsigned long long)GetRandomValue(0, 0x7fffffff));
+    SetWindFieldGusts(windField, &gusts);
     
     Camera3D camera = {0};
     camera.position = (Vector3){50.0f, 80.0f, 50.0f};
@@ -39,11 +178,42 @@ int main() {
     camera.fovy = 45.0f;
     camera.projection = CAMERA_ORTHOGRAPHIC;
     
-    Waypoint waypoint = {0, 0, false};
-    float randomAngle = (float)GetRandomValue(0, 360) * DEG2RAD;
-    waypoint.x = sinf(randomAngle) * 100.0f;
-    waypoint.y = cosf(randomAngle) * 100.0f;
-    waypoint.active = true;
+    // Windward-leeward: up to the windward mark, down through the leeward gate, finish on the start line
+    static Course course;
+    InitCourse(course);
+    AddCourseMark(course, 0.0f, 250.0f);
+    AddCourseGate(course, 15.0f, -150.0f, -15.0f, -150.0f);
+    AddCourseFinish(course, -100.0f, -20.0f, 100.0f, -20.0f);
+    BuildCourseGrid(course);
+    SetWorldCourse(world, &course);
+    Waypoint waypoint = GetCourseWaypoint(course, world.progress[0]);
+    
+    // Best upwind and downwind angles, shared by the HUD and the computer skippers. Solved up front,
+    // since a bin solved on first use stalls the frame a gust carries the wind into it.
+    static VMGCache vmgTargets;
+    InitVMGCache(vmgTargets, 0.0f, 1.0f);
+    FillVMGCache(vmgTargets, jobPool);
+    
+    // Everyone but the player is sailed by the computer
+    static SkipperFleet skippers;
+    InitSkipperFleet(skippers, vmgTargets);
+    for (int i = 1; i < world.boatCount; i++) AddSkipper(skippers, i);
+    
+    // Fastest route to the next mark for the player, through the wind field and around the land
+    static Polar polar;
+    BuildPolar(polar);
+    static Router router;
+    InitRouter(router, polar, &jobPool);
+    router.coast = world.coast;
+    static Vector2D routePath[ROUTE_MAX_STEPS + 2];
+    int routeCount = 0;
+    int routeLeg = -1;
+    float routeAge = 0.0f;
+    bool routePlanning = false;
+    
+    // P sails the player to the next mark, H holds the current course; either key again, or the rudder, hands back
+    static Autopilot autopilot;
+    InitAutopilot(autopilot, polar, &jobPool);
 
     WakePoint wake[WAKE_LENGTH] = {0};
     int wakeCount = 0;
@@ -58,53 +228,200 @@ int main() {
     }
     
     while (!WindowShouldClose()) {
-        float dt = GetFrameTime();
-        
-        // Wind oscillation
-        //windTimer += dt;
-        //wind.direction = sinf(windTimer / 120.0f * 2 * M_PI) * M_PI/4;
+        double loopStart = GetTime();
+        double routeTime = 0.0;
+        double elapsed = loopStart - lastLoopTime;
+        lastLoopTime = loopStart;
         
-        // Update
-        HandleInput(boat, dt);
-        UpdateBoat(boat, wind, dt);
-        UpdateWindParticles(particles, boat, wind, dt);
-        UpdateWake(wake, wakeCount, boat, dt);
-        UpdateWaveChevrons(chevrons, boat, dt);
+        // Don't try to replay more than a second after a stall
+        simAccumulator = fmin(simAccumulator + elapsed, 1.0);
+        if (benchmarking) {
+            // Same work every frame, whatever the wall clock did
+            simAccumulator = simDt;
+            AdvanceInputScript(benchmark.frame);
+        }
+        bool controlInput = HasControlInput();
         
-        camera.target = (Vector3){boat.x, 0.0f, -boat.y};
-        camera.position = (Vector3){boat.x + 50.0f, 80.0f, -boat.y + 50.0f};
+        AutopilotMode requested = IsAutopilotKeyPressed() ? AUTOPILOT_VMG :
+                                  IsCourseHoldKeyPressed() ? AUTOPILOT_COURSE : AUTOPILOT_OFF;
+        if (requested != AUTOPILOT_OFF) {
+            EngageAutopilot(autopilot, boat, requested == autopilot.mode ? AUTOPILOT_OFF : requested);
+        } else if (autopilot.mode != AUTOPILOT_OFF && HasSteeringInput()) {
+            EngageAutopilot(autopilot, boat, AUTOPILOT_OFF);   // taking the helm hands back
+        }
         
-        // Check waypoint
-        if (waypoint.active) {
-            float dist = sqrtf(powf(boat.x - waypoint.x, 2) + powf(boat.y - waypoint.y, 2));
-            if (dist < 10.0f) {
-                randomAngle = (float)GetRandomValue(0, 360) * DEG2RAD;
-                waypoint.x = boat.x + sinf(randomAngle) * 100.0f;
-                waypoint.y = boat.y + cosf(randomAngle) * 100.0f;
+        // Update at the fixed simulation rate, whether or not this wakeup draws
+        while (simAccumulator >= simDt) {
+            float dt = simDt;
+            
+            HandleInput(boat, dt);
+            UpdateAutopilot(autopilot, boat, GetBoatWind(world, 0), waypoint, dt);
+            UpdateSkippers(skippers, world, dt);
+            UpdateWorld(world, windField, simTime, dt);
+            UpdateWindParticles(particles, boat, windField, simTime, dt);
+            UpdateWake(wake, wakeCount, boat, dt);
+            UpdateWaveChevrons(chevrons, boat, dt);
+            
+            // Marks are checked inside UpdateWorld; after finishing, practice goes round again
+            if (world.progress[0].nextLeg >= course.legCount) ResetCourseProgress(world.progress[0], boat);
+            waypoint = GetCourseWaypoint(course, world.progress[0]);
+            
+            // Each keyframe the forecast for the one after next is revised, so the wind changes
+            // from the next keyframe on and the route only recomputes its fronts after that
+            forecastAge += dt;
+            if (forecastAge >= WIND_KEY_SPACING) {
+                forecastAge = 0.0f;
+                int nextKey = (int)floorf(simTime / WIND_KEY_SPACING) + 1;
+                int revised = (nextKey + 1) % WIND_KEYFRAMES;
+                forecast[revised] = GetForecastWind(wind, revised);
+                forecast[revised].direction += FORECAST_ERROR * GetRandomValue(-100, 100) / 100.0f;
+                AnchorWindFieldGusts(windField, simTime);
+                SetWindFieldKeyframe(windField, revised, revised * WIND_KEY_SPACING, forecast[revised]);
+                double routeStart = GetTime();
+                if (routeLeg >= 0 && RewindRoute(router, &windField, wind, nextKey * WIND_KEY_SPACING)) {
+                    routePlanning = true;
+                }
+                routeTime += GetTime() - routeStart;
+            }
+            
+            // Route planning is timed on its own so it doesn't show up as simulation cost
+            double routeStart = GetTime();
+            routeAge += dt;
+            if (world.progress[0].nextLeg != routeLeg || routeAge >= ROUTE_REFRESH) {
+                routeLeg = world.progress[0].nextLeg;
+                routeAge = 0.0f;
+                StartRoute(router, boat.x, boat.y, waypoint, simTime, &windField, wind);
+                routePlanning = true;
+            }
+            if (routePlanning) {
+                RouteStatus status = StepRoute(router, ROUTE_FRONTS_PER_TICK);
+                if (status != ROUTE_PLANNING) {
+                    routePlanning = false;
+                    routeCount = status == ROUTE_ARRIVED ? GetRoutePath(router, routePath, ROUTE_MAX_STEPS + 2) : 0;
+                }
+            }
+            routeTime += GetTime() - routeStart;
+            
+            SampleTelemetry(telemetry, boat, GetBoatWind(world, 0), waypoint, updateMs, drawMs, dt);
+            simTime += dt;
+            
+            if (logPath) {
+                unsigned int flags = (autopilot.mode == AUTOPILOT_VMG ? TRACK_FLAG_AUTOPILOT : 0) |
+                                     (autopilot.mode == AUTOPILOT_COURSE ? TRACK_FLAG_COURSE_HOLD : 0) |
+                                     (controlInput ? TRACK_FLAG_CONTROL_INPUT : 0);
+                TrackRecord record;
+                FillTrackRecord(record, boat, GetBoatWind(world, 0), waypoint, simTime, flags);
+                LogTrackRecord(trackLog, record);
             }
+            simAccumulator -= simDt;
         }
         
-        Vector2D apparentWind = GetApparentWind(wind, boat.vx, boat.vy);
+        double updateEnd = GetTime();
+        float routeMs = (float)routeTime * 1000.0f;
+        updateMs = (float)(updateEnd - loopStart) * 1000.0f - routeMs;
         
-        // Render
-        BeginDrawing();
-        ClearBackground((Color){135, 206, 235, 255});
+        float speed = sqrtf(boat.vx*boat.vx + boat.vy*boat.vy);
+        bool sceneChanging = controlInput || speed > 0.05f || fabsf(boat.sailAngularVel) > 0.01f;
+        RenderMode renderMode = UpdateIdleState(idleState, idlePolicy, sceneChanging, (float)elapsed);
         
-        BeginMode3D(camera);
-            Vector3 lightDir = {-0.5f, -1.0f, -0.3f};
-            DrawWater(boat);
-            DrawWindParticles3D(particles);
-            DrawBoat3D(boat, boatModel, sailModel);
-            DrawWaypoint3D(waypoint, boat);
-            DrawWake3D(wake, wakeCount);
-            DrawWaveChevrons3D(chevrons);
-        EndMode3D();
-        
-        DrawDebugInfo(boat, wind, waypoint, SCREEN_HEIGHT);
+        if (benchmarking || ShouldRenderFrame(idleState, idlePolicy, updateEnd)) {
+            float frameTime = (float)(updateEnd - idleState.lastRenderTime);
+            idleState.lastRenderTime = updateEnd;
+            
+            // Throttled frames are slow on purpose; only back-to-back active frames say anything about load
+            if (!benchmarking && renderMode == RENDER_ACTIVE && lastRenderedMode == RENDER_ACTIVE) {
+                UpdateDynamicResolution(dynres, frameTime);
+            }
+            lastRenderedMode = renderMode;
+            
+            camera.target = (Vector3){boat.x, 0.0f, -boat.y};
+            camera.position = (Vector3){boat.x + 50.0f, 80.0f, -boat.y + 50.0f};
+            Wind boatWind = GetBoatWind(world, 0);
+            UpdateTelemetryText(telemetry, boat, boatWind, waypoint);
+            UpdateAutopilotText(telemetry, autopilot.mode != AUTOPILOT_OFF,
+                                autopilot.mode == AUTOPILOT_VMG && waypoint.active, autopilot.course);
+            if (waypoint.active) {
+                float markBearing = atan2f(waypoint.x - boat.x, waypoint.y - boat.y);
+                bool upwind = fabsf(NormalizeAngle(markBearing - boatWind.direction)) < M_PI / 2;
+                const VMGTarget& target = upwind ? GetUpwindTarget(vmgTargets, boatWind.speed)
+                                                 : GetDownwindTarget(vmgTargets, boatWind.speed);
+                UpdateTargetText(telemetry, target, upwind, NormalizeAngle(boat.heading + M_PI - boatWind.direction));
+            }
+            if (world.coast) {
+                const float LOOKAHEAD = 500.0f;
+                float aheadDistance = LOOKAHEAD;
+                Vector2D closest;
+                // Boats make way towards heading + pi (see the HUD heading)
+                bool landAhead = RaycastCoast(coastBVH, coastline, Vector2D(boat.x, boat.y),
+                                              Vector2D(-sinf(boat.heading), -cosf(boat.heading)), LOOKAHEAD, aheadDistance);
+                UpdateShoreText(telemetry, landAhead, aheadDistance, FindNearestShore(coastBVH, coastline, boat.x, boat.y, closest));
+            }
+            
+            // Effect geometry is built on the job pool while the GL thread draws the scene
+            int sceneHeight = GetSceneRenderHeight(dynres);
+            BeginRenderPrep(renderPrep, particles, wake, wakeCount, chevrons, telemetry, sceneHeight / camera.fovy);
+            
+            // Render the 3D scene at the adaptive internal resolution
+            BeginSceneRender(dynres);
+            ClearBackground((Color){135, 206, 235, 255});
+            
+            BeginMode3D(camera);
+                Vector3 lightDir = {-0.5f, -1.0f, -0.3f};
+                DrawWater(boat);
+                DrawLand3D(landRenderer, coastline, coastBVH, camera);
+                DrawFleet3D(fleetRenderer, world.boats, world.boatCount, camera, sceneHeight);
+                DrawCourse3D(course, world.progress[0].nextLeg);
+                DrawRoute3D(routePath, routeCount);
+                DrawWaypoint3D(waypoint, boat);
+                DrawRenderPrep3D(renderPrep);
+            EndMode3D();
+            EndSceneRender(dynres);
+            
+            // Upscale to the window, HUD at native resolution
+            BeginDrawing();
+            DrawSceneUpscaled(dynres);
+            DrawRenderPrepHUD(renderPrep);
+            DrawDebugInfo(telemetry, SCREEN_HEIGHT);
+            drawMs = (float)(GetTime() - updateEnd) * 1000.0f;
+            
+            EndDrawing();
+            
+            // The draw phase runs to the end of the swap, where a software rasterizer does its work
+            if (benchmarking) {
+                double frameEnd = GetTime();
+                if (!RecordBenchmarkFrame(benchmark, updateMs, routeMs, (float)(frameEnd - updateEnd) * 1000.0f,
+                                          (float)(frameEnd - loopStart) * 1000.0f)) break;
+                continue;
+            }
+        } else {
+            // EndDrawing normally polls; without a frame we still need window and key events
+            PollInputEvents();
+        }
         
-        EndDrawing();
+        double now = GetTime();
+        double wakeTime = GetNextWakeTime(idleState, idlePolicy, now);
+        if (wakeTime > now) WaitTime(wakeTime - now);
+    }
+    
+    if (benchmarking) {
+        BenchmarkScene scene = {SCREEN_WIDTH, SCREEN_HEIGHT, world.boatCount, MAX_PARTICLES, MAX_WAVE_CHEVRONS, WAKE_LENGTH};
+        if (!WriteBenchmarkSummary(benchmark, scene, benchmarkPath)) fprintf(stderr, "can't write %s\n", benchmarkPath);
+    }
+    
+    if (logPath) {
+        if (!CloseTrackLog(trackLog)) fprintf(stderr, "log %s is incomplete\n", logPath);
+        if (trackLog.dropped > 0) fprintf(stderr, "log: %llu records dropped, the writer fell behind\n", trackLog.dropped);
     }
     
+    FreeCourse(course);
+    UnloadLandRenderer(landRenderer);
+    FreeCoastBVH(coastBVH);
+    FreeCoastline(coastline);
+    FreeWindField(windField);
+    UnloadDynamicResolution(dynres);
+    UnloadRenderPrep(renderPrep);
+    ShutdownJobPool(jobPool);
+    UnloadFleetRenderer(fleetRenderer);
     UnloadModel(boatModel);
     CloseWindow();
     return 0;
@@ -0,0 +1,189 @@
+#include "montecarlo.h"
+#include "world.h"
+#include "windfield.h"
+#include "gusts.h"
+#include "ai.h"
+#include "boat.h"
+#include "physics.h"
+#include "rng.h"
+#include <cmath>
+#include <vector>
+
+// Everything one race touches, allocated per job so races share only read-only inputs
+struct RaceScratch {
+    World world;
+    SkipperFleet skippers;
+    WindField field;
+    GustModel gusts;
+};
+
+static void DrawRaceWind(const WindUncertainty& uncertainty, Rng& rng, RaceScratch& scratch) {
+    Wind key;
+    key.speed = fmaxf(uncertainty.mean.speed + uncertainty.speedSpread * RandomGaussian(rng), 0.5f);
+    key.direction = uncertainty.mean.direction + uncertainty.directionSpread * RandomGaussian(rng);
+    InitWindField(scratch.field, key, RACE_WIND_CELL);
+    
+    if (uncertainty.shiftInterval > 0.0f) {
+        for (int k = 1; k < MAX_WIND_KEYFRAMES; k++) {
+            key.direction += uncertainty.shiftSpread * RandomGaussian(rng);
+            key.speed = fmaxf(key.speed * (1.0f + uncertainty.pressureSpread * RandomGaussian(rng)), 0.5f);
+            SetWindFieldKeyframe(scratch.field, k, k * uncertainty.shiftInterval, key);
+        }
+    }
+    if (uncertainty.gusts) {
+        InitGustModel(scratch.gusts, NextRandom(rng));
+        SetWindFieldGusts(scratch.field, &scratch.gusts);
+    }
+}
+
+// Boats abreast on the line in a random order, starboard tack close-hauled to the mean wind
+static void PlaceFleet(const RaceSetup& setup, Rng& rng, World& world) {
+    int slot[MAX_RACE_FLEET];
+    for (int i = 0; i < setup.boatCount; i++) slot[i] = i;
+    for (int i = setup.boatCount - 1; i > 0; i--) {
+        int j = (int)(NextRandom(rng) % (unsigned long long)(i + 1));
+        int swap = slot[i];
+        slot[i] = slot[j];
+        slot[j] = swap;
+    }
+    
+    float windward = setup.wind.mean.direction;
+    float travel = windward + 45.0f * (float)M_PI / 180.0f;
+    for (int i = 0; i < setup.boatCount; i++) {
+        float offset = (slot[i] - (setup.boatCount - 1) * 0.5f) * setup.startSpacing;
+        Boat boat;
+        InitBoat(boat);
+        boat.x = setup.startX + cosf(windward) * offset;
+        boat.y = setup.startY - sinf(windward) * offset;
+        boat.heading = NormalizeAngle(travel + M_PI);
+        boat.boatClass = setup.boatClass[i];
+        AddBoat(world, boat);
+    }
+}
+
+void SimulateRace(const RaceSetup& setup, VMGCache& targets, int run, RaceOutcome& outcome) {
+    RaceScratch* scratch = new RaceScratch;
+    World& world = scratch->world;
+    int legCount = setup.course->legCount < MAX_RACE_LEGS ? setup.course->legCount : MAX_RACE_LEGS;
+    
+    Rng rng;
+    SeedRngStream(rng, setup.seed, (unsigned long long)run);
+    DrawRaceWind(setup.wind, rng, *scratch);
+    
+    InitWorld(world);
+    world.coast = setup.coast;
+    PlaceFleet(setup, rng, world);
+    SetWorldCourse(world, setup.course);
+    InitSkipperFleet(scratch->skippers, targets);
+    for (int i = 0; i < world.boatCount; i++) AddSkipper(scratch->skippers, i);
+    
+    int legsDone[MAX_RACE_FLEET];
+    for (int i = 0; i < setup.boatCount; i++) {
+        legsDone[i] = 0;
+        outcome.finishTime[i] = -1.0f;
+        for (int leg = 0; leg < MAX_RACE_LEGS; leg++) outcome.legTime[i][leg] = -1.0f;
+    }
+    
+    float time = 0.0f;
+    int finished = 0;
+    while (time < setup.maxTime && finished < setup.boatCount) {
+        UpdateSkippers(scratch->skippers, world, setup.dt);
+        UpdateWorld(world, scratch->field, time, setup.dt);
+        time += setup.dt;
+    
+        // Roundings are known to the tick, the finish to within it
+        for (int i = 0; i < setup.boatCount; i++) {
+            const CourseProgress& progress = world.progress[i];
+            while (legsDone[i] < progress.nextLeg && legsDone[i] < legCount) {
+                outcome.legTime[i][legsDone[i]++] = time;
+            }
+            if (outcome.finishTime[i] < 0.0f && progress.nextLeg >= setup.course->legCount) {
+                outcome.finishTime[i] = progress.finishTime;
+                if (legCount == setup.course->legCount) outcome.legTime[i][legCount - 1] = progress.finishTime;
+                finished++;
+            }
+        }
+    }
+    
+    FreeWindField(scratch->field);
+    delete scratch;
+}
+
+struct RaceBatch {
+    const RaceSetup* setup;
+    VMGCache* targets;
+    int firstRun;
+    RaceOutcome* outcomes;
+};
+
+static void RaceJob(void* context, int index) {
+    RaceBatch& batch = *(RaceBatch*)context;
+    SimulateRace(*batch.setup, *batch.targets, batch.firstRun + index, batch.outcomes[index]);
+}
+
+static void FoldOutcome(const RaceSetup& setup, const RaceOutcome& outcome, RaceEstimate& estimate) {
+    float best = INFINITY;
+    int winners = 0;
+    for (int i = 0; i < setup.boatCount; i++) {
+        float t = outcome.finishTime[i];
+        if (t < 0.0f) continue;
+        if (t < best) {
+            best = t;
+            winners = 1;
+        } else if (t == best) {
+            winners++;
+        }
+    }
+    
+    for (int i = 0; i < setup.boatCount; i++) {
+        BoatRaceStats& stats = estimate.boats[i];
+        float t = outcome.finishTime[i];
+        if (t >= 0.0f) {
+            if (t == best) stats.wins += 1.0 / winners;
+            stats.finishes++;
+            AddSample(stats.finishTime, t);
+            AddQuantileSample(stats.finishP10, t);
+            AddQuantileSample(stats.finishP50, t);
+            AddQuantileSample(stats.finishP90, t);
+        }
+        float legStart = 0.0f;
+        for (int leg = 0; leg < estimate.legCount; leg++) {
+            float end = outcome.legTime[i][leg];
+            if (end < 0.0f) break;
+            AddSample(stats.split[leg], end - legStart);
+            legStart = end;
+        }
+    }
+}
+
+// Races are simulated a batch at a time and folded in run order, so memory stays flat
+// however many runs are asked for
+void EstimateRace(const RaceSetup& setup, JobPool& pool, RaceEstimate& estimate) {
+    estimate.runs = 0;
+    estimate.legCount = setup.course->legCount < MAX_RACE_LEGS ? setup.course->legCount : MAX_RACE_LEGS;
+    for (int i = 0; i < MAX_RACE_FLEET; i++) {
+        BoatRaceStats& stats = estimate.boats[i];
+        stats.wins = 0.0;
+        stats.finishes = 0;
+        ResetRunningStats(stats.finishTime);
+        InitQuantileEstimator(stats.finishP10, 0.1f);
+        InitQuantileEstimator(stats.finishP50, 0.5f);
+        InitQuantileEstimator(stats.finishP90, 0.9f);
+        for (int leg = 0; leg < MAX_RACE_LEGS; leg++) ResetRunningStats(stats.split[leg]);
+    }
+    
+    // Skippers read the targets from every thread, so solve them all before the first race
+    static VMGCache targets;
+    InitVMGCache(targets, 0.0f, 1.0f);
+    FillVMGCache(targets, pool);
+    
+    std::vector<RaceOutcome> outcomes(RACE_BATCH_RUNS);
+    for (int first = 0; first < setup.runs; first += RACE_BATCH_RUNS) {
+        int count = setup.runs - first < RACE_BATCH_RUNS ? setup.runs - first : RACE_BATCH_RUNS;
+        RaceBatch batch = {&setup, &targets, first, outcomes.data()};
+        RunJobsStealing(pool, RaceJob, &batch, count);
+    
+        for (int i = 0; i < count; i++) FoldOutcome(setup, outcomes[i], estimate);
+        estimate.runs += count;
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef MONTECARLO_H
+#define MONTECARLO_H
+
+#include "types.h"
+#include "course.h"
+#include "coastline.h"
+#include "jobs.h"
+#include "stats.h"
+#include "vmg.h"
+
+const int MAX_RACE_FLEET = 64;
+const int MAX_RACE_LEGS = 16;
+const int RACE_BATCH_RUNS = 256;          // races simulated between folds into the statistics
+const float RACE_WIND_CELL = 25.0f;
+
+// What the forecast can't pin down, drawn afresh for every race: the race's mean breeze,
+// then a random walk through the wind keyframes, then optionally a gust pattern
+struct WindUncertainty {
+    Wind mean;
+    float speedSpread;        // standard deviation of the race's mean speed, m/s
+    float directionSpread;    // standard deviation of the race's mean direction, radians
+    float shiftSpread;        // direction step per keyframe, radians
+    float pressureSpread;     // speed step per keyframe, fraction of the current speed
+    float shiftInterval;      // seconds between keyframes, 0 = steady
+    bool gusts;
+};
+
+struct RaceSetup {
+    const Course* course;
+    const Coastline* coast;       // optional
+    int boatCount;
+    int boatClass[MAX_RACE_FLEET];
+    float startX, startY;         // middle of the start line, which is square to the mean wind
+    float startSpacing;
+    WindUncertainty wind;
+    float dt;
+    float maxTime;                // boats still racing then are scored as not finishing
+    int runs;
+    unsigned long long seed;
+};
+
+// One race; times are -1 for legs a boat didn't complete
+struct RaceOutcome {
+    float finishTime[MAX_RACE_FLEET];
+    float legTime[MAX_RACE_FLEET][MAX_RACE_LEGS];
+};
+
+struct BoatRaceStats {
+    double wins;                  // ties share the win
+    long long finishes;
+    RunningStats finishTime;
+    QuantileEstimator finishP10, finishP50, finishP90;
+    RunningStats split[MAX_RACE_LEGS];   // time spent on each leg
+};
+
+struct RaceEstimate {
+    int runs;
+    int legCount;
+    BoatRaceStats boats[MAX_RACE_FLEET];
+};
+
+// Run `run` draws from its own RNG stream, so any race can be replayed alone and the
+// estimate doesn't depend on the thread count
+void SimulateRace(const RaceSetup& setup, VMGCache& targets, int run, RaceOutcome& outcome);
+void EstimateRace(const RaceSetup& setup, JobPool& pool, RaceEstimate& estimate);
+
+#endif
@@ -2,15 +2,33 @@
 #include <cmath>
 #include <cstdio>
 
-const float WATER_DENSITY = 1000.0f;
-const float DRAG_COEFFICIENT = 0.007f;
-const float HULL_AREA = 2.0f;
-const float SAIL_AREA = 8.0f;
-const float SAIL_EFFICIENCY = 2.0f;
-const float BOAT_MASS = 50.0f;
-const float RUDDER_EFFECTIVENESS = 0.2f;
+const BoatCoefficients DINGHY_COEFFICIENTS = FoldBoatParams(DINGHY_PARAMS);
+
+static BoatParams classParams[MAX_BOAT_CLASSES] = {DINGHY_PARAMS, KEELBOAT_PARAMS};
+static BoatCoefficients classCoefficients[MAX_BOAT_CLASSES] = {
+    FoldBoatParams(DINGHY_PARAMS), FoldBoatParams(KEELBOAT_PARAMS)
+};
+static int classCount = BUILTIN_BOAT_CLASS_COUNT;
+
+int RegisterBoatClass(const BoatParams& params) {
+    if (classCount >= MAX_BOAT_CLASSES) return -1;
+    classParams[classCount] = params;
+    classCoefficients[classCount] = FoldBoatParams(params);
+    return classCount++;
+}
+
+// Unknown classes fall back to the dinghy
+const BoatParams& GetBoatParams(int boatClass) {
+    return classParams[boatClass >= 0 && boatClass < classCount ? boatClass : BOAT_CLASS_DINGHY];
+}
+
+const BoatCoefficients& GetBoatCoefficients(int boatClass) {
+    return classCoefficients[boatClass >= 0 && boatClass < classCount ? boatClass : BOAT_CLASS_DINGHY];
+}
 
 float NormalizeAngle(float angle) {
+    // A blown-up simulation (a sweep trying extreme parameters) would never get out of the loops
+    if (!(fabsf(angle) < 64.0f)) angle = remainderf(angle, 2*M_PI);
     while (angle > M_PI) angle -= 2*M_PI;
     while (angle < -M_PI) angle += 2*M_PI;
     return angle;
@@ -44,35 +62,18 @@ float GetSailAngle(const Vector2D& apparentWind, float boatHeading, float sheet)
 }
 
 Vector2D CalculateSailForce(const Vector2D& apparentWind, float boatHeading, float sheet) {
-    float sailAngle = GetSailAngle(apparentWind, boatHeading, sheet);
-    float apparentWindSpeed = apparentWind.magnitude();
-    
-    if (apparentWindSpeed < 0.1f) return Vector2D(0, 0);
-    
-    float sailOrientation = boatHeading + sailAngle;
-    float windToSailAngle = NormalizeAngle(atan2f(apparentWind.x, apparentWind.y) - sailOrientation);
-    float efficiency = sinf(fabs(windToSailAngle));
-    
-    float forceMagnitude = 0.5f * SAIL_EFFICIENCY * SAIL_AREA * efficiency * apparentWindSpeed * apparentWindSpeed;
-    float forceDirection = sailOrientation + (windToSailAngle > 0 ? M_PI/2 : -M_PI/2);
-    
-    return Vector2D(
-        forceMagnitude * sinf(forceDirection),
-        forceMagnitude * cosf(forceDirection)
-    );
+    return CalculateSailForce(apparentWind, boatHeading, sheet, DINGHY_COEFFICIENTS.sail);
 }
 
 Vector2D CalculateDrag(float vx, float vy) {
-    Vector2D velocity(vx, vy);
-    float speed = velocity.magnitude();
-    
-    if (speed < 0.01f) return Vector2D(0, 0);
-    
-    float dragMagnitude = 0.5f * WATER_DENSITY * DRAG_COEFFICIENT * HULL_AREA * speed * speed;
-    return velocity.normalized() * -dragMagnitude;
+    return CalculateDrag(vx, vy, DINGHY_COEFFICIENTS.drag);
 }
 
 float CalculateHeelAngle(const Vector2D& apparentWind, float boatHeading, float sailAngle) {
+    return CalculateHeelAngle(apparentWind, boatHeading, sailAngle, DINGHY_COEFFICIENTS.sail);
+}
+
+float CalculateHeelAngle(const Vector2D& apparentWind, float boatHeading, float sailAngle, float sailCoefficient) {
     float apparentWindSpeed = apparentWind.magnitude();
     float apparentWindAngle = atan2f(apparentWind.x, apparentWind.y);
 
@@ -81,7 +82,7 @@ float CalculateHeelAngle(const Vector2D& apparentWind, float boatHeading, float
     float windToSailAngle = NormalizeAngle(apparentWindAngle - sailOrientationWorld);
     float windEfficiency = sinf(fabs(windToSailAngle));  // Max at 90°
 
-    float windForce = 0.5f * SAIL_EFFICIENCY * SAIL_AREA * windEfficiency * apparentWindSpeed * apparentWindSpeed;
+    float windForce = sailCoefficient * windEfficiency * apparentWindSpeed * apparentWindSpeed;
     
     const float SAIL_CENTER_HEIGHT = 3.0f;
     const float RIGHTING_CONSTANT = 10000.0f;
@@ -96,10 +97,6 @@ float CalculateHeelAngle(const Vector2D& apparentWind, float boatHeading, float
     float heelingMoment = heelMagnitude * heelDirection;
     float heelAngle = heelingMoment / RIGHTING_CONSTANT;
 
-    static float prevDeviation = 0.0f;
-    float signSource = fabs(deviationFromCenterline) < 0.01f ? prevDeviation : deviationFromCenterline;
-    prevDeviation = deviationFromCenterline;
-
     float clampedMagnitude = fminf(fabs(heelAngle), M_PI/4);
     return heelAngle > 0 ? clampedMagnitude : -clampedMagnitude;
 }
@@ -3,14 +3,48 @@
 
 #include "types.h"
 
-// Physics constants
-extern const float WATER_DENSITY;
-extern const float DRAG_COEFFICIENT;
-extern const float HULL_AREA;
-extern const float SAIL_AREA;
-extern const float SAIL_EFFICIENCY;
-extern const float BOAT_MASS;
-extern const float RUDDER_EFFECTIVENESS;
+// Hull and rig of a boat class
+struct BoatParams {
+    float waterDensity;
+    float dragCoefficient;
+    float hullArea;
+    float sailArea;
+    float sailEfficiency;
+    float mass;
+    float rudderEffectiveness;
+};
+
+// The products the force model actually uses, folded once per class
+struct BoatCoefficients {
+    float sail;           // 0.5 * sail efficiency * sail area
+    float drag;           // 0.5 * water density * drag coefficient * hull area
+    float inverseMass;
+    float rudder;
+};
+
+constexpr BoatCoefficients FoldBoatParams(const BoatParams& p) {
+    return {0.5f * p.sailEfficiency * p.sailArea,
+            0.5f * p.waterDensity * p.dragCoefficient * p.hullArea,
+            1.0f / p.mass,
+            p.rudderEffectiveness};
+}
+
+constexpr BoatParams DINGHY_PARAMS = {1000.0f, 0.007f, 2.0f, 8.0f, 2.0f, 50.0f, 0.2f};
+constexpr BoatParams KEELBOAT_PARAMS = {1000.0f, 0.005f, 6.0f, 30.0f, 2.0f, 600.0f, 0.1f};
+
+// Boat.boatClass indexes the class table. The built-in classes get a step compiled with
+// their coefficients as constants; registered ones (mixed fleets, sweeps) use the table.
+enum BuiltinBoatClass {
+    BOAT_CLASS_DINGHY,
+    BOAT_CLASS_KEELBOAT,
+    BUILTIN_BOAT_CLASS_COUNT
+};
+
+const int MAX_BOAT_CLASSES = 256;
+
+int RegisterBoatClass(const BoatParams& params);   // not thread-safe; register before stepping
+const BoatParams& GetBoatParams(int boatClass);
+const BoatCoefficients& GetBoatCoefficients(int boatClass);
 
 Vector2D GetWindVector(const Wind& wind);
 Vector2D GetApparentWind(const Wind& trueWind, float boatVx, float boatVy);
@@ -21,4 +55,37 @@ float CalculateHeelAngle(const Vector2D& apparentWind, float boatHeading, float
 float CalculateVMG(const Boat& boat, const Waypoint& waypoint);
 float NormalizeAngle(float angle);
 
+// Class-specific forms of the forces above, inline so a step compiled for one class folds
+// its coefficient. The three-argument versions are the dinghy.
+inline Vector2D CalculateSailForce(const Vector2D& apparentWind, float boatHeading, float sheet, float sailCoefficient) {
+    float sailAngle = GetSailAngle(apparentWind, boatHeading, sheet);
+    float apparentWindSpeed = apparentWind.magnitude();
+    
+    if (apparentWindSpeed < 0.1f) return Vector2D(0, 0);
+    
+    float sailOrientation = boatHeading + sailAngle;
+    float windToSailAngle = NormalizeAngle(atan2f(apparentWind.x, apparentWind.y) - sailOrientation);
+    float efficiency = sinf(fabs(windToSailAngle));
+    
+    float forceMagnitude = sailCoefficient * efficiency * apparentWindSpeed * apparentWindSpeed;
+    float forceDirection = sailOrientation + (windToSailAngle > 0 ? M_PI/2 : -M_PI/2);
+    
+    return Vector2D(
+        forceMagnitude * sinf(forceDirection),
+        forceMagnitude * cosf(forceDirection)
+    );
+}
+
+inline Vector2D CalculateDrag(float vx, float vy, float dragCoefficient) {
+    Vector2D velocity(vx, vy);
+    float speed = velocity.magnitude();
+    
+    if (speed < 0.01f) return Vector2D(0, 0);
+    
+    float dragMagnitude = dragCoefficient * speed * speed;
+    return velocity.normalized() * -dragMagnitude;
+}
+
+float CalculateHeelAngle(const Vector2D& apparentWind, float boatHeading, float sailAngle, float sailCoefficient);
+
 #endif
\ No newline at end of file
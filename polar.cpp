@@ -0,0 +1,76 @@
+#include "polar.h"
+#include "physics.h"
+#include <cmath>
+
+// Net force along the direction of travel at boat speed v, travelling north with the
+// true wind from twa on the starboard side
+static float NetDrive(const BoatCoefficients& k, float windSpeed, float twa, float sheet, float v) {
+    Wind wind = {windSpeed, twa};
+    Vector2D apparent = GetApparentWind(wind, 0.0f, v);
+    // Boat.heading points astern, so a boat making way north has heading pi
+    float drive = CalculateSailForce(apparent, M_PI, sheet, k.sail).y;
+    return drive + CalculateDrag(0.0f, v, k.drag).y;
+}
+
+// Bisection on the speed where drive and drag balance
+float SolveSteadySpeed(const BoatCoefficients& k, float windSpeed, float twa, float sheet) {
+    float low = 0.0f, high = windSpeed * 2.0f + 1.0f;
+    if (NetDrive(k, windSpeed, twa, sheet, 0.01f) <= 0.0f) return 0.0f;
+    for (int i = 0; i < 32; i++) {
+        float mid = 0.5f * (low + high);
+        if (NetDrive(k, windSpeed, twa, sheet, mid) > 0.0f) low = mid;
+        else high = mid;
+    }
+    return 0.5f * (low + high);
+}
+
+float SolveSteadySpeed(float windSpeed, float twa, float sheet) {
+    return SolveSteadySpeed(GetBoatCoefficients(BOAT_CLASS_DINGHY), windSpeed, twa, sheet);
+}
+
+float SolveBestSpeed(const BoatCoefficients& k, float windSpeed, float twa, float& sheet, float sheetMin, float sheetMax) {
+    float range = sheetMax - sheetMin;
+    float bestSpeed = 0.0f, bestSheet = sheetMax;
+    // Coarse scan, then refine around the best sheet
+    for (int i = 0; i <= 20; i++) {
+        float trial = sheetMin + range * (i / 20.0f);
+        float v = SolveSteadySpeed(k, windSpeed, twa, trial);
+        if (v > bestSpeed) { bestSpeed = v; bestSheet = trial; }
+    }
+    float center = bestSheet;
+    for (int i = -5; i <= 5; i++) {
+        float trial = fminf(fmaxf(center + i * (range * 0.01f), sheetMin), sheetMax);
+        float v = SolveSteadySpeed(k, windSpeed, twa, trial);
+        if (v > bestSpeed) { bestSpeed = v; bestSheet = trial; }
+    }
+    sheet = bestSheet;
+    return bestSpeed;
+}
+
+void BuildPolar(Polar& polar) {
+    const BoatCoefficients& k = GetBoatCoefficients(BOAT_CLASS_DINGHY);
+    for (int s = 0; s < POLAR_SPEED_BINS; s++) {
+        float windSpeed = s * POLAR_SPEED_STEP;
+        for (int a = 0; a < POLAR_ANGLE_BINS; a++) {
+            polar.speed[s][a] = SolveBestSpeed(k, windSpeed, a * POLAR_ANGLE_STEP, polar.sheet[s][a]);
+        }
+    }
+}
+
+static float SamplePolarTable(const float table[POLAR_SPEED_BINS][POLAR_ANGLE_BINS], float windSpeed, float twa) {
+    float gs = fminf(fmaxf(windSpeed / POLAR_SPEED_STEP, 0.0f), POLAR_SPEED_BINS - 1.001f);
+    float ga = fminf(fabsf(twa) / POLAR_ANGLE_STEP, POLAR_ANGLE_BINS - 1.001f);
+    int s = (int)gs, a = (int)ga;
+    float fs = gs - s, fa = ga - a;
+    float low = table[s][a] + (table[s][a + 1] - table[s][a]) * fa;
+    float high = table[s + 1][a] + (table[s + 1][a + 1] - table[s + 1][a]) * fa;
+    return low + (high - low) * fs;
+}
+
+float GetPolarSpeed(const Polar& polar, float windSpeed, float twa) {
+    return SamplePolarTable(polar.speed, windSpeed, twa);
+}
+
+float GetPolarSheet(const Polar& polar, float windSpeed, float twa) {
+    return SamplePolarTable(polar.sheet, windSpeed, twa);
+}
@@ -0,0 +1,27 @@
+#ifndef POLAR_H
+#define POLAR_H
+
+#include "types.h"
+#include "physics.h"
+
+const int POLAR_SPEED_BINS = 16;             // true wind speed 0..30 m/s
+const float POLAR_SPEED_STEP = 2.0f;
+const int POLAR_ANGLE_BINS = 37;             // true wind angle 0..180 degrees
+const float POLAR_ANGLE_STEP = 5.0f * (float)M_PI / 180.0f;
+
+// Steady-state boat speed from the force model: sail drive along the direction of travel
+// balanced against hull drag, with the sheet set for the most drive
+struct Polar {
+    float speed[POLAR_SPEED_BINS][POLAR_ANGLE_BINS];
+    float sheet[POLAR_SPEED_BINS][POLAR_ANGLE_BINS];
+};
+
+float SolveSteadySpeed(float windSpeed, float twa, float sheet);
+float SolveSteadySpeed(const BoatCoefficients& k, float windSpeed, float twa, float sheet);
+float SolveBestSpeed(const BoatCoefficients& k, float windSpeed, float twa, float& sheet,
+                     float sheetMin = 0.0f, float sheetMax = 1.0f);
+void BuildPolar(Polar& polar);
+float GetPolarSpeed(const Polar& polar, float windSpeed, float twa);
+float GetPolarSheet(const Polar& polar, float windSpeed, float twa);
+
+#endif
@@ -0,0 +1,200 @@
+#include "regress.h"
+#include "physics.h"
+#include "boat.h"
+#include "rng.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+const char* const TRAJECTORY_FIELD_NAMES[TRAJECTORY_FIELD_COUNT] = {
+    "x", "y", "vx", "vy", "heading", "heel", "sheet", "rudder", "sailAngle", "sailAngularVel"
+};
+
+const float TRAJECTORY_TOLERANCES[TRAJECTORY_FIELD_COUNT] = {
+    1e-2f, 1e-2f,       // metres
+    1e-3f, 1e-3f,       // m/s
+    1e-3f, 1e-3f,       // radians
+    1e-5f, 1e-3f,
+    1e-3f, 1e-2f        // radians, rad/s
+};
+
+const float DEG_TO_RAD = (float)M_PI / 180.0f;
+const float REGRESSION_RUDDER_GAIN = 2.0f;
+
+// Between them: every point of sail, sheet from hard in to eased, tacks and gybes, both
+// built-in classes and a registered one, steady and shifty breeze, and the batch step
+const RegressionScenario REGRESSION_SCENARIOS[REGRESSION_SCENARIO_COUNT] = {
+    {"beat-starboard", BOAT_CLASS_DINGHY, {6.0f, 0.0f}, 0.0f, 0, 60.0f, 1, {{0.0f, 45 * DEG_TO_RAD, 0.2f}}, false},
+    {"beat-port", BOAT_CLASS_DINGHY, {6.0f, 30 * DEG_TO_RAD}, 0.0f, 0, 60.0f, 1, {{0.0f, -45 * DEG_TO_RAD, 0.2f}}, false},
+    {"close-reach", BOAT_CLASS_DINGHY, {8.0f, 270 * DEG_TO_RAD}, 0.0f, 0, 60.0f, 1, {{0.0f, 70 * DEG_TO_RAD, 0.4f}}, false},
+    {"broad-reach", BOAT_CLASS_DINGHY, {8.0f, 90 * DEG_TO_RAD}, 0.0f, 0, 60.0f, 1, {{0.0f, -130 * DEG_TO_RAD, 0.8f}}, false},
+    {"run", BOAT_CLASS_DINGHY, {5.0f, 180 * DEG_TO_RAD}, 0.0f, 0, 60.0f, 1, {{0.0f, 170 * DEG_TO_RAD, 1.0f}}, false},
+    {"sheet-sweep", BOAT_CLASS_DINGHY, {7.0f, 0.0f}, 0.0f, 0, 60.0f, 6,
+        {{0.0f, 90 * DEG_TO_RAD, 0.1f}, {10.0f, 90 * DEG_TO_RAD, 0.3f}, {20.0f, 90 * DEG_TO_RAD, 0.5f},
+         {30.0f, 90 * DEG_TO_RAD, 0.7f}, {40.0f, 90 * DEG_TO_RAD, 0.9f}, {50.0f, 90 * DEG_TO_RAD, 0.4f}}, false},
+    {"tacks", BOAT_CLASS_DINGHY, {6.0f, 0.0f}, 0.0f, 0, 60.0f, 3,
+        {{0.0f, 45 * DEG_TO_RAD, 0.2f}, {20.0f, -45 * DEG_TO_RAD, 0.2f}, {40.0f, 45 * DEG_TO_RAD, 0.2f}}, false},
+    {"gybes", BOAT_CLASS_DINGHY, {7.0f, 0.0f}, 0.0f, 0, 60.0f, 3,
+        {{0.0f, 150 * DEG_TO_RAD, 0.8f}, {20.0f, -150 * DEG_TO_RAD, 0.8f}, {40.0f, 150 * DEG_TO_RAD, 0.8f}}, false},
+    {"keelboat-tack", BOAT_CLASS_KEELBOAT, {9.0f, 0.0f}, 0.0f, 0, 60.0f, 2,
+        {{0.0f, 40 * DEG_TO_RAD, 0.25f}, {30.0f, -40 * DEG_TO_RAD, 0.25f}}, false},
+    {"shifty-custom", REGRESSION_CUSTOM_CLASS, {7.0f, 0.0f}, 0.02f, 7, 60.0f, 3,
+        {{0.0f, 60 * DEG_TO_RAD, 0.3f}, {25.0f, -60 * DEG_TO_RAD, 0.3f}, {45.0f, 120 * DEG_TO_RAD, 0.7f}}, false},
+    {"tacks-batch", BOAT_CLASS_DINGHY, {6.0f, 0.0f}, 0.0f, 0, 60.0f, 3,
+        {{0.0f, 45 * DEG_TO_RAD, 0.2f}, {20.0f, -45 * DEG_TO_RAD, 0.2f}, {40.0f, 45 * DEG_TO_RAD, 0.2f}}, true},
+};
+
+static int GetScenarioClass(int boatClass) {
+    if (boatClass != REGRESSION_CUSTOM_CLASS) return boatClass;
+    static int custom = RegisterBoatClass({1000.0f, 0.006f, 3.0f, 12.0f, 2.0f, 120.0f, 0.15f});
+    return custom;
+}
+
+// Proportional helm on the bow
+static float HelmRudder(float heading, float course) {
+    float error = NormalizeAngle(course - (heading + M_PI));
+    return fminf(fmaxf(error * REGRESSION_RUDDER_GAIN, -1.0f), 1.0f);
+}
+
+// Lane 0 is the scenario's boat; the others steer further off the wind so the lanes differ
+static void StepBatchTick(BoatBatch& batch, Boat& boat, const Wind& wind, float twa, float sheet) {
+    for (int i = 0; i < batch.count; i++) {
+        float laneTwa = twa + (twa < 0.0f ? -i : i) * 15 * DEG_TO_RAD;
+        batch.rudder[i] = HelmRudder(batch.heading[i], wind.direction + laneTwa);
+        batch.sheet[i] = sheet;
+    }
+    UpdateBoatBatch(batch, wind, REGRESSION_DT);
+    
+    boat.x = batch.x[0];
+    boat.y = batch.y[0];
+    boat.vx = batch.vx[0];
+    boat.vy = batch.vy[0];
+    boat.heading = batch.heading[0];
+    boat.sheet = batch.sheet[0];
+    boat.rudder = batch.rudder[0];
+    boat.sailAngle = batch.sailAngle[0];
+    boat.sailAngularVel = batch.sailAngularVel[0];
+}
+
+static void StoreTick(const Boat& boat, float* out) {
+    out[TRAJECTORY_X] = boat.x;
+    out[TRAJECTORY_Y] = boat.y;
+    out[TRAJECTORY_VX] = boat.vx;
+    out[TRAJECTORY_VY] = boat.vy;
+    out[TRAJECTORY_HEADING] = boat.heading;
+    out[TRAJECTORY_HEEL] = boat.heel;
+    out[TRAJECTORY_SHEET] = boat.sheet;
+    out[TRAJECTORY_RUDDER] = boat.rudder;
+    out[TRAJECTORY_SAIL_ANGLE] = boat.sailAngle;
+    out[TRAJECTORY_SAIL_ANGULAR_VEL] = boat.sailAngularVel;
+}
+
+void RunRegressionScenario(const RegressionScenario& scenario, Trajectory& trajectory) {
+    Rng rng;
+    SeedRng(rng, scenario.seed);
+    Wind wind = scenario.wind;
+    
+    // From rest, pointing at the first course
+    Boat boat;
+    InitBoat(boat);
+    boat.boatClass = GetScenarioClass(scenario.boatClass);
+    boat.heading = NormalizeAngle(wind.direction + scenario.steps[0].twa + M_PI);
+    
+    trajectory.dt = REGRESSION_DT;
+    trajectory.tickCount = (int)(scenario.duration / REGRESSION_DT + 0.5f);
+    trajectory.values.resize((size_t)trajectory.tickCount * TRAJECTORY_FIELD_COUNT);
+    
+    BoatBatch batch;
+    if (scenario.batched) {
+        boat.heel = 0.0f;
+        FillBoatBatch(batch, boat, REGRESSION_BATCH_LANES);
+    }
+    
+    int step = 0;
+    for (int tick = 0; tick < trajectory.tickCount; tick++) {
+        float time = tick * REGRESSION_DT;
+        while (step + 1 < scenario.stepCount && scenario.steps[step + 1].time <= time) step++;
+    
+        if (scenario.gustiness > 0.0f) {
+            float speed = wind.speed + scenario.wind.speed * scenario.gustiness * RandomRange(rng, -1.0f, 1.0f);
+            wind.speed = fminf(fmaxf(speed, 0.5f * scenario.wind.speed), 1.5f * scenario.wind.speed);
+            wind.direction = NormalizeAngle(wind.direction + 0.25f * scenario.gustiness * RandomRange(rng, -1.0f, 1.0f));
+        }
+    
+        // Holding the angle to the wind through shifts
+        if (scenario.batched) {
+            StepBatchTick(batch, boat, wind, scenario.steps[step].twa, scenario.steps[step].sheet);
+        } else {
+            boat.rudder = HelmRudder(boat.heading, wind.direction + scenario.steps[step].twa);
+            boat.sheet = scenario.steps[step].sheet;
+            UpdateBoat(boat, wind, REGRESSION_DT);
+        }
+        StoreTick(boat, &trajectory.values[(size_t)tick * TRAJECTORY_FIELD_COUNT]);
+    }
+}
+
+static bool IsAngleField(int field) {
+    return field == TRAJECTORY_HEADING || field == TRAJECTORY_SAIL_ANGLE;
+}
+
+void CompareTrajectories(const Trajectory& golden, const Trajectory& actual, float toleranceScale,
+                         TrajectoryComparison& comparison) {
+    memset(&comparison, 0, sizeof(comparison));
+    comparison.tick = -1;
+    
+    int ticks = golden.tickCount < actual.tickCount ? golden.tickCount : actual.tickCount;
+    if (golden.dt != actual.dt) ticks = 0;
+    
+    for (int tick = 0; tick < ticks; tick++) {
+        const float* expected = &golden.values[(size_t)tick * TRAJECTORY_FIELD_COUNT];
+        const float* got = &actual.values[(size_t)tick * TRAJECTORY_FIELD_COUNT];
+        for (int f = 0; f < TRAJECTORY_FIELD_COUNT; f++) {
+            float error = IsAngleField(f) ? fabsf(NormalizeAngle(got[f] - expected[f])) : fabsf(got[f] - expected[f]);
+            if (std::isnan(error) || error > comparison.maxError[f]) comparison.maxError[f] = error;   // NaN sticks
+            if (!comparison.diverged && !(error <= TRAJECTORY_TOLERANCES[f] * toleranceScale)) {
+                comparison.diverged = true;
+                comparison.tick = tick;
+                comparison.field = f;
+                comparison.expected = expected[f];
+                comparison.actual = got[f];
+            }
+        }
+    }
+    
+    if (!comparison.diverged && (golden.dt != actual.dt || golden.tickCount != actual.tickCount)) {
+        comparison.diverged = true;
+        comparison.tick = ticks;
+        comparison.field = -1;
+    }
+}
+
+bool SaveTrajectory(const char* path, const Trajectory& trajectory) {
+    FILE* file = fopen(path, "wb");
+    if (!file) return false;
+    
+    unsigned int header[4] = {0, 1, TRAJECTORY_FIELD_COUNT, (unsigned int)trajectory.tickCount};
+    memcpy(header, "GOLD", 4);
+    fwrite(header, sizeof(header), 1, file);
+    fwrite(&trajectory.dt, sizeof(float), 1, file);
+    fwrite(trajectory.values.data(), sizeof(float), trajectory.values.size(), file);
+    
+    bool ok = !ferror(file);
+    return fclose(file) == 0 && ok;
+}
+
+bool LoadTrajectory(const char* path, Trajectory& trajectory) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return false;
+    
+    unsigned int header[4];
+    bool ok = fread(header, sizeof(header), 1, file) == 1 && memcmp(header, "GOLD", 4) == 0 &&
+              header[1] == 1 && header[2] == TRAJECTORY_FIELD_COUNT && header[3] <= (1u << 24) &&
+              fread(&trajectory.dt, sizeof(float), 1, file) == 1;
+    if (ok) {
+        trajectory.tickCount = (int)header[3];
+        trajectory.values.resize((size_t)trajectory.tickCount * TRAJECTORY_FIELD_COUNT);
+        ok = fread(trajectory.values.data(), sizeof(float), trajectory.values.size(), file) == trajectory.values.size();
+    }
+    fclose(file);
+    return ok;
+}
@@ -0,0 +1,81 @@
+#ifndef REGRESS_H
+#define REGRESS_H
+
+#include "types.h"
+#include <vector>
+
+// Golden-trajectory regression: scripted boats stepped at a fixed dt, every tick's state
+// compared against a trajectory recorded before the change under test.
+//
+// Golden files, one per scenario:
+//   "GOLD", u32 version, u32 field count, u32 tick count, f32 dt
+//   then the fields of every tick as f32, little-endian
+
+enum TrajectoryField {
+    TRAJECTORY_X,
+    TRAJECTORY_Y,
+    TRAJECTORY_VX,
+    TRAJECTORY_VY,
+    TRAJECTORY_HEADING,
+    TRAJECTORY_HEEL,
+    TRAJECTORY_SHEET,
+    TRAJECTORY_RUDDER,
+    TRAJECTORY_SAIL_ANGLE,
+    TRAJECTORY_SAIL_ANGULAR_VEL,
+    TRAJECTORY_FIELD_COUNT
+};
+
+extern const char* const TRAJECTORY_FIELD_NAMES[TRAJECTORY_FIELD_COUNT];
+extern const float TRAJECTORY_TOLERANCES[TRAJECTORY_FIELD_COUNT];   // absolute; angles compared wrapped
+
+const float REGRESSION_DT = 1.0f / 60.0f;
+const int MAX_REGRESSION_STEPS = 8;
+const int REGRESSION_CUSTOM_CLASS = -1;     // a registered class, so the table step is covered too
+
+// From `time` on the helm steers to true wind angle `twa` (negative = port) with `sheet`
+struct RegressionStep {
+    float time;
+    float twa;
+    float sheet;
+};
+
+struct RegressionScenario {
+    const char* name;
+    int boatClass;
+    Wind wind;
+    float gustiness;              // per-tick random walk of the wind, 0 = steady
+    unsigned long long seed;
+    float duration;
+    int stepCount;
+    RegressionStep steps[MAX_REGRESSION_STEPS];
+    bool batched;                 // stepped as one lane of a BoatBatch; heel isn't carried, so reads 0
+};
+
+const int REGRESSION_SCENARIO_COUNT = 11;
+const int REGRESSION_BATCH_LANES = 4;       // the scenario's boat and three sailing other courses
+extern const RegressionScenario REGRESSION_SCENARIOS[REGRESSION_SCENARIO_COUNT];
+
+struct Trajectory {
+    float dt;
+    int tickCount;
+    std::vector<float> values;    // tickCount * TRAJECTORY_FIELD_COUNT
+};
+
+struct TrajectoryComparison {
+    bool diverged;
+    int tick;                     // first tick out of tolerance
+    int field;                    // -1 when the trajectories differ in dt or length
+    float expected, actual;
+    float maxError[TRAJECTORY_FIELD_COUNT];
+};
+
+void RunRegressionScenario(const RegressionScenario& scenario, Trajectory& trajectory);
+
+// toleranceScale multiplies TRAJECTORY_TOLERANCES
+void CompareTrajectories(const Trajectory& golden, const Trajectory& actual, float toleranceScale,
+                         TrajectoryComparison& comparison);
+
+bool SaveTrajectory(const char* path, const Trajectory& trajectory);
+bool LoadTrajectory(const char* path, Trajectory& trajectory);
+
+#endif
@@ -1,5 +1,4 @@
 #include "rendering.h"
-#include "physics.h"
 #include "wind.h"
 #include <raymath.h>
 #include <rlgl.h>
@@ -39,6 +38,26 @@ void DrawWaypoint3D(const Waypoint& wp, const Boat& boat) {
     DrawLine3D(boatPos, waypointPos, YELLOW);
 }
 
+void DrawCourse3D(const Course& course, int nextLeg) {
+    for (int i = 0; i < course.buoyCount; i++) {
+        const CourseBuoy& buoy = course.buoys[i];
+        Color color = buoy.leg == nextLeg ? ORANGE : ColorAlpha(ORANGE, 0.4f);
+        DrawCylinder((Vector3){buoy.x, 0.0f, -buoy.y}, 0.8f, 0.8f, 1.5f, 8, color);
+    }
+    for (int i = 0; i < course.legCount; i++) {
+        const CourseLeg& leg = course.legs[i];
+        if (leg.type == LEG_MARK) continue;
+        Color color = leg.type == LEG_FINISH ? WHITE : ORANGE;
+        DrawLine3D((Vector3){leg.ax, 0.2f, -leg.ay}, (Vector3){leg.bx, 0.2f, -leg.by}, ColorAlpha(color, i == nextLeg ? 0.9f : 0.3f));
+    }
+}
+
+void DrawRoute3D(const Vector2D path[], int count) {
+    for (int i = 0; i < count - 1; i++) {
+        DrawLine3D((Vector3){path[i].x, 0.3f, -path[i].y}, (Vector3){path[i+1].x, 0.3f, -path[i+1].y}, ColorAlpha(GREEN, 0.7f));
+    }
+}
+
 void DrawWindParticles3D(const WindParticle particles[]) {
     for (int i = 0; i < MAX_PARTICLES; i++) {
         if (particles[i].lifetime > 0) {
@@ -113,27 +132,27 @@ void DrawWaveChevrons3D(const WaveChevron chevrons[]) {
     }
 }
 
-void DrawDebugInfo(const Boat& boat, const Wind& wind, const Waypoint& waypoint, int screenHeight) {
-    float speed = sqrtf(boat.vx*boat.vx + boat.vy*boat.vy);
-    Vector2D apparentWind = GetApparentWind(wind, boat.vx, boat.vy);
-    
-    float displayHeading = NormalizeAngle(boat.heading + M_PI) * 180.0f / M_PI;
-    float apparentWindDir = NormalizeAngle(atan2f(apparentWind.x, apparentWind.y) + M_PI) * 180.0f / M_PI;
-    
-    DrawText(TextFormat("Heading: %.1f°", displayHeading), 10, 10, 20, WHITE);
-    DrawText(TextFormat("Speed: %.2f m/s", speed), 10, 35, 20, WHITE);
-    DrawText(TextFormat("Sheet: %.0f%%", boat.sheet * 100), 10, 60, 20, WHITE);
-    DrawText(TextFormat("True Wind: %.1f m/s from %.0f°", wind.speed, wind.direction * 180.0f / M_PI), 10, 85, 20, SKYBLUE);
-    DrawText(TextFormat("Apparent Wind: %.1f m/s from %.0f°", apparentWind.magnitude(), apparentWindDir), 10, 110, 20, YELLOW);
+void DrawDebugInfo(const Telemetry& telemetry, int screenHeight) {
+    // Text is only reformatted by UpdateTelemetryText when a displayed value changes
+    const HudLine* lines = telemetry.lines;
+    DrawText(lines[HUD_HEADING].text, 10, 10, 20, lines[HUD_HEADING].color);
+    DrawText(lines[HUD_SPEED].text, 10, 35, 20, lines[HUD_SPEED].color);
+    DrawText(lines[HUD_SHEET].text, 10, 60, 20, lines[HUD_SHEET].color);
+    DrawText(lines[HUD_TRUE_WIND].text, 10, 85, 20, lines[HUD_TRUE_WIND].color);
+    DrawText(lines[HUD_APPARENT_WIND].text, 10, 110, 20, lines[HUD_APPARENT_WIND].color);
     
-    if (waypoint.active) {
-        float vmg = CalculateVMG(boat, waypoint);
-        float bearing = NormalizeAngle(atan2f(waypoint.x - boat.x, waypoint.y - boat.y) + M_PI) * 180.0f / M_PI;
-        float distance = sqrtf(powf(waypoint.x - boat.x, 2) + powf(waypoint.y - boat.y, 2));
-        
-        DrawText(TextFormat("Waypoint: %.0f° / %.0fm", bearing, distance), 10, 145, 20, YELLOW);
-        DrawText(TextFormat("VMG: %.2f m/s", vmg), 10, 170, 20, vmg > 0 ? GREEN : RED);
+    if (telemetry.showWaypoint) {
+        DrawText(lines[HUD_WAYPOINT].text, 10, 145, 20, lines[HUD_WAYPOINT].color);
+        DrawText(lines[HUD_VMG].text, 10, 170, 20, lines[HUD_VMG].color);
+        DrawText(lines[HUD_TARGET].text, 10, 195, 20, lines[HUD_TARGET].color);
+    }
+    if (telemetry.showShore) {
+        DrawText(lines[HUD_SHORE].text, 10, 230, 20, lines[HUD_SHORE].color);
+    }
+    if (telemetry.showAutopilot) {
+        DrawText(lines[HUD_AUTOPILOT].text, 10, 255, 20, lines[HUD_AUTOPILOT].color);
     }
     
+    DrawTelemetryLabels(telemetry);
     DrawFPS(10, screenHeight - 30);
 }
\ No newline at end of file
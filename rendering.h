@@ -2,14 +2,18 @@
 #define RENDERING_H
 
 #include "types.h"
+#include "telemetry.h"
+#include "course.h"
 #include <raylib.h>
 
 void DrawBoat3D(const Boat& boat, const Model& boatModel, const Model& sailModel);
 void DrawWaypoint3D(const Waypoint& wp, const Boat& boat);
+void DrawCourse3D(const Course& course, int nextLeg);
+void DrawRoute3D(const Vector2D path[], int count);
 void DrawWindParticles3D(const WindParticle particles[]);
 void DrawWater(const Boat& boat);
 void DrawWake3D(const WakePoint wake[], int wakeCount);
 void DrawWaveChevrons3D(const WaveChevron chevrons[]);
-void DrawDebugInfo(const Boat& boat, const Wind& wind, const Waypoint& waypoint, int screenHeight);
+void DrawDebugInfo(const Telemetry& telemetry, int screenHeight);
 
 #endif
\ No newline at end of file
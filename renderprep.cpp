@@ -0,0 +1,231 @@
+#include "renderprep.h"
+#include "wind.h"
+#include <raymath.h>
+#include <rlgl.h>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+const int PARTICLES_PER_JOB = (MAX_PARTICLES + PARTICLE_JOBS - 1) / PARTICLE_JOBS;
+
+static EffectVertex MakeVertex(float x, float y, float z, Color color, float alpha) {
+    EffectVertex v;
+    v.x = x; v.y = y; v.z = z;
+    v.r = color.r; v.g = color.g; v.b = color.b;
+    v.a = (unsigned char)(fminf(fmaxf(alpha, 0.0f), 1.0f) * 255.0f);
+    return v;
+}
+
+// Segment on a horizontal plane as two triangles, width in world units
+static int PushSegment(EffectVertex* out, Vector3 p1, Vector3 p2, float width, Color color, float alpha) {
+    float dx = p2.x - p1.x;
+    float dz = p2.z - p1.z;
+    float len = sqrtf(dx*dx + dz*dz);
+    if (len < 0.0001f) return 0;
+    
+    float nx = -dz / len * width * 0.5f;
+    float nz = dx / len * width * 0.5f;
+    
+    EffectVertex a = MakeVertex(p1.x + nx, p1.y, p1.z + nz, color, alpha);
+    EffectVertex b = MakeVertex(p1.x - nx, p1.y, p1.z - nz, color, alpha);
+    EffectVertex c = MakeVertex(p2.x - nx, p2.y, p2.z - nz, color, alpha);
+    EffectVertex d = MakeVertex(p2.x + nx, p2.y, p2.z + nz, color, alpha);
+    
+    out[0] = a; out[1] = b; out[2] = c;
+    out[3] = a; out[4] = c; out[5] = d;
+    return 6;
+}
+
+static int BuildParticles(const RenderPrep& prep, int slice, EffectVertex* out) {
+    int begin = slice * PARTICLES_PER_JOB;
+    int end = begin + PARTICLES_PER_JOB < MAX_PARTICLES ? begin + PARTICLES_PER_JOB : MAX_PARTICLES;
+    float width = 1.0f / prep.pixelsPerUnit;
+    
+    int count = 0;
+    for (int i = begin; i < end; i++) {
+        const WindParticle& p = prep.particles[i];
+        if (p.lifetime <= 0) continue;
+    
+        Vector3 pos1 = {p.trailX[0], 1.0f, -p.trailY[0]};
+        Vector3 pos2 = {p.trailX[1], 1.0f, -p.trailY[1]};
+        count += PushSegment(out + count, pos1, pos2, width, LIGHTGRAY, 0.6f);
+    }
+    return count;
+}
+
+static int BuildWake(const RenderPrep& prep, EffectVertex* out) {
+    int count = 0;
+    for (int i = 0; i < prep.wakeCount - 1; i++) {
+        float t = (float)i / prep.wakeCount;  // 0 near boat, 1 far away
+        float alpha = 1.0f - t;
+        float width = (1.0f + (1.0f - t) * 6.0f) / prep.pixelsPerUnit;
+    
+        Vector3 p1 = {prep.wake[i].x, 0.0f, -prep.wake[i].y};
+        Vector3 p2 = {prep.wake[i+1].x, 0.0f, -prep.wake[i+1].y};
+        count += PushSegment(out + count, p1, p2, width, WHITE, alpha * 0.6f);
+    }
+    return count;
+}
+
+static int BuildChevrons(const RenderPrep& prep, EffectVertex* out) {
+    float width = 2.0f / prep.pixelsPerUnit;
+    
+    int count = 0;
+    for (int i = 0; i < MAX_WAVE_CHEVRONS; i++) {
+        const WaveChevron& chevron = prep.chevrons[i];
+        if (!chevron.active) continue;
+    
+        // Same phase mapping as DrawWaveChevrons3D
+        float alpha, angle;
+        if (chevron.phase < 0.5f) {
+            float t = chevron.phase * 2.0f;
+            alpha = t;
+            angle = 180.0f - t * 30.0f;
+        } else {
+            float t = (chevron.phase - 0.5f) * 2.0f;
+            alpha = 1.0f - t;
+            angle = 150.0f + t * 30.0f;
+        }
+    
+        float angleRad = angle * DEG2RAD;
+        float armLength = 3.0f;
+    
+        Vector3 center = {chevron.x, 0.1f, chevron.z};
+        Vector3 left = {
+            center.x + cosf(chevron.rotation + angleRad/2) * armLength,
+            0.1f,
+            center.z + sinf(chevron.rotation + angleRad/2) * armLength
+        };
+        Vector3 right = {
+            center.x + cosf(chevron.rotation - angleRad/2) * armLength,
+            0.1f,
+            center.z + sinf(chevron.rotation - angleRad/2) * armLength
+        };
+    
+        count += PushSegment(out + count, left, center, width, SKYBLUE, alpha * 0.7f);
+        count += PushSegment(out + count, center, right, width, SKYBLUE, alpha * 0.7f);
+    }
+    return count;
+}
+
+static void BuildEffectJob(void* context, int index) {
+    RenderPrep& prep = *(RenderPrep*)context;
+    EffectRange& range = prep.ranges[index];
+    
+    if (index < EFFECT_JOB_WAKE) {
+        range.count = BuildParticles(prep, index - EFFECT_JOB_PARTICLES, range.vertices);
+    } else if (index == EFFECT_JOB_WAKE) {
+        range.count = BuildWake(prep, range.vertices);
+    } else if (index == EFFECT_JOB_CHEVRONS) {
+        range.count = BuildChevrons(prep, range.vertices);
+    } else {
+        range.count = BuildTelemetryGraphs(*prep.telemetry, range.vertices);
+    }
+}
+
+void InitRenderPrep(RenderPrep& prep, JobPool& pool) {
+    prep.pool = &pool;
+    prep.pending = false;
+    prep.hudFirst = 0;
+    prep.hudCount = 0;
+    
+    // Worst case vertex count per job: six vertices per segment
+    int capacities[EFFECT_JOB_COUNT];
+    for (int i = 0; i < PARTICLE_JOBS; i++) capacities[EFFECT_JOB_PARTICLES + i] = PARTICLES_PER_JOB * 6;
+    capacities[EFFECT_JOB_WAKE] = (WAKE_LENGTH - 1) * 6;
+    capacities[EFFECT_JOB_CHEVRONS] = MAX_WAVE_CHEVRONS * 2 * 6;
+    capacities[EFFECT_JOB_HUD] = TELEMETRY_GRAPH_VERTICES;
+    
+    prep.vertexCapacity = 0;
+    for (int i = 0; i < EFFECT_JOB_COUNT; i++) {
+        prep.ranges[i].vertices = nullptr;
+        prep.ranges[i].capacity = capacities[i];
+        prep.ranges[i].count = 0;
+        prep.vertexCapacity += capacities[i];
+    }
+    InitFrameArena(prep.arena, prep.vertexCapacity * sizeof(EffectVertex) + EFFECT_JOB_COUNT * 16);
+    
+    prep.shader = LoadShader("effects.vs", "effects.fs");
+    prep.mvpLoc = GetShaderLocation(prep.shader, "mvp");
+    
+    prep.vao = rlLoadVertexArray();
+    rlEnableVertexArray(prep.vao);
+    prep.vbo = rlLoadVertexBuffer(nullptr, prep.vertexCapacity * sizeof(EffectVertex), true);
+    rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION, 3, RL_FLOAT, false, sizeof(EffectVertex), 0);
+    rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION);
+    rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR, 4, RL_UNSIGNED_BYTE, true, sizeof(EffectVertex), offsetof(EffectVertex, r));
+    rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR);
+    rlDisableVertexArray();
+}
+
+void UnloadRenderPrep(RenderPrep& prep) {
+    if (prep.pending) WaitJobs(*prep.pool);
+    rlUnloadVertexBuffer(prep.vbo);
+    rlUnloadVertexArray(prep.vao);
+    UnloadShader(prep.shader);
+    FreeFrameArena(prep.arena);
+}
+
+void BeginRenderPrep(RenderPrep& prep, const WindParticle particles[], const WakePoint wake[], int wakeCount,
+                     const WaveChevron chevrons[], const Telemetry& telemetry, float pixelsPerUnit) {
+    prep.particles = particles;
+    prep.wake = wake;
+    prep.wakeCount = wakeCount;
+    prep.chevrons = chevrons;
+    prep.telemetry = &telemetry;
+    prep.pixelsPerUnit = pixelsPerUnit;
+    
+    ResetFrameArena(prep.arena);
+    for (int i = 0; i < EFFECT_JOB_COUNT; i++) {
+        EffectRange& range = prep.ranges[i];
+        range.vertices = (EffectVertex*)ArenaAlloc(prep.arena, range.capacity * sizeof(EffectVertex));
+        range.count = 0;
+    }
+    
+    SubmitJobs(*prep.pool, BuildEffectJob, &prep, EFFECT_JOB_COUNT);
+    prep.pending = true;
+}
+
+static void DrawEffectVertices(const RenderPrep& prep, int first, int count) {
+    if (count == 0) return;
+    
+    rlDrawRenderBatchActive();
+    Matrix mvp = MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection());
+    rlEnableShader(prep.shader.id);
+    rlSetUniformMatrix(prep.mvpLoc, mvp);
+    rlDisableBackfaceCulling();
+    rlEnableVertexArray(prep.vao);
+    rlDrawVertexArray(first, count);
+    rlDisableVertexArray();
+    rlEnableBackfaceCulling();
+    rlDisableShader();
+}
+
+// Must be called inside BeginMode3D: waits for the workers, uploads the whole frame once
+// and draws the world-space effects
+void DrawRenderPrep3D(RenderPrep& prep) {
+    prep.hudCount = 0;
+    if (!prep.pending) return;
+    WaitJobs(*prep.pool);
+    prep.pending = false;
+    
+    // Pack the job ranges back to back so the whole frame is a single contiguous upload.
+    // The HUD range is last, so everything before it is world space.
+    EffectVertex* packed = prep.ranges[0].vertices;
+    int total = prep.ranges[0].count;
+    for (int i = 1; i < EFFECT_JOB_COUNT; i++) {
+        if (i == EFFECT_JOB_HUD) prep.hudFirst = total;
+        memmove(packed + total, prep.ranges[i].vertices, prep.ranges[i].count * sizeof(EffectVertex));
+        total += prep.ranges[i].count;
+    }
+    prep.hudCount = total - prep.hudFirst;
+    if (total == 0) return;
+    
+    rlUpdateVertexBuffer(prep.vbo, packed, total * sizeof(EffectVertex), 0);
+    DrawEffectVertices(prep, 0, prep.hudFirst);
+}
+
+// Screen-space graphs from the same upload; call in 2D after the scene
+void DrawRenderPrepHUD(RenderPrep& prep) {
+    DrawEffectVertices(prep, prep.hudFirst, prep.hudCount);
+}
@@ -0,0 +1,61 @@
+#ifndef RENDERPREP_H
+#define RENDERPREP_H
+
+#include "types.h"
+#include "arena.h"
+#include "jobs.h"
+#include "telemetry.h"
+#include <raylib.h>
+
+// Flat ribbon vertex shared by all effect geometry (matches effects.vs)
+struct EffectVertex {
+    float x, y, z;
+    unsigned char r, g, b, a;
+};
+
+const int PARTICLE_JOBS = 4;
+
+enum EffectJob {
+    EFFECT_JOB_PARTICLES = 0,                      // PARTICLE_JOBS slices of the particle array
+    EFFECT_JOB_WAKE = PARTICLE_JOBS,
+    EFFECT_JOB_CHEVRONS,
+    EFFECT_JOB_HUD,                                // screen-space, drawn after the scene
+    EFFECT_JOB_COUNT
+};
+
+struct EffectRange {
+    EffectVertex* vertices;
+    int capacity;
+    int count;
+};
+
+struct RenderPrep {
+    JobPool* pool;
+    FrameArena arena;
+    EffectRange ranges[EFFECT_JOB_COUNT];
+    
+    // Frame inputs, read-only while jobs run
+    const WindParticle* particles;
+    const WakePoint* wake;
+    int wakeCount;
+    const WaveChevron* chevrons;
+    const Telemetry* telemetry;
+    float pixelsPerUnit;
+    
+    Shader shader;
+    int mvpLoc;
+    unsigned int vao;
+    unsigned int vbo;
+    int vertexCapacity;
+    bool pending;
+    int hudFirst, hudCount;   // HUD vertices in the uploaded buffer
+};
+
+void InitRenderPrep(RenderPrep& prep, JobPool& pool);
+void UnloadRenderPrep(RenderPrep& prep);
+void BeginRenderPrep(RenderPrep& prep, const WindParticle particles[], const WakePoint wake[], int wakeCount,
+                     const WaveChevron chevrons[], const Telemetry& telemetry, float pixelsPerUnit);
+void DrawRenderPrep3D(RenderPrep& prep);
+void DrawRenderPrepHUD(RenderPrep& prep);
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <cmath>
+
+// SplitMix64: tiny, fast and independent streams from distinct seeds.
+// Used instead of GetRandomValue wherever results must be reproducible or thread-local.
+struct Rng {
+    unsigned long long state;
+};
+
+inline void SeedRng(Rng& rng, unsigned long long seed) {
+    rng.state = seed;
+}
+
+inline unsigned long long NextRandom(Rng& rng) {
+    unsigned long long z = (rng.state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Stream `index` of a family sharing one seed. The state advances by a fixed gamma per draw,
+// so two seeds that differ by a multiple of the gamma give the same sequence a few draws
+// apart, which seeding with seed * gamma + index runs straight into. The state is hashed instead.
+inline void SeedRngStream(Rng& rng, unsigned long long seed, unsigned long long index) {
+    Rng mixer = {seed ^ index * 0xD1B54A32D192ED03ull};
+    rng.state = NextRandom(mixer);
+}
+
+// Uniform in [0, 1)
+inline float RandomFloat(Rng& rng) {
+    return (NextRandom(rng) >> 40) * (1.0f / 16777216.0f);
+}
+
+inline float RandomRange(Rng& rng, float low, float high) {
+    return low + (high - low) * RandomFloat(rng);
+}
+
+// Standard normal, Box-Muller
+inline float RandomGaussian(Rng& rng) {
+    float u = 1.0f - RandomFloat(rng);   // (0, 1] so the log is finite
+    float v = RandomFloat(rng);
+    return sqrtf(-2.0f * logf(u)) * cosf(2.0f * (float)M_PI * v);
+}
+
+#endif
@@ -0,0 +1,204 @@
+#include "routing.h"
+#include "physics.h"
+#include <cmath>
+
+void InitRouter(Router& router, const Polar& polar, JobPool* pool, int headingCount) {
+    router.polar = &polar;
+    router.pool = pool;
+    router.coast = nullptr;
+    router.field = nullptr;
+    router.wind = {0.0f, 0.0f};
+    router.timeStep = 15.0f;
+    router.headingCount = headingCount < ROUTE_MAX_HEADINGS ? headingCount : ROUTE_MAX_HEADINGS;
+    for (int h = 0; h < router.headingCount; h++) {
+        float course = 2.0f * M_PI * h / router.headingCount;
+        router.headingSin[h] = sinf(course);
+        router.headingCos[h] = cosf(course);
+    }
+    router.arrivalRadius = 10.0f;
+    router.landMargin = 5.0f;
+    router.frontCount = 0;
+    router.arrived = false;
+}
+
+void StartRoute(Router& router, float x, float y, const Waypoint& destination, float time,
+                const WindField* field, const Wind& wind) {
+    router.startX = x;
+    router.startY = y;
+    router.startTime = time;
+    router.destination = destination;
+    router.field = field;
+    router.wind = wind;
+    
+    router.nodes[0] = {x, y, -1, 0.0f};
+    router.frontStart[0] = 0;
+    router.frontStart[1] = 1;
+    router.frontCount = 1;
+    router.arrived = false;
+}
+
+// Fraction of the segment at which it first comes within radius of the point, or -1
+static float SweptArrival(float px, float py, float dx, float dy, float cx, float cy, float radius) {
+    float ox = px - cx, oy = py - cy;
+    float a = dx*dx + dy*dy;
+    float b = dx*ox + dy*oy;
+    float c = ox*ox + oy*oy - radius * radius;
+    if (c <= 0.0f) return 0.0f;
+    float disc = b*b - a*c;
+    if (a <= 0.0f || disc < 0.0f) return -1.0f;
+    float t = (-b - sqrtf(disc)) / a;
+    return t >= 0.0f && t <= 1.0f ? t : -1.0f;
+}
+
+// One job: every heading from a handful of front points
+static void ExpandJob(void* context, int job) {
+    Router& router = *(Router*)context;
+    int front = router.frontCount - 1;
+    int first = router.frontStart[front] + job * ROUTE_JOB_POINTS;
+    int last = router.frontStart[front + 1];
+    if (first + ROUTE_JOB_POINTS < last) last = first + ROUTE_JOB_POINTS;
+    float time = router.startTime + front * router.timeStep;
+    
+    float xs[ROUTE_JOB_POINTS], ys[ROUTE_JOB_POINTS], windX[ROUTE_JOB_POINTS], windY[ROUTE_JOB_POINTS];
+    int count = last - first;
+    for (int i = 0; i < count; i++) {
+        xs[i] = router.nodes[first + i].x;
+        ys[i] = router.nodes[first + i].y;
+    }
+    if (router.field) {
+        SampleWindFieldBatch(*router.field, xs, ys, count, time, windX, windY);
+    } else {
+        Vector2D v = GetWindVector(router.wind);
+        for (int i = 0; i < count; i++) { windX[i] = v.x; windY[i] = v.y; }
+    }
+    
+    router.jobArrival[job] = -1.0f;
+    for (int i = 0; i < count; i++) {
+        Wind local = WindFromVector(Vector2D(windX[i], windY[i]));
+        int base = (first + i - router.frontStart[front]) * router.headingCount;
+    
+        for (int h = 0; h < router.headingCount; h++) {
+            float course = 2.0f * M_PI * h / router.headingCount;
+            float twa = NormalizeAngle(course - local.direction);
+            float distance = GetPolarSpeed(*router.polar, local.speed, twa) * router.timeStep;
+            float dx = router.headingSin[h] * distance;
+            float dy = router.headingCos[h] * distance;
+    
+            RouteNode& candidate = router.candidates[base + h];
+            candidate.x = xs[i] + dx;
+            candidate.y = ys[i] + dy;
+            candidate.course = course;
+            candidate.parent = first + i;
+            router.candidateSector[base + h] = -1;
+            if (distance <= 0.0f ||
+                (router.coast && !IsPathClear(*router.coast, xs[i], ys[i], candidate.x, candidate.y, router.landMargin))) {
+                continue;
+            }
+    
+            float t = SweptArrival(xs[i], ys[i], dx, dy, router.destination.x, router.destination.y, router.arrivalRadius);
+            if (t >= 0.0f && (router.jobArrival[job] < 0.0f || t < router.jobArrival[job])) {
+                router.jobArrival[job] = t;
+                router.jobArrivalParent[job] = first + i;
+            }
+    
+            // Pruning bins by bearing from the start
+            float sx = candidate.x - router.startX, sy = candidate.y - router.startY;
+            int sector = (int)((atan2f(sx, sy) + M_PI) / (2.0f * M_PI) * ROUTE_SECTORS);
+            router.candidateSector[base + h] = sector < ROUTE_SECTORS ? sector : ROUTE_SECTORS - 1;
+            router.candidateDistance[base + h] = sx*sx + sy*sy;
+        }
+    }
+}
+
+// Expands the last front by one time step in parallel, then keeps the farthest candidate per sector
+static bool ExpandFront(Router& router) {
+    int front = router.frontCount - 1;
+    int frontSize = router.frontStart[front + 1] - router.frontStart[front];
+    int jobs = (frontSize + ROUTE_JOB_POINTS - 1) / ROUTE_JOB_POINTS;
+    if (router.pool) RunJobs(*router.pool, ExpandJob, &router, jobs);
+    else for (int j = 0; j < jobs; j++) ExpandJob(&router, j);
+    
+    float best = -1.0f;
+    for (int j = 0; j < jobs; j++) {
+        if (router.jobArrival[j] >= 0.0f && (best < 0.0f || router.jobArrival[j] < best)) {
+            best = router.jobArrival[j];
+            router.arrivalParent = router.jobArrivalParent[j];
+        }
+    }
+    if (best >= 0.0f) {
+        router.arrived = true;
+        router.arrivalTime = router.startTime + (front + best) * router.timeStep;
+        return true;
+    }
+    
+    float sectorDistance[ROUTE_SECTORS];
+    int sectorCandidate[ROUTE_SECTORS];
+    for (int s = 0; s < ROUTE_SECTORS; s++) sectorDistance[s] = -1.0f;
+    
+    int candidateCount = frontSize * router.headingCount;
+    for (int c = 0; c < candidateCount; c++) {
+        int sector = router.candidateSector[c];
+        if (sector >= 0 && router.candidateDistance[c] > sectorDistance[sector]) {
+            sectorDistance[sector] = router.candidateDistance[c];
+            sectorCandidate[sector] = c;
+        }
+    }
+    
+    int next = router.frontStart[front + 1];
+    for (int s = 0; s < ROUTE_SECTORS; s++) {
+        if (sectorDistance[s] >= 0.0f) router.nodes[next++] = router.candidates[sectorCandidate[s]];
+    }
+    if (next == router.frontStart[front + 1]) return false;   // boxed in
+    router.frontStart[front + 2] = next;
+    router.frontCount++;
+    return true;
+}
+
+// Expands at most maxFronts fronts, so a long plan can be spread over several calls
+RouteStatus StepRoute(Router& router, int maxFronts) {
+    for (int i = 0; i < maxFronts && !router.arrived; i++) {
+        if (router.frontCount >= ROUTE_MAX_STEPS || !ExpandFront(router)) return ROUTE_FAILED;
+    }
+    return router.arrived ? ROUTE_ARRIVED : ROUTE_PLANNING;
+}
+
+// Expands until the destination is reached or the step budget runs out
+bool PlanRoute(Router& router) {
+    return StepRoute(router, ROUTE_MAX_STEPS) == ROUTE_ARRIVED;
+}
+
+// The wind from changeTime on is different: fronts that only depend on earlier wind are
+// kept and the rest are dropped, for StepRoute or PlanRoute to recompute. False if the
+// route arrived before the change and still holds.
+bool RewindRoute(Router& router, const WindField* field, const Wind& wind, float changeTime) {
+    router.field = field;
+    router.wind = wind;
+    if (router.arrived && router.arrivalTime <= changeTime) return false;
+    
+    // Front k + 1 is built from wind sampled at front k's time
+    int keep = (int)floorf((changeTime - router.startTime) / router.timeStep) + 1;
+    if (keep < 1) keep = 1;
+    if (keep < router.frontCount) router.frontCount = keep;
+    router.arrived = false;
+    return true;
+}
+
+bool ReplanRoute(Router& router, const WindField* field, const Wind& wind, float changeTime) {
+    if (!RewindRoute(router, field, wind, changeTime)) return true;
+    return PlanRoute(router);
+}
+
+// Start, turning points, destination. Returns the number of points written.
+int GetRoutePath(const Router& router, Vector2D out[], int maxCount) {
+    if (!router.arrived || maxCount < 2) return 0;
+    int count = 0;
+    for (int n = router.arrivalParent; n >= 0; n = router.nodes[n].parent) count++;
+    if (count + 1 > maxCount) return 0;
+    
+    int i = count - 1;
+    for (int n = router.arrivalParent; n >= 0; n = router.nodes[n].parent) {
+        out[i--] = Vector2D(router.nodes[n].x, router.nodes[n].y);
+    }
+    out[count] = Vector2D(router.destination.x, router.destination.y);
+    return count + 1;
+}
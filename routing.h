@@ -0,0 +1,70 @@
+#ifndef ROUTING_H
+#define ROUTING_H
+
+#include "types.h"
+#include "polar.h"
+#include "windfield.h"
+#include "coastline.h"
+#include "jobs.h"
+
+const int ROUTE_MAX_HEADINGS = 72;
+const int ROUTE_SECTORS = 120;              // pruning bins by bearing from the start, 3 degrees each
+const int ROUTE_MAX_STEPS = 256;
+const int ROUTE_MAX_NODES = ROUTE_SECTORS * ROUTE_MAX_STEPS + 1;
+const int ROUTE_JOB_POINTS = 8;             // front points per job
+const int ROUTE_MAX_JOBS = (ROUTE_SECTORS + ROUTE_JOB_POINTS - 1) / ROUTE_JOB_POINTS;
+
+struct RouteNode {
+    float x, y;
+    int parent;                             // node on the previous front, -1 for the start
+    float course;                           // direction sailed from the parent
+};
+
+// Isochrone router: front k holds the farthest points reachable at startTime + k * timeStep.
+// Fronts are kept so a wind change only recomputes the ones after it.
+struct Router {
+    const Polar* polar;
+    JobPool* pool;
+    const Coastline* coast;                 // optional
+    const WindField* field;                 // optional, else the scalar wind
+    Wind wind;
+    
+    float startX, startY, startTime;
+    Waypoint destination;
+    float timeStep;
+    int headingCount;
+    float arrivalRadius;
+    float landMargin;
+    
+    RouteNode nodes[ROUTE_MAX_NODES];
+    int frontStart[ROUTE_MAX_STEPS + 1];    // front k is nodes[frontStart[k] .. frontStart[k + 1])
+    int frontCount;
+    
+    float headingSin[ROUTE_MAX_HEADINGS], headingCos[ROUTE_MAX_HEADINGS];
+    RouteNode candidates[ROUTE_SECTORS * ROUTE_MAX_HEADINGS];
+    int candidateSector[ROUTE_SECTORS * ROUTE_MAX_HEADINGS];     // binned by the jobs, -1 if rejected
+    float candidateDistance[ROUTE_SECTORS * ROUTE_MAX_HEADINGS]; // squared, from the start
+    float jobArrival[ROUTE_MAX_JOBS];       // fraction of the step, per job
+    int jobArrivalParent[ROUTE_MAX_JOBS];
+    
+    bool arrived;
+    float arrivalTime;
+    int arrivalParent;                      // last node before the final leg
+};
+
+enum RouteStatus {
+    ROUTE_PLANNING,
+    ROUTE_ARRIVED,
+    ROUTE_FAILED                            // boxed in, or out of steps
+};
+
+void InitRouter(Router& router, const Polar& polar, JobPool* pool, int headingCount = ROUTE_MAX_HEADINGS);
+void StartRoute(Router& router, float x, float y, const Waypoint& destination, float time,
+                const WindField* field, const Wind& wind);
+RouteStatus StepRoute(Router& router, int maxFronts);
+bool PlanRoute(Router& router);
+bool RewindRoute(Router& router, const WindField* field, const Wind& wind, float changeTime);
+bool ReplanRoute(Router& router, const WindField* field, const Wind& wind, float changeTime);
+int GetRoutePath(const Router& router, Vector2D out[], int maxCount);
+
+#endif
@@ -0,0 +1,171 @@
+#include "sailenv.h"
+#include "types.h"
+#include "boat.h"
+#include "physics.h"
+#include "jobs.h"
+#include "rng.h"
+#include <cmath>
+
+const int SAILENV_JOB_WORLDS = 1024;
+
+struct SailEnvWorld {
+    Boat boat;
+    Wind wind;
+    Waypoint waypoint;
+    float time;
+    float distance;
+    Rng rng;
+};
+
+struct SailEnv {
+    SailEnvConfig config;
+    SailEnvWorld* worlds;
+    JobPool pool;
+    bool threaded;
+    
+    // Buffers of the call in progress
+    const float* actions;
+    float* observations;
+    float* rewards;
+    unsigned char* dones;
+};
+
+void SailEnvDefaultConfig(SailEnvConfig* config) {
+    config->worldCount = 1024;
+    config->threadCount = 0;
+    config->seed = 1;
+    config->dt = 0.1f;
+    config->substeps = 1;
+    config->maxEpisodeTime = 300.0f;
+    config->windSpeedMin = 5.0f;
+    config->windSpeedMax = 20.0f;
+    config->waypointDistance = 200.0f;
+    config->arrivalRadius = 10.0f;
+    config->arrivalReward = 10.0f;
+}
+
+static void ResetWorld(const SailEnvConfig& config, SailEnvWorld& world) {
+    InitBoat(world.boat);
+    world.boat.heading = RandomRange(world.rng, -M_PI, M_PI);
+    world.wind.speed = RandomRange(world.rng, config.windSpeedMin, config.windSpeedMax);
+    world.wind.direction = RandomRange(world.rng, -M_PI, M_PI);
+    
+    float bearing = RandomRange(world.rng, -M_PI, M_PI);
+    world.waypoint.x = config.waypointDistance * sinf(bearing);
+    world.waypoint.y = config.waypointDistance * cosf(bearing);
+    world.waypoint.active = true;
+    world.distance = config.waypointDistance;
+    world.time = 0.0f;
+}
+
+static void WriteObservation(const SailEnvWorld& world, float* out) {
+    const Boat& boat = world.boat;
+    Vector2D apparent = GetApparentWind(world.wind, boat.vx, boat.vy);
+    float travel = boat.heading + M_PI;
+    float dx = world.waypoint.x - boat.x, dy = world.waypoint.y - boat.y;
+    
+    out[SAILENV_OBS_APPARENT_ANGLE] = NormalizeAngle(atan2f(-apparent.x, -apparent.y) - travel);
+    out[SAILENV_OBS_APPARENT_SPEED] = apparent.magnitude();
+    out[SAILENV_OBS_BOAT_SPEED] = sqrtf(boat.vx*boat.vx + boat.vy*boat.vy);
+    out[SAILENV_OBS_HEEL] = boat.heel;
+    out[SAILENV_OBS_SHEET] = boat.sheet;
+    out[SAILENV_OBS_WAYPOINT_BEARING] = NormalizeAngle(atan2f(dx, dy) - travel);
+    out[SAILENV_OBS_WAYPOINT_DISTANCE] = world.distance;
+    out[SAILENV_OBS_VMG] = CalculateVMG(boat, world.waypoint);
+}
+
+static void ResetJob(void* context, int index) {
+    SailEnv& env = *(SailEnv*)context;
+    int first = index * SAILENV_JOB_WORLDS;
+    int last = first + SAILENV_JOB_WORLDS < env.config.worldCount ? first + SAILENV_JOB_WORLDS : env.config.worldCount;
+    for (int i = first; i < last; i++) {
+        ResetWorld(env.config, env.worlds[i]);
+        WriteObservation(env.worlds[i], env.observations + i * SAILENV_OBSERVATION_SIZE);
+    }
+}
+
+static void StepJob(void* context, int index) {
+    SailEnv& env = *(SailEnv*)context;
+    const SailEnvConfig& config = env.config;
+    int first = index * SAILENV_JOB_WORLDS;
+    int last = first + SAILENV_JOB_WORLDS < config.worldCount ? first + SAILENV_JOB_WORLDS : config.worldCount;
+    
+    for (int i = first; i < last; i++) {
+        SailEnvWorld& world = env.worlds[i];
+        const float* action = env.actions + i * SAILENV_ACTION_SIZE;
+        world.boat.rudder = fminf(fmaxf(action[SAILENV_ACTION_RUDDER], -1.0f), 1.0f);
+        world.boat.sheet = fminf(fmaxf(action[SAILENV_ACTION_SHEET], 0.0f), 1.0f);
+    
+        for (int s = 0; s < config.substeps; s++) UpdateBoat(world.boat, world.wind, config.dt);
+        world.time += config.dt * config.substeps;
+    
+        // Reward is the distance made good towards the waypoint this step
+        float dx = world.waypoint.x - world.boat.x, dy = world.waypoint.y - world.boat.y;
+        float distance = sqrtf(dx*dx + dy*dy);
+        float reward = world.distance - distance;
+        world.distance = distance;
+    
+        unsigned char done = 0;
+        if (distance < config.arrivalRadius) {
+            reward += config.arrivalReward;
+            done = SAILENV_DONE_ARRIVED;
+        } else if (world.time >= config.maxEpisodeTime) {
+            done = SAILENV_DONE_TIMEOUT;
+        }
+        if (done) ResetWorld(config, world);
+    
+        env.rewards[i] = reward;
+        env.dones[i] = done;
+        WriteObservation(world, env.observations + i * SAILENV_OBSERVATION_SIZE);
+    }
+}
+
+static void RunEnvJobs(SailEnv& env, JobFunc func) {
+    int jobCount = (env.config.worldCount + SAILENV_JOB_WORLDS - 1) / SAILENV_JOB_WORLDS;
+    if (env.threaded) {
+        RunJobs(env.pool, func, &env, jobCount);
+    } else {
+        for (int j = 0; j < jobCount; j++) func(&env, j);
+    }
+}
+
+SailEnv* SailEnvCreate(const SailEnvConfig* config) {
+    if (!config || config->worldCount <= 0 || config->substeps <= 0) return nullptr;
+    
+    SailEnv* env = new SailEnv;
+    env->config = *config;
+    env->worlds = new SailEnvWorld[config->worldCount];
+    // Each world draws from its own stream, so results don't depend on the thread count
+    for (int i = 0; i < config->worldCount; i++) {
+        SeedRngStream(env->worlds[i].rng, config->seed, i);
+        ResetWorld(env->config, env->worlds[i]);
+    }
+    
+    env->threaded = config->threadCount != 1 && config->worldCount > SAILENV_JOB_WORLDS;
+    if (env->threaded) InitJobPoolThreads(env->pool, config->threadCount);
+    return env;
+}
+
+void SailEnvDestroy(SailEnv* env) {
+    if (!env) return;
+    if (env->threaded) ShutdownJobPool(env->pool);
+    delete[] env->worlds;
+    delete env;
+}
+
+int SailEnvWorldCount(const SailEnv* env) {
+    return env ? env->config.worldCount : 0;
+}
+
+void SailEnvReset(SailEnv* env, float* observations) {
+    env->observations = observations;
+    RunEnvJobs(*env, ResetJob);
+}
+
+void SailEnvStep(SailEnv* env, const float* actions, float* observations, float* rewards, unsigned char* dones) {
+    env->actions = actions;
+    env->observations = observations;
+    env->rewards = rewards;
+    env->dones = dones;
+    RunEnvJobs(*env, StepJob);
+}
@@ -0,0 +1,71 @@
+#ifndef SAILENV_H
+#define SAILENV_H
+
+// C interface for training agents against many independent sailing worlds at once: one boat,
+// one steady wind and one waypoint each. Build it as a shared library, e.g.
+//   g++ -O2 -shared -fPIC sailenv.cpp boat.cpp physics.cpp jobs.cpp -o libsailenv.so -lpthread
+// All buffers belong to the caller and are written in place, world after world.
+
+#if defined(_WIN32)
+#define SAILENV_API __declspec(dllexport)
+#else
+#define SAILENV_API __attribute__((visibility("default")))
+#endif
+
+// Observation layout per world; angles in radians, relative to the direction of travel
+#define SAILENV_OBS_APPARENT_ANGLE 0
+#define SAILENV_OBS_APPARENT_SPEED 1
+#define SAILENV_OBS_BOAT_SPEED 2
+#define SAILENV_OBS_HEEL 3
+#define SAILENV_OBS_SHEET 4
+#define SAILENV_OBS_WAYPOINT_BEARING 5
+#define SAILENV_OBS_WAYPOINT_DISTANCE 6
+#define SAILENV_OBS_VMG 7
+#define SAILENV_OBSERVATION_SIZE 8
+
+// Action layout per world: rudder in [-1, 1], sheet in [0, 1]; out of range values are clamped
+#define SAILENV_ACTION_RUDDER 0
+#define SAILENV_ACTION_SHEET 1
+#define SAILENV_ACTION_SIZE 2
+
+// Done flags; the world has already been reset when either is set
+#define SAILENV_DONE_ARRIVED 1
+#define SAILENV_DONE_TIMEOUT 2
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    
+typedef struct SailEnvConfig {
+    int worldCount;
+    int threadCount;           // 0 = one per core
+    unsigned long long seed;
+    float dt;                  // physics step
+    int substeps;              // physics steps per env step, same action throughout
+    float maxEpisodeTime;      // seconds
+    float windSpeedMin, windSpeedMax;
+    float waypointDistance;
+    float arrivalRadius;
+    float arrivalReward;       // on top of the distance made good each step
+} SailEnvConfig;
+    
+typedef struct SailEnv SailEnv;
+    
+SAILENV_API void SailEnvDefaultConfig(SailEnvConfig* config);
+SAILENV_API SailEnv* SailEnvCreate(const SailEnvConfig* config);
+SAILENV_API void SailEnvDestroy(SailEnv* env);
+SAILENV_API int SailEnvWorldCount(const SailEnv* env);
+    
+// observations: worldCount * SAILENV_OBSERVATION_SIZE floats
+SAILENV_API void SailEnvReset(SailEnv* env, float* observations);
+    
+// actions: worldCount * SAILENV_ACTION_SIZE floats; rewards: worldCount floats;
+// dones: worldCount bytes. Finished worlds restart and report their first observation.
+SAILENV_API void SailEnvStep(SailEnv* env, const float* actions, float* observations,
+                             float* rewards, unsigned char* dones);
+    
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,102 @@
+#include "stats.h"
+#include <cmath>
+
+void ResetRunningStats(RunningStats& stats) {
+    stats.count = 0;
+    stats.mean = 0.0;
+    stats.m2 = 0.0;
+    stats.min = INFINITY;
+    stats.max = -INFINITY;
+}
+
+void AddSample(RunningStats& stats, double x) {
+    stats.count++;
+    double delta = x - stats.mean;
+    stats.mean += delta / stats.count;
+    stats.m2 += delta * (x - stats.mean);
+    stats.min = fminf(stats.min, (float)x);
+    stats.max = fmaxf(stats.max, (float)x);
+}
+
+// Sample variance
+double GetVariance(const RunningStats& stats) {
+    return stats.count > 1 ? stats.m2 / (stats.count - 1) : 0.0;
+}
+
+double GetStandardDeviation(const RunningStats& stats) {
+    return sqrt(GetVariance(stats));
+}
+
+void InitQuantileEstimator(QuantileEstimator& estimator, float p) {
+    estimator.p = p;
+    estimator.count = 0;
+    for (int i = 0; i < 5; i++) estimator.position[i] = i + 1;
+    estimator.desired[0] = 1.0;
+    estimator.desired[1] = 1.0 + 2.0 * p;
+    estimator.desired[2] = 1.0 + 4.0 * p;
+    estimator.desired[3] = 3.0 + 2.0 * p;
+    estimator.desired[4] = 5.0;
+    estimator.increment[0] = 0.0;
+    estimator.increment[1] = p * 0.5;
+    estimator.increment[2] = p;
+    estimator.increment[3] = (1.0 + p) * 0.5;
+    estimator.increment[4] = 1.0;
+}
+
+void AddQuantileSample(QuantileEstimator& estimator, float x) {
+    float* q = estimator.height;
+    double* n = estimator.position;
+    
+    // The first five samples are kept sorted as the initial markers
+    if (estimator.count < 5) {
+        int i = (int)estimator.count++;
+        while (i > 0 && q[i - 1] > x) {
+            q[i] = q[i - 1];
+            i--;
+        }
+        q[i] = x;
+        return;
+    }
+    estimator.count++;
+    
+    int cell;
+    if (x < q[0]) {
+        q[0] = x;
+        cell = 0;
+    } else if (x >= q[4]) {
+        q[4] = x;
+        cell = 3;
+    } else {
+        cell = 0;
+        while (x >= q[cell + 1]) cell++;
+    }
+    for (int i = cell + 1; i < 5; i++) n[i] += 1.0;
+    for (int i = 0; i < 5; i++) estimator.desired[i] += estimator.increment[i];
+    
+    for (int i = 1; i <= 3; i++) {
+        double d = estimator.desired[i] - n[i];
+        if ((d >= 1.0 && n[i + 1] - n[i] > 1.0) || (d <= -1.0 && n[i - 1] - n[i] < -1.0)) {
+            double s = d > 0.0 ? 1.0 : -1.0;
+            float parabolic = q[i] + s / (n[i + 1] - n[i - 1]) *
+                ((n[i] - n[i - 1] + s) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]) +
+                 (n[i + 1] - n[i] - s) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+            if (q[i - 1] < parabolic && parabolic < q[i + 1]) {
+                q[i] = parabolic;
+            } else {
+                int j = i + (int)s;
+                q[i] += s * (q[j] - q[i]) / (n[j] - n[i]);
+            }
+            n[i] += s;
+        }
+    }
+}
+
+// Exact while there are five samples or fewer
+float GetQuantile(const QuantileEstimator& estimator) {
+    if (estimator.count == 0) return NAN;
+    if (estimator.count <= 5) {
+        int i = (int)roundf(estimator.p * (estimator.count - 1));
+        return estimator.height[i];
+    }
+    return estimator.height[2];
+}
@@ -0,0 +1,35 @@
+#ifndef STATS_H
+#define STATS_H
+
+// Single-pass statistics: fixed size however many samples go through, so batch tools can
+// fold results in as they arrive instead of keeping them
+
+// Welford's running mean and variance
+struct RunningStats {
+    long long count;
+    double mean;
+    double m2;          // sum of squared deviations from the mean
+    float min, max;
+};
+
+// P-square estimate of one quantile (Jain & Chlamtac 1985): five markers whose heights
+// follow the quantile and its neighbours, nudged by piecewise-parabolic interpolation
+struct QuantileEstimator {
+    float p;
+    long long count;
+    float height[5];
+    double position[5];           // marker counts; a float stops adding 1 past 2^24 samples
+    double desired[5];
+    double increment[5];
+};
+
+void ResetRunningStats(RunningStats& stats);
+void AddSample(RunningStats& stats, double x);
+double GetVariance(const RunningStats& stats);
+double GetStandardDeviation(const RunningStats& stats);
+
+void InitQuantileEstimator(QuantileEstimator& estimator, float p);
+void AddQuantileSample(QuantileEstimator& estimator, float x);
+float GetQuantile(const QuantileEstimator& estimator);
+
+#endif
@@ -0,0 +1,254 @@
+#include "sweep.h"
+#include "boat.h"
+#include "polar.h"
+#include "rng.h"
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+const char* const SWEEP_PARAM_NAMES[SWEEP_PARAM_COUNT] = {
+    "density", "drag", "hull", "sail", "efficiency", "mass", "rudder"
+};
+
+static float& ParamField(BoatParams& params, int param) {
+    switch (param) {
+        case SWEEP_WATER_DENSITY: return params.waterDensity;
+        case SWEEP_DRAG_COEFFICIENT: return params.dragCoefficient;
+        case SWEEP_HULL_AREA: return params.hullArea;
+        case SWEEP_SAIL_AREA: return params.sailArea;
+        case SWEEP_SAIL_EFFICIENCY: return params.sailEfficiency;
+        case SWEEP_MASS: return params.mass;
+        default: return params.rudderEffectiveness;
+    }
+}
+
+int GetSweepRunCount(const SweepConfig& config) {
+    long long count = config.seedCount > 0 ? config.seedCount : 1;
+    for (int p = 0; p < SWEEP_PARAM_COUNT && count <= SWEEP_MAX_RUNS; p++) {
+        if (config.axes[p].count > 1) count *= config.axes[p].count;
+    }
+    return count > SWEEP_MAX_RUNS ? -1 : (int)count;
+}
+
+// Runs are numbered seed-fastest, then the first axis
+BoatParams GetSweepParams(const SweepConfig& config, int run) {
+    BoatParams params = config.base;
+    int combination = run / (config.seedCount > 0 ? config.seedCount : 1);
+    for (int p = 0; p < SWEEP_PARAM_COUNT; p++) {
+        const SweepAxis& axis = config.axes[p];
+        if (axis.count <= 0) continue;
+        if (axis.count == 1) {
+            ParamField(params, p) = axis.min;
+            continue;
+        }
+        int i = combination % axis.count;
+        combination /= axis.count;
+        ParamField(params, p) = axis.min + (axis.max - axis.min) * i / (axis.count - 1);
+    }
+    return params;
+}
+
+static void ScoreTargets(const SweepConfig& config, const BoatCoefficients& k, SweepResult& result) {
+    float sum = 0.0f, worst = 0.0f;
+    for (int i = 0; i < config.targetCount; i++) {
+        const SpeedTarget& target = config.targets[i];
+        float sheet;
+        float error = fabsf(SolveBestSpeed(k, target.windSpeed, target.twa, sheet) - target.speed);
+        sum += error * error;
+        worst = fmaxf(worst, error);
+    }
+    result.rmsError = config.targetCount > 0 ? sqrtf(sum / config.targetCount) : 0.0f;
+    result.maxError = worst;
+}
+
+// Open-loop replay: recorded controls and wind in, position error at every sample out
+static void ScoreTrack(const SweepConfig& config, const BoatCoefficients& k, SweepResult& result) {
+    const TrackSample* track = config.track;
+    result.rmsError = result.maxError = 0.0f;
+    if (config.trackCount < 2) return;
+    
+    Rng rng;
+    SeedRng(rng, result.seed);
+    
+    Boat boat;
+    InitBoat(boat);
+    boat.x = track[0].x;
+    boat.y = track[0].y;
+    boat.heading = NormalizeAngle(track[0].course + M_PI);
+    
+    // Start at the speed the recording shows over its first interval
+    float interval = track[1].time - track[0].time;
+    float speed = interval > 0.0f ? hypotf(track[1].x - track[0].x, track[1].y - track[0].y) / interval : 0.0f;
+    boat.vx = speed * sinf(track[0].course);
+    boat.vy = speed * cosf(track[0].course);
+    
+    float sum = 0.0f, worst = 0.0f;
+    for (int i = 0; i + 1 < config.trackCount; i++) {
+        const TrackSample& sample = track[i];
+        boat.rudder = sample.rudder;
+        boat.sheet = sample.sheet;
+        Wind wind = {sample.windSpeed, sample.windDirection};
+        if (config.windNoise > 0.0f) wind.speed *= 1.0f + config.windNoise * RandomRange(rng, -1.0f, 1.0f);
+    
+        interval = track[i + 1].time - sample.time;
+        int steps = (int)ceilf(interval / SWEEP_TRACK_STEP);
+        for (int n = 0; n < steps; n++) UpdateBoat(boat, wind, interval / steps, k);
+    
+        float error = hypotf(boat.x - track[i + 1].x, boat.y - track[i + 1].y);
+        sum += error * error;
+        worst = fmaxf(worst, error);
+    }
+    result.rmsError = sqrtf(sum / (config.trackCount - 1));
+    result.maxError = worst;
+}
+
+SweepResult EvaluateSweepRun(const SweepConfig& config, int run) {
+    SweepResult result;
+    int seedCount = config.seedCount > 0 ? config.seedCount : 1;
+    result.run = (unsigned int)run;
+    result.seed = (unsigned int)(config.firstSeed + run % seedCount);
+    result.params = GetSweepParams(config, run);
+    
+    BoatCoefficients k = FoldBoatParams(result.params);
+    if (config.track) ScoreTrack(config, k, result);
+    else ScoreTargets(config, k, result);
+    return result;
+}
+
+struct SweepBlock {
+    const SweepConfig* config;
+    int firstRun;
+    SweepResult* results;
+};
+
+static void SweepJob(void* context, int index) {
+    SweepBlock& block = *(SweepBlock*)context;
+    block.results[index] = EvaluateSweepRun(*block.config, block.firstRun + index);
+}
+
+void EvaluateSweepRuns(const SweepConfig& config, JobPool& pool, int firstRun, int count, SweepResult results[]) {
+    SweepBlock block = {&config, firstRun, results};
+    RunJobsStealing(pool, SweepJob, &block, count);
+}
+
+void WriteSweepHeader(FILE* out) {
+    unsigned int header[3] = {0, 1, 4 + SWEEP_PARAM_COUNT};
+    memcpy(header, "SWPC", 4);
+    fwrite(header, sizeof(header), 1, out);
+    
+    const char* names[4 + SWEEP_PARAM_COUNT] = {"run", "seed"};
+    for (int p = 0; p < SWEEP_PARAM_COUNT; p++) names[2 + p] = SWEEP_PARAM_NAMES[p];
+    names[2 + SWEEP_PARAM_COUNT] = "rms_error";
+    names[3 + SWEEP_PARAM_COUNT] = "max_error";
+    for (int c = 0; c < 4 + SWEEP_PARAM_COUNT; c++) {
+        unsigned char info[2] = {(unsigned char)(c < 2 ? 'u' : 'f'), (unsigned char)strlen(names[c])};
+        fwrite(info, 2, 1, out);
+        fwrite(names[c], info[1], 1, out);
+    }
+}
+
+void WriteSweepRowGroup(FILE* out, const SweepResult results[], int count) {
+    std::vector<unsigned int> column(count);
+    fwrite(&count, sizeof(count), 1, out);
+    
+    for (int i = 0; i < count; i++) column[i] = results[i].run;
+    fwrite(column.data(), sizeof(unsigned int), count, out);
+    for (int i = 0; i < count; i++) column[i] = results[i].seed;
+    fwrite(column.data(), sizeof(unsigned int), count, out);
+    
+    float* values = (float*)column.data();
+    for (int p = 0; p < SWEEP_PARAM_COUNT; p++) {
+        for (int i = 0; i < count; i++) {
+            BoatParams params = results[i].params;
+            values[i] = ParamField(params, p);
+        }
+        fwrite(values, sizeof(float), count, out);
+    }
+    for (int i = 0; i < count; i++) values[i] = results[i].rmsError;
+    fwrite(values, sizeof(float), count, out);
+    for (int i = 0; i < count; i++) values[i] = results[i].maxError;
+    fwrite(values, sizeof(float), count, out);
+}
+
+bool WriteSweepEnd(FILE* out) {
+    unsigned int end = 0;
+    fwrite(&end, sizeof(end), 1, out);
+    return fflush(out) == 0 && !ferror(out);
+}
+
+// Runs are evaluated a row group at a time, so memory stays flat however large the grid
+bool RunSweep(const SweepConfig& config, JobPool& pool, FILE* out, SweepResult& best) {
+    int runCount = GetSweepRunCount(config);
+    if (runCount < 0) return false;
+    std::vector<SweepResult> results(runCount < SWEEP_BLOCK_RUNS ? runCount : SWEEP_BLOCK_RUNS);
+    
+    WriteSweepHeader(out);
+    best.rmsError = INFINITY;
+    for (int first = 0; first < runCount; first += SWEEP_BLOCK_RUNS) {
+        int count = runCount - first < SWEEP_BLOCK_RUNS ? runCount - first : SWEEP_BLOCK_RUNS;
+        EvaluateSweepRuns(config, pool, first, count, results.data());
+    
+        for (int i = 0; i < count; i++) {
+            if (results[i].rmsError < best.rmsError) best = results[i];
+        }
+        WriteSweepRowGroup(out, results.data(), count);
+        if (ferror(out)) return false;
+    }
+    
+    return WriteSweepEnd(out);
+}
+
+// Returns the number of rows read, or -1 if the file can't be opened
+static int LoadRows(const char* path, float* rows, int columns, int maxCount) {
+    FILE* file = fopen(path, "r");
+    if (!file) return -1;
+    
+    char line[512];
+    int count = 0;
+    while (count < maxCount && fgets(line, sizeof(line), file)) {
+        char* comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+    
+        float* row = rows + count * columns;
+        char* cursor = line;
+        int read = 0;
+        while (read < columns) {
+            char* end;
+            row[read] = strtof(cursor, &end);
+            if (end == cursor) break;
+            cursor = end;
+            read++;
+        }
+        if (read == columns) count++;
+    }
+    fclose(file);
+    return count;
+}
+
+int LoadSpeedTargets(const char* path, SpeedTarget targets[], int maxCount) {
+    std::vector<float> rows((size_t)maxCount * 3);
+    int count = LoadRows(path, rows.data(), 3, maxCount);
+    for (int i = 0; i < count; i++) {
+        targets[i].windSpeed = rows[i * 3];
+        targets[i].twa = rows[i * 3 + 1] * (float)M_PI / 180.0f;
+        targets[i].speed = rows[i * 3 + 2];
+    }
+    return count;
+}
+
+int LoadTrack(const char* path, TrackSample samples[], int maxCount) {
+    std::vector<float> rows((size_t)maxCount * 8);
+    int count = LoadRows(path, rows.data(), 8, maxCount);
+    for (int i = 0; i < count; i++) {
+        const float* row = &rows[(size_t)i * 8];
+        samples[i].time = row[0];
+        samples[i].x = row[1];
+        samples[i].y = row[2];
+        samples[i].course = row[3] * (float)M_PI / 180.0f;
+        samples[i].rudder = row[4];
+        samples[i].sheet = row[5];
+        samples[i].windSpeed = row[6];
+        samples[i].windDirection = row[7] * (float)M_PI / 180.0f;
+    }
+    return count;
+}
@@ -0,0 +1,98 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include "physics.h"
+#include "jobs.h"
+#include <cstdio>
+
+// Calibration sweeps: every combination of the swept BoatParams fields and scenario seeds is
+// scored against measured data, either steady-state target speeds or a recorded track.
+//
+// Output is columnar, one row per run, written in row groups as the sweep goes:
+//   "SWPC", u32 version, u32 column count, then per column: u8 type ('u' u32 / 'f' f32),
+//   u8 name length, name bytes
+//   per row group: u32 row count, then each column's values back to back
+//   u32 0 after the last group
+// Values are little-endian. Rows are in run order whatever the thread count.
+
+enum SweepParam {
+    SWEEP_WATER_DENSITY,
+    SWEEP_DRAG_COEFFICIENT,
+    SWEEP_HULL_AREA,
+    SWEEP_SAIL_AREA,
+    SWEEP_SAIL_EFFICIENCY,
+    SWEEP_MASS,
+    SWEEP_RUDDER_EFFECTIVENESS,
+    SWEEP_PARAM_COUNT
+};
+
+extern const char* const SWEEP_PARAM_NAMES[SWEEP_PARAM_COUNT];
+
+const int MAX_SPEED_TARGETS = 4096;
+const int MAX_TRACK_SAMPLES = 1 << 20;
+const int SWEEP_BLOCK_RUNS = 4096;          // runs per row group
+const int SWEEP_MAX_RUNS = 1 << 30;         // leaves int headroom for run ranges
+const float SWEEP_TRACK_STEP = 1.0f / 60.0f;  // longest physics step when replaying a track
+
+// count 0 holds the field at the base value, count 1 at min
+struct SweepAxis {
+    float min, max;
+    int count;
+};
+
+// Measured steady-state speed, e.g. one point of a real boat's polar
+struct SpeedTarget {
+    float windSpeed;
+    float twa;
+    float speed;
+};
+
+// Recorded boat state and controls; course is the direction of travel
+struct TrackSample {
+    float time;
+    float x, y;
+    float course;
+    float rudder, sheet;
+    float windSpeed, windDirection;
+};
+
+struct SweepConfig {
+    BoatParams base;
+    SweepAxis axes[SWEEP_PARAM_COUNT];
+    int seedCount;
+    unsigned long long firstSeed;
+    float windNoise;              // track replay: wind speed jitter per sample, fraction of recorded
+    
+    const SpeedTarget* targets;   // either targets or a track
+    int targetCount;
+    const TrackSample* track;
+    int trackCount;
+};
+
+// Errors are in m/s against targets, metres against a track
+struct SweepResult {
+    unsigned int run;
+    unsigned int seed;
+    BoatParams params;
+    float rmsError;
+    float maxError;
+};
+
+int GetSweepRunCount(const SweepConfig& config);   // -1 if the grid has more than SWEEP_MAX_RUNS
+BoatParams GetSweepParams(const SweepConfig& config, int run);
+SweepResult EvaluateSweepRun(const SweepConfig& config, int run);
+void EvaluateSweepRuns(const SweepConfig& config, JobPool& pool, int firstRun, int count, SweepResult results[]);
+bool RunSweep(const SweepConfig& config, JobPool& pool, FILE* out, SweepResult& best);
+
+// The output format, for writers that gather results some other way
+void WriteSweepHeader(FILE* out);
+void WriteSweepRowGroup(FILE* out, const SweepResult results[], int count);
+bool WriteSweepEnd(FILE* out);
+
+// Whitespace separated text, '#' starts a comment, angles in degrees:
+//   targets: wind speed, true wind angle, boat speed
+//   track: time, x, y, course, rudder, sheet, wind speed, wind direction (from)
+int LoadSpeedTargets(const char* path, SpeedTarget targets[], int maxCount);
+int LoadTrack(const char* path, TrackSample samples[], int maxCount);
+
+#endif
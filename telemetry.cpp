@@ -0,0 +1,240 @@
+#include "telemetry.h"
+#include "physics.h"
+#include "renderprep.h"
+#include <cmath>
+#include <cstdio>
+
+struct ChannelInfo {
+    const char* label;
+    float minSpan;    // keeps flat traces from being stretched into noise
+    Color color;
+};
+
+static const ChannelInfo CHANNEL_INFO[TELEMETRY_CHANNEL_COUNT] = {
+    {"Speed (m/s)",         1.0f, WHITE},
+    {"VMG (m/s)",           1.0f, GREEN},
+    {"Heel (deg)",          5.0f, ORANGE},
+    {"Sheet (%)",          10.0f, WHITE},
+    {"Apparent wind (m/s)", 2.0f, YELLOW},
+    {"Update (ms)",         2.0f, SKYBLUE},
+    {"Draw (ms)",           2.0f, SKYBLUE},
+};
+
+void InitTelemetry(Telemetry& telemetry, int screenWidth) {
+    for (int c = 0; c < TELEMETRY_CHANNEL_COUNT; c++) {
+        telemetry.rings[c].head = 0;
+        telemetry.rings[c].count = 0;
+    }
+    for (int i = 0; i < HUD_LINE_COUNT; i++) {
+        telemetry.lines[i].text[0] = '\0';
+        telemetry.lines[i].valid = false;
+        telemetry.lines[i].color = WHITE;
+    }
+    telemetry.lines[HUD_TRUE_WIND].color = SKYBLUE;
+    telemetry.lines[HUD_APPARENT_WIND].color = YELLOW;
+    telemetry.lines[HUD_WAYPOINT].color = YELLOW;
+    telemetry.lines[HUD_AUTOPILOT].color = GREEN;
+    telemetry.sampleTimer = 0.0f;
+    telemetry.showWaypoint = false;
+    telemetry.showShore = false;
+    telemetry.showAutopilot = false;
+    telemetry.graphX = screenWidth - TELEMETRY_GRAPH_WIDTH - 10;
+    telemetry.graphY = 10;
+}
+
+static void PushSample(TelemetryRing& ring, float value) {
+    ring.values[ring.head] = value;
+    ring.head = (ring.head + 1) % TELEMETRY_SAMPLES;
+    if (ring.count < TELEMETRY_SAMPLES) ring.count++;
+}
+
+void SampleTelemetry(Telemetry& telemetry, const Boat& boat, const Wind& wind, const Waypoint& waypoint,
+                     float updateMs, float drawMs, float dt) {
+    telemetry.sampleTimer += dt;
+    if (telemetry.sampleTimer < TELEMETRY_INTERVAL) return;
+    telemetry.sampleTimer -= TELEMETRY_INTERVAL;
+    if (telemetry.sampleTimer > TELEMETRY_INTERVAL) telemetry.sampleTimer = 0.0f;  // stalled frame, don't backfill
+    
+    Vector2D apparentWind = GetApparentWind(wind, boat.vx, boat.vy);
+    
+    PushSample(telemetry.rings[TELEMETRY_SPEED], sqrtf(boat.vx*boat.vx + boat.vy*boat.vy));
+    PushSample(telemetry.rings[TELEMETRY_VMG], CalculateVMG(boat, waypoint));
+    PushSample(telemetry.rings[TELEMETRY_HEEL], boat.heel * 180.0f / M_PI);
+    PushSample(telemetry.rings[TELEMETRY_SHEET], boat.sheet * 100.0f);
+    PushSample(telemetry.rings[TELEMETRY_APPARENT_WIND], apparentWind.magnitude());
+    PushSample(telemetry.rings[TELEMETRY_UPDATE_MS], updateMs);
+    PushSample(telemetry.rings[TELEMETRY_DRAW_MS], drawMs);
+}
+
+float GetTelemetryLatest(const Telemetry& telemetry, TelemetryChannel channel) {
+    const TelemetryRing& ring = telemetry.rings[channel];
+    if (ring.count == 0) return 0.0f;
+    return ring.values[(ring.head + TELEMETRY_SAMPLES - 1) % TELEMETRY_SAMPLES];
+}
+
+// Returns true when the line needs reformatting for these rounded values
+static bool HudLineChanged(HudLine& line, int key0, int key1) {
+    if (line.valid && line.key[0] == key0 && line.key[1] == key1) return false;
+    line.key[0] = key0;
+    line.key[1] = key1;
+    line.valid = true;
+    return true;
+}
+
+void UpdateTelemetryText(Telemetry& telemetry, const Boat& boat, const Wind& wind, const Waypoint& waypoint) {
+    float speed = sqrtf(boat.vx*boat.vx + boat.vy*boat.vy);
+    Vector2D apparentWind = GetApparentWind(wind, boat.vx, boat.vy);
+    
+    float displayHeading = NormalizeAngle(boat.heading + M_PI) * 180.0f / M_PI;
+    float apparentWindDir = NormalizeAngle(atan2f(apparentWind.x, apparentWind.y) + M_PI) * 180.0f / M_PI;
+    float trueWindDir = wind.direction * 180.0f / M_PI;
+    HudLine* lines = telemetry.lines;
+    
+    if (HudLineChanged(lines[HUD_HEADING], (int)roundf(displayHeading * 10), 0)) {
+        snprintf(lines[HUD_HEADING].text, HUD_TEXT_LENGTH, "Heading: %.1f°", displayHeading);
+    }
+    if (HudLineChanged(lines[HUD_SPEED], (int)roundf(speed * 100), 0)) {
+        snprintf(lines[HUD_SPEED].text, HUD_TEXT_LENGTH, "Speed: %.2f m/s", speed);
+    }
+    if (HudLineChanged(lines[HUD_SHEET], (int)roundf(boat.sheet * 100), 0)) {
+        snprintf(lines[HUD_SHEET].text, HUD_TEXT_LENGTH, "Sheet: %.0f%%", boat.sheet * 100);
+    }
+    if (HudLineChanged(lines[HUD_TRUE_WIND], (int)roundf(wind.speed * 10), (int)roundf(trueWindDir))) {
+        snprintf(lines[HUD_TRUE_WIND].text, HUD_TEXT_LENGTH, "True Wind: %.1f m/s from %.0f°", wind.speed, trueWindDir);
+    }
+    if (HudLineChanged(lines[HUD_APPARENT_WIND], (int)roundf(apparentWind.magnitude() * 10), (int)roundf(apparentWindDir))) {
+        snprintf(lines[HUD_APPARENT_WIND].text, HUD_TEXT_LENGTH, "Apparent Wind: %.1f m/s from %.0f°",
+                 apparentWind.magnitude(), apparentWindDir);
+    }
+    
+    telemetry.showWaypoint = waypoint.active;
+    if (waypoint.active) {
+        float vmg = CalculateVMG(boat, waypoint);
+        float bearing = NormalizeAngle(atan2f(waypoint.x - boat.x, waypoint.y - boat.y) + M_PI) * 180.0f / M_PI;
+        float distance = sqrtf(powf(waypoint.x - boat.x, 2) + powf(waypoint.y - boat.y, 2));
+    
+        if (HudLineChanged(lines[HUD_WAYPOINT], (int)roundf(bearing), (int)roundf(distance))) {
+            snprintf(lines[HUD_WAYPOINT].text, HUD_TEXT_LENGTH, "Waypoint: %.0f° / %.0fm", bearing, distance);
+        }
+        if (HudLineChanged(lines[HUD_VMG], (int)roundf(vmg * 100), 0)) {
+            snprintf(lines[HUD_VMG].text, HUD_TEXT_LENGTH, "VMG: %.2f m/s", vmg);
+        }
+        lines[HUD_VMG].color = vmg > 0 ? GREEN : RED;
+    }
+}
+
+// Target angle and speed for the leg, green once the boat is sailing within a few degrees of it
+void UpdateTargetText(Telemetry& telemetry, const VMGTarget& target, bool upwind, float twa) {
+    HudLine& line = telemetry.lines[HUD_TARGET];
+    float targetDeg = target.twa * 180.0f / M_PI;
+    float twaDeg = fabsf(twa) * 180.0f / M_PI;
+    if (HudLineChanged(line, (int)roundf(targetDeg) * 1000 + (int)roundf(target.speed * 10), (int)roundf(twaDeg))) {
+        snprintf(line.text, HUD_TEXT_LENGTH, "Target %s: %.0f° @ %.1f m/s (TWA %.0f°)",
+                 upwind ? "upwind" : "downwind", targetDeg, target.speed, twaDeg);
+    }
+    line.color = fabsf(twaDeg - targetDeg) < 3.0f ? GREEN : WHITE;
+}
+
+void UpdateAutopilotText(Telemetry& telemetry, bool engaged, bool toMark, float course) {
+    telemetry.showAutopilot = engaged;
+    if (!engaged) return;
+    HudLine& line = telemetry.lines[HUD_AUTOPILOT];
+    float courseDeg = NormalizeAngle(course) * 180.0f / M_PI;
+    if (courseDeg < 0.0f) courseDeg += 360.0f;
+    if (HudLineChanged(line, toMark ? 1 : 0, (int)roundf(courseDeg))) {
+        snprintf(line.text, HUD_TEXT_LENGTH, "Autopilot %s: steering %.0f°", toMark ? "to mark" : "holding", courseDeg);
+    }
+}
+
+// Land on the current heading within the lookahead, and the closest shore in any direction
+void UpdateShoreText(Telemetry& telemetry, bool landAhead, float aheadDistance, float nearestDistance) {
+    HudLine& line = telemetry.lines[HUD_SHORE];
+    telemetry.showShore = true;
+    int aheadKey = landAhead ? (int)roundf(aheadDistance) : -1;
+    if (HudLineChanged(line, aheadKey, (int)roundf(nearestDistance))) {
+        if (landAhead) snprintf(line.text, HUD_TEXT_LENGTH, "Land ahead: %.0fm (shore %.0fm)", aheadDistance, nearestDistance);
+        else snprintf(line.text, HUD_TEXT_LENGTH, "Heading clear (shore %.0fm)", nearestDistance);
+    }
+    line.color = landAhead && aheadDistance < 100.0f ? RED : WHITE;
+}
+
+static EffectVertex ScreenVertex(float x, float y, Color color) {
+    EffectVertex v;
+    v.x = x; v.y = y; v.z = 0.0f;
+    v.r = color.r; v.g = color.g; v.b = color.b; v.a = color.a;
+    return v;
+}
+
+static int PushScreenQuad(EffectVertex* out, float ax, float ay, float bx, float by,
+                          float cx, float cy, float dx, float dy, Color color) {
+    out[0] = ScreenVertex(ax, ay, color);
+    out[1] = ScreenVertex(bx, by, color);
+    out[2] = ScreenVertex(cx, cy, color);
+    out[3] = out[0];
+    out[4] = out[2];
+    out[5] = ScreenVertex(dx, dy, color);
+    return 6;
+}
+
+static int PushScreenSegment(EffectVertex* out, float x1, float y1, float x2, float y2, float width, Color color) {
+    float dx = x2 - x1;
+    float dy = y2 - y1;
+    float len = sqrtf(dx*dx + dy*dy);
+    if (len < 0.0001f) return 0;
+    
+    float nx = -dy / len * width * 0.5f;
+    float ny = dx / len * width * 0.5f;
+    return PushScreenQuad(out, x1 + nx, y1 + ny, x1 - nx, y1 - ny, x2 - nx, y2 - ny, x2 + nx, y2 + ny, color);
+}
+
+// Runs on a render-prep worker; writes at most TELEMETRY_GRAPH_VERTICES
+int BuildTelemetryGraphs(const Telemetry& telemetry, EffectVertex* out) {
+    int count = 0;
+    
+    for (int c = 0; c < TELEMETRY_CHANNEL_COUNT; c++) {
+        const TelemetryRing& ring = telemetry.rings[c];
+        float left = (float)telemetry.graphX;
+        float top = (float)(telemetry.graphY + c * TELEMETRY_GRAPH_SPACING + 14);
+        float right = left + TELEMETRY_GRAPH_WIDTH;
+        float bottom = top + TELEMETRY_GRAPH_HEIGHT;
+    
+        count += PushScreenQuad(out + count, left, top, left, bottom, right, bottom, right, top, (Color){0, 0, 0, 90});
+        if (ring.count < 2) continue;
+    
+        int first = (ring.head + TELEMETRY_SAMPLES - ring.count) % TELEMETRY_SAMPLES;
+        float minValue = ring.values[first];
+        float maxValue = minValue;
+        for (int i = 1; i < ring.count; i++) {
+            float v = ring.values[(first + i) % TELEMETRY_SAMPLES];
+            minValue = fminf(minValue, v);
+            maxValue = fmaxf(maxValue, v);
+        }
+        float span = maxValue - minValue;
+        if (span < CHANNEL_INFO[c].minSpan) {
+            float mid = (maxValue + minValue) * 0.5f;
+            span = CHANNEL_INFO[c].minSpan;
+            minValue = mid - span * 0.5f;
+        }
+    
+        // Newest sample sits at the right edge
+        float step = (float)TELEMETRY_GRAPH_WIDTH / (TELEMETRY_SAMPLES - 1);
+        float startX = right - (ring.count - 1) * step;
+        float prevX = startX;
+        float prevY = bottom - (ring.values[first] - minValue) / span * TELEMETRY_GRAPH_HEIGHT;
+        for (int i = 1; i < ring.count; i++) {
+            float v = ring.values[(first + i) % TELEMETRY_SAMPLES];
+            float x = startX + i * step;
+            float y = bottom - (v - minValue) / span * TELEMETRY_GRAPH_HEIGHT;
+            count += PushScreenSegment(out + count, prevX, prevY, x, y, 1.5f, CHANNEL_INFO[c].color);
+            prevX = x;
+            prevY = y;
+        }
+    }
+    return count;
+}
+
+void DrawTelemetryLabels(const Telemetry& telemetry) {
+    for (int c = 0; c < TELEMETRY_CHANNEL_COUNT; c++) {
+        DrawText(CHANNEL_INFO[c].label, telemetry.graphX, telemetry.graphY + c * TELEMETRY_GRAPH_SPACING, 10, LIGHTGRAY);
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "types.h"
+#include "vmg.h"
+#include <raylib.h>
+
+const int TELEMETRY_SAMPLES = 240;
+const float TELEMETRY_INTERVAL = 0.25f;  // 240 samples = one minute of history
+
+enum TelemetryChannel {
+    TELEMETRY_SPEED,
+    TELEMETRY_VMG,
+    TELEMETRY_HEEL,
+    TELEMETRY_SHEET,
+    TELEMETRY_APPARENT_WIND,
+    TELEMETRY_UPDATE_MS,
+    TELEMETRY_DRAW_MS,
+    TELEMETRY_CHANNEL_COUNT
+};
+
+struct TelemetryRing {
+    float values[TELEMETRY_SAMPLES];
+    int head;     // next write slot
+    int count;
+};
+
+enum HudLineId {
+    HUD_HEADING,
+    HUD_SPEED,
+    HUD_SHEET,
+    HUD_TRUE_WIND,
+    HUD_APPARENT_WIND,
+    HUD_WAYPOINT,
+    HUD_VMG,
+    HUD_TARGET,
+    HUD_SHORE,
+    HUD_AUTOPILOT,
+    HUD_LINE_COUNT
+};
+
+const int HUD_TEXT_LENGTH = 64;
+
+// Formatted once per change of the displayed (rounded) values, not per frame
+struct HudLine {
+    char text[HUD_TEXT_LENGTH];
+    int key[2];
+    bool valid;
+    Color color;
+};
+
+struct Telemetry {
+    TelemetryRing rings[TELEMETRY_CHANNEL_COUNT];
+    float sampleTimer;
+    HudLine lines[HUD_LINE_COUNT];
+    bool showWaypoint;
+    bool showShore;
+    bool showAutopilot;
+    int graphX, graphY;   // top-left of the sparkline panel in screen pixels
+};
+
+struct EffectVertex;
+
+const int TELEMETRY_GRAPH_WIDTH = 200;
+const int TELEMETRY_GRAPH_HEIGHT = 36;
+const int TELEMETRY_GRAPH_SPACING = 52;
+// Per channel: a background quad plus one quad per line segment
+const int TELEMETRY_GRAPH_VERTICES = TELEMETRY_CHANNEL_COUNT * TELEMETRY_SAMPLES * 6;
+
+void InitTelemetry(Telemetry& telemetry, int screenWidth);
+void SampleTelemetry(Telemetry& telemetry, const Boat& boat, const Wind& wind, const Waypoint& waypoint,
+                     float updateMs, float drawMs, float dt);
+void UpdateTelemetryText(Telemetry& telemetry, const Boat& boat, const Wind& wind, const Waypoint& waypoint);
+void UpdateTargetText(Telemetry& telemetry, const VMGTarget& target, bool upwind, float twa);
+void UpdateAutopilotText(Telemetry& telemetry, bool engaged, bool toMark, float course);
+void UpdateShoreText(Telemetry& telemetry, bool landAhead, float aheadDistance, float nearestDistance);
+float GetTelemetryLatest(const Telemetry& telemetry, TelemetryChannel channel);
+int BuildTelemetryGraphs(const Telemetry& telemetry, EffectVertex* out);
+void DrawTelemetryLabels(const Telemetry& telemetry);
+
+#endif
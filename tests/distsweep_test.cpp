@@ -0,0 +1,176 @@
+// The coordinator against scripted workers: a failed sweep leaves nothing behind, ranges lost
+// with dropped workers go out again lowest first, and the merged file matches run order.
+//   g++ -O2 -std=c++17 -I. tests/distsweep_test.cpp distsweep.cpp sweep.cpp polar.cpp boat.cpp physics.cpp jobs.cpp -lpthread -o distsweep_test
+//   ./distsweep_test
+#include "distsweep.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// The wire format as distsweep.cpp speaks it
+enum { MSG_CONFIG = 1, MSG_RANGE, MSG_SHRINK, MSG_DONE, MSG_READY, MSG_RESULTS };
+struct Header {
+    unsigned int type;
+    unsigned int length;
+};
+
+static int failures = 0;
+
+static void Check(bool ok, const char* what) {
+    if (!ok) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static SweepResult FakeResult(int run) {
+    SweepResult result = {};
+    result.run = run;
+    result.rmsError = (run % 977) * 0.01f;
+    result.maxError = (run % 313) * 0.02f;
+    return result;
+}
+
+static bool Send(int fd, unsigned int type, const void* payload, unsigned int length) {
+    Header header = {type, length};
+    return send(fd, &header, sizeof(header), MSG_NOSIGNAL) == (ssize_t)sizeof(header) &&
+           (length == 0 || send(fd, payload, length, MSG_NOSIGNAL) == (ssize_t)length);
+}
+
+static bool Recv(int fd, Header& header, std::vector<char>& payload) {
+    if (recv(fd, &header, sizeof(header), MSG_WAITALL) != (ssize_t)sizeof(header)) return false;
+    payload.resize(header.length);
+    return header.length == 0 || recv(fd, payload.data(), header.length, MSG_WAITALL) == (ssize_t)header.length;
+}
+
+// Connects, takes the config and asks for a range; returns the socket with the range in `range`
+static int Join(const char* path, int range[2]) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    for (int tries = 0; connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0; tries++) {
+        if (tries == 100) return -1;
+        usleep(20000);
+    }
+    Header header;
+    std::vector<char> payload;
+    if (!Recv(fd, header, payload) || header.type != MSG_CONFIG || !Send(fd, MSG_READY, nullptr, 0)) return -1;
+    if (!Recv(fd, header, payload) || header.type != MSG_RANGE) return -1;
+    memcpy(range, payload.data(), 2 * sizeof(int));
+    return fd;
+}
+
+static void SendResults(int fd, int first, int end) {
+    std::vector<SweepResult> results;
+    for (int run = first; run < end; run++) results.push_back(FakeResult(run));
+    Send(fd, MSG_RESULTS, results.data(), (unsigned int)(results.size() * sizeof(SweepResult)));
+}
+
+// Reports the whole range and asks for the next; false once told it's done
+static bool Finish(int fd, int range[2]) {
+    SendResults(fd, range[0], range[1]);
+    Send(fd, MSG_READY, nullptr, 0);
+    
+    Header header;
+    std::vector<char> payload;
+    while (Recv(fd, header, payload)) {
+        if (header.type == MSG_DONE) return false;
+        if (header.type != MSG_RANGE) continue;
+        memcpy(range, payload.data(), 2 * sizeof(int));
+        return true;
+    }
+    return false;
+}
+
+static std::vector<char> ReadAll(FILE* file) {
+    std::vector<char> bytes;
+    rewind(file);
+    int c;
+    while ((c = fgetc(file)) != EOF) bytes.push_back((char)c);
+    return bytes;
+}
+
+int main() {
+    SweepConfig config = {};
+    config.seedCount = 1;
+    config.axes[SWEEP_DRAG_COEFFICIENT] = {0.005f, 0.009f, SWEEP_REORDER_RUNS + 3 * SWEEP_CHUNK_RUNS + 100};
+    int runCount = GetSweepRunCount(config);
+    
+    // What a sweep writes, in run order
+    FILE* expected = tmpfile();
+    WriteSweepHeader(expected);
+    std::vector<SweepResult> rows;
+    for (int run = 0; run < runCount; run++) {
+        rows.push_back(FakeResult(run));
+        if ((int)rows.size() == SWEEP_BLOCK_RUNS || run == runCount - 1) {
+            WriteSweepRowGroup(expected, rows.data(), (int)rows.size());
+            rows.clear();
+        }
+    }
+    WriteSweepEnd(expected);
+    
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/distsweep_test.%d", (int)getpid());
+    char address[80];
+    snprintf(address, sizeof(address), "unix:%s", path);
+    
+    // A range that takes down every worker given it fails the sweep, with part of it merged.
+    // Nothing from this one may leak into the next.
+    FILE* failedOut = tmpfile();
+    SweepResult best;
+    bool ok = true;
+    std::thread failing([&] { ok = RunSweepCoordinator(config, address, 0, 1, failedOut, best); });
+    for (int attempt = 0; attempt < SWEEP_MAX_ATTEMPTS; attempt++) {
+        int range[2];
+        int fd = Join(path, range);
+        Check(fd >= 0 && range[0] == (attempt == 0 ? 0 : 100), "the failing range is retried");
+        if (attempt == 0) SendResults(fd, 0, 100);
+        close(fd);
+        usleep(300000);
+    }
+    failing.join();
+    Check(!ok, "sweep fails after the last attempt");
+    fclose(failedOut);
+    
+    FILE* out = tmpfile();
+    ok = false;
+    std::thread coordinator([&] { ok = RunSweepCoordinator(config, address, 0, 1, out, best); });
+    
+    // One worker sits on the first range while another works up to the end of the reorder window
+    int low[2], high[2];
+    int lowFd = Join(path, low);
+    int highFd = Join(path, high);
+    Check(lowFd >= 0 && highFd >= 0 && low[0] == 0, "workers join");
+    while (highFd >= 0 && high[1] < SWEEP_REORDER_RUNS && Finish(highFd, high)) {}
+    Check(high[1] == SWEEP_REORDER_RUNS, "second worker reaches the end of the window");
+    
+    // Dropped in that order; the poll loop has to see them separately
+    close(lowFd);
+    usleep(300000);
+    close(highFd);
+    usleep(300000);
+    
+    int range[2];
+    int fd = Join(path, range);
+    Check(fd >= 0 && range[0] == 0, "the range holding up the merge goes out first");
+    std::vector<int> firsts(1, range[0]);
+    while (fd >= 0 && Finish(fd, range)) firsts.push_back(range[0]);
+    Check(firsts.size() > 1 && firsts[1] == high[0], "then the one dropped after it");
+    close(fd);
+    coordinator.join();
+    
+    Check(ok, "sweep completes");
+    Check(ReadAll(out) == ReadAll(expected), "merged file matches run order");
+    printf("%d runs, first ranges after the drops: %d %d\n", runCount, firsts[0], firsts.size() > 1 ? firsts[1] : -1);
+    
+    fclose(out);
+    fclose(expected);
+    if (failures == 0) printf("distsweep_test: ok\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+// The gust pattern moves at the base wind's speed through keyframe changes, however long the session.
+//   g++ -O2 -std=c++17 -I. tests/gusts_test.cpp windfield.cpp gusts.cpp physics.cpp -o gusts_test
+//   ./gusts_test
+#include "windfield.h"
+#include "physics.h"
+#include <cmath>
+#include <cstdio>
+
+static int failures = 0;
+
+static void Check(bool ok, const char* what) {
+    if (!ok) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+// Four keyframes a minute apart that swing the breeze through a right angle and back, looping
+static void SetKeyframes(WindField& field, float swing) {
+    for (int k = 0; k < 4; k++) {
+        Wind wind = {k % 2 ? 9.0f : 5.0f, k == 1 ? swing : 0.0f};
+        SetWindFieldKeyframe(field, k, k * 60.0f, wind);
+    }
+}
+
+int main() {
+    Wind wind = {5.0f, 0.0f};
+    static WindField field;
+    InitWindField(field, wind, 25.0f);
+    field.period = 240.0f;
+    SetKeyframes(field, (float)M_PI / 2.0f);
+    
+    // Ten hours in 10 s steps, each step checked against the base wind at its middle
+    const float step = 10.0f;
+    float worstSpeed = 0.0f, worstError = 0.0f;
+    Vector2D previous = GetGustOffset(field, 0.0f);
+    for (int i = 1; i <= 3600; i++) {
+        float time = i * step;
+        Vector2D offset = GetGustOffset(field, time);
+        Vector2D velocity = (offset - previous) * (1.0f / step);
+        Vector2D base = SampleWindField(field, 0.0f, 0.0f, time - step * 0.5f);
+        worstSpeed = fmaxf(worstSpeed, velocity.magnitude());
+        worstError = fmaxf(worstError, (velocity - base).magnitude());
+        previous = offset;
+    }
+    printf("pattern speed at most %.3f m/s, off the base wind by at most %.3f m/s\n", worstSpeed, worstError);
+    Check(worstSpeed < 9.0f * 1.01f, "pattern no faster than the strongest keyframe");
+    Check(worstError < 0.1f, "pattern moves with the base wind");
+    
+    // Revising a keyframe after anchoring leaves the pattern where it was
+    float now = 7200.0f + 30.0f;
+    Vector2D before = GetGustOffset(field, now);
+    AnchorWindFieldGusts(field, now);
+    SetKeyframes(field, (float)M_PI / 4.0f);
+    Vector2D after = GetGustOffset(field, now);
+    Check((after - before).magnitude() < 0.05f, "revision doesn't jump the pattern");
+    Vector2D velocity = (GetGustOffset(field, now + step) - after) * (1.0f / step);
+    Check(velocity.magnitude() < 9.0f * 1.01f, "pattern speed bounded after a revision");
+    
+    FreeWindField(field);
+    if (failures == 0) printf("gusts_test: ok\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+// ReplanRoute keeps the fronts built before a wind change and ends up where a full plan does.
+//   g++ -O2 -std=c++17 -I. tests/routing_test.cpp routing.cpp polar.cpp windfield.cpp gusts.cpp coastline.cpp physics.cpp jobs.cpp -lpthread -o routing_test
+//   ./routing_test
+#include "routing.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+static int failures = 0;
+
+static void Check(bool ok, const char* what) {
+    if (!ok) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+// Pressure bands across the course that strengthen over time, so every keyframe bakes differently
+static Vector2D Bands(void* user, float x, float y, float time) {
+    const float* veer = (const float*)user;
+    Wind wind = {6.0f + 2.0f * sinf(x * 0.01f + y * 0.003f) + time * 0.01f, time >= 120.0f ? *veer : 0.0f};
+    return GetWindVector(wind);
+}
+
+// A breeze from the north that veers at the third keyframe
+static void SetKeyframes(WindField& field, float veer) {
+    for (int k = 0; k < 4; k++) {
+        Wind wind = {6.0f, k == 2 ? veer : 0.0f};
+        SetWindFieldKeyframe(field, k, k * 60.0f, wind);
+    }
+}
+
+int main() {
+    static Polar polar;
+    BuildPolar(polar);
+    Wind wind = {6.0f, 0.0f};
+    Waypoint mark = {0.0f, 600.0f, true};
+    
+    static WindField field;
+    InitWindField(field, wind, 25.0f);
+    SetKeyframes(field, 0.0f);
+    
+    static Router router;
+    InitRouter(router, polar, nullptr);
+    StartRoute(router, 0.0f, 0.0f, mark, 0.0f, &field, wind);
+    Check(PlanRoute(router), "first plan arrives");
+    float firstArrival = router.arrivalTime;
+    int firstFronts = router.frontCount;
+    
+    // Only the wind after the second keyframe moves, so the fronts up to it still hold
+    static RouteNode kept[ROUTE_MAX_NODES];
+    memcpy(kept, router.nodes, sizeof(kept));
+    SetKeyframes(field, 20.0f * (float)M_PI / 180.0f);
+    Check(RewindRoute(router, &field, wind, 60.0f), "rewind drops fronts");
+    int keep = (int)(60.0f / router.timeStep) + 1;
+    Check(router.frontCount == keep, "rewind keeps the fronts before the change");
+    Check(keep > 1 && keep < firstFronts, "the change lands inside the plan");
+    Check(PlanRoute(router), "replan arrives");
+    Check(memcmp(kept, router.nodes, router.frontStart[keep] * sizeof(RouteNode)) == 0, "kept fronts untouched");
+    printf("fronts %d, reused %d, recomputed %d\n", firstFronts, keep, router.frontCount - keep);
+    
+    // Same answer as planning from scratch through the changed wind
+    static Router fresh;
+    InitRouter(fresh, polar, nullptr);
+    StartRoute(fresh, 0.0f, 0.0f, mark, 0.0f, &field, wind);
+    Check(PlanRoute(fresh), "full plan arrives");
+    Check(fresh.arrivalTime == router.arrivalTime, "replan matches the full plan");
+    Check(fresh.arrivalTime != firstArrival, "the change moved the arrival");
+    
+    Vector2D replanned[ROUTE_MAX_STEPS + 2], full[ROUTE_MAX_STEPS + 2];
+    int count = GetRoutePath(router, replanned, ROUTE_MAX_STEPS + 2);
+    Check(count == GetRoutePath(fresh, full, ROUTE_MAX_STEPS + 2), "same number of turns");
+    for (int i = 0; i < count; i++) {
+        Check(replanned[i].x == full[i].x && replanned[i].y == full[i].y, "same path");
+    }
+    
+    // Budgeted planning reaches the same route a few fronts at a time
+    StartRoute(fresh, 0.0f, 0.0f, mark, 0.0f, &field, wind);
+    int calls = 0;
+    RouteStatus status;
+    while ((status = StepRoute(fresh, 2)) == ROUTE_PLANNING) calls++;
+    Check(status == ROUTE_ARRIVED && fresh.arrivalTime == router.arrivalTime, "stepped plan matches");
+    Check(calls > 1, "stepped plan spans several calls");
+    
+    // A revision re-bakes only its keyframe in the tiles already out, so they stay and sample
+    // the same as tiles baked after it
+    static float veer = 0.0f;
+    static WindField banded, baked;
+    InitWindField(banded, wind, 25.0f);
+    InitWindField(baked, wind, 25.0f);
+    SetKeyframes(banded, 0.0f);
+    SetWindFieldGenerator(banded, Bands, &veer);
+    SetWindFieldGenerator(baked, Bands, &veer);
+    Boat boat = {};
+    StreamWindFieldTiles(banded, &boat, 1);
+    int tiles = banded.tileCount;
+    veer = 20.0f * (float)M_PI / 180.0f;
+    SetKeyframes(banded, veer);
+    SetKeyframes(baked, veer);
+    StreamWindFieldTiles(baked, &boat, 1);
+    Check(tiles > 0 && banded.tileCount == tiles, "revision keeps the baked tiles");
+    bool same = true;
+    for (float t = 0.0f; t < 240.0f; t += 17.0f) {
+        for (float x = -300.0f; x < 300.0f; x += 37.0f) {
+            Vector2D a = SampleWindField(banded, x, 50.0f, t), b = SampleWindField(baked, x, 50.0f, t);
+            same = same && a.x == b.x && a.y == b.y;
+        }
+    }
+    Check(same, "revised tiles sample like freshly baked ones");
+    FreeWindField(banded);
+    FreeWindField(baked);
+    
+    FreeWindField(field);
+    if (failures == 0) printf("routing_test: ok\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,93 @@
+/* Drives the sailenv C interface the way a training loop would, from C.
+ *   g++ -O2 -shared -fPIC sailenv.cpp boat.cpp physics.cpp jobs.cpp -o libsailenv.so -lpthread
+ *   gcc -O2 -I. tests/sailenv_test.c -L. -lsailenv -lm -o sailenv_test && LD_LIBRARY_PATH=. ./sailenv_test
+ */
+#include "sailenv.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WORLDS 2500   /* more than one job's worth, so the pool is used */
+#define STEPS 600
+
+static int failures = 0;
+
+static void Check(int ok, const char* what) {
+    if (!ok) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+/* Steers at the waypoint with the sheet half out; returns the total reward, fills the last observations */
+static double Run(int threadCount, float* observations, int* arrivals) {
+    SailEnvConfig config;
+    SailEnvDefaultConfig(&config);
+    config.worldCount = WORLDS;
+    config.threadCount = threadCount;
+    config.seed = 42;
+    
+    SailEnv* env = SailEnvCreate(&config);
+    Check(env != NULL, "create");
+    if (!env) return 0.0;
+    Check(SailEnvWorldCount(env) == WORLDS, "world count");
+    
+    float* actions = malloc(sizeof(float) * WORLDS * SAILENV_ACTION_SIZE);
+    float* rewards = malloc(sizeof(float) * WORLDS);
+    unsigned char* dones = malloc(WORLDS);
+    double total = 0.0;
+    *arrivals = 0;
+    
+    SailEnvReset(env, observations);
+    for (int step = 0; step < STEPS; step++) {
+        for (int i = 0; i < WORLDS; i++) {
+            float bearing = observations[i * SAILENV_OBSERVATION_SIZE + SAILENV_OBS_WAYPOINT_BEARING];
+            actions[i * SAILENV_ACTION_SIZE + SAILENV_ACTION_RUDDER] = 2.0f * bearing;
+            actions[i * SAILENV_ACTION_SIZE + SAILENV_ACTION_SHEET] = 0.5f;
+        }
+        SailEnvStep(env, actions, observations, rewards, dones);
+        for (int i = 0; i < WORLDS; i++) {
+            total += rewards[i];
+            if (dones[i] & SAILENV_DONE_ARRIVED) (*arrivals)++;
+        }
+    }
+    
+    free(actions);
+    free(rewards);
+    free(dones);
+    SailEnvDestroy(env);
+    return total;
+}
+
+int main(void) {
+    static float serial[WORLDS * SAILENV_OBSERVATION_SIZE], threaded[WORLDS * SAILENV_OBSERVATION_SIZE];
+    int serialArrivals, threadedArrivals;
+    double serialTotal = Run(1, serial, &serialArrivals);
+    double threadedTotal = Run(3, threaded, &threadedArrivals);
+    
+    int finite = 1;
+    for (int i = 0; i < WORLDS * SAILENV_OBSERVATION_SIZE; i++) finite = finite && isfinite(serial[i]);
+    Check(finite, "observations are finite");
+    Check(serialArrivals > 0, "some worlds reach their waypoint");
+    Check(serialTotal == threadedTotal && serialArrivals == threadedArrivals, "same rewards on any thread count");
+    Check(memcmp(serial, threaded, sizeof(serial)) == 0, "same observations on any thread count");
+    
+    /* Every world starts from its own draw */
+    SailEnvConfig config;
+    SailEnvDefaultConfig(&config);
+    config.worldCount = 2;
+    config.threadCount = 1;
+    SailEnv* env = SailEnvCreate(&config);
+    float first[2 * SAILENV_OBSERVATION_SIZE];
+    SailEnvReset(env, first);
+    Check(memcmp(first, first + SAILENV_OBSERVATION_SIZE, sizeof(float) * SAILENV_OBSERVATION_SIZE) != 0,
+          "worlds start differently");
+    SailEnvDestroy(env);
+    
+    Check(SailEnvCreate(NULL) == NULL, "null config rejected");
+    
+    printf("reward %.1f, arrivals %d\n", serialTotal, serialArrivals);
+    if (failures == 0) printf("sailenv_test: ok\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,178 @@
+#include "tracklog.h"
+#include "physics.h"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+const char* const TRACK_FIELD_NAMES[TRACK_FIELD_COUNT] = {
+    "time", "x", "y", "vx", "vy", "heading", "heel", "sailAngle", "sailAngularVel",
+    "apparentWindSpeed", "apparentWindAngle", "vmg", "rudder", "sheet", "flags"
+};
+
+// 0.1 ms, mm, mm/s, 0.1 mrad and so on: finer than anything the simulation resolves per tick
+const float TRACK_FIELD_SCALES[TRACK_FIELD_COUNT] = {
+    1e4f, 1e3f, 1e3f, 1e3f, 1e3f, 1e4f, 1e4f, 1e4f, 1e3f, 1e3f, 1e4f, 1e3f, 1e4f, 1e4f, 1.0f
+};
+
+const int TRACKLOG_IDLE_MS = 2;
+
+void QuantizeTrackRecord(const TrackRecord& record, long long values[TRACK_FIELD_COUNT]) {
+    const float fields[TRACK_FIELD_COUNT - 2] = {record.x, record.y, record.vx, record.vy, record.heading,
+        record.heel, record.sailAngle, record.sailAngularVel, record.apparentWindSpeed, record.apparentWindAngle,
+        record.vmg, record.rudder, record.sheet};
+    values[TRACK_TIME] = llround(record.time * TRACK_FIELD_SCALES[TRACK_TIME]);
+    for (int f = TRACK_X; f < TRACK_FLAGS; f++) values[f] = llroundf(fields[f - 1] * TRACK_FIELD_SCALES[f]);
+    values[TRACK_FLAGS] = record.flags;
+}
+
+void DequantizeTrackRecord(const long long values[TRACK_FIELD_COUNT], TrackRecord& record) {
+    float fields[TRACK_FIELD_COUNT - 2];
+    for (int f = TRACK_X; f < TRACK_FLAGS; f++) fields[f - 1] = values[f] / TRACK_FIELD_SCALES[f];
+    record.time = values[TRACK_TIME] / (double)TRACK_FIELD_SCALES[TRACK_TIME];
+    record.x = fields[0];
+    record.y = fields[1];
+    record.vx = fields[2];
+    record.vy = fields[3];
+    record.heading = fields[4];
+    record.heel = fields[5];
+    record.sailAngle = fields[6];
+    record.sailAngularVel = fields[7];
+    record.apparentWindSpeed = fields[8];
+    record.apparentWindAngle = fields[9];
+    record.vmg = fields[10];
+    record.rudder = fields[11];
+    record.sheet = fields[12];
+    record.flags = (unsigned int)values[TRACK_FLAGS];
+}
+
+void FillTrackRecord(TrackRecord& record, const Boat& boat, const Wind& wind, const Waypoint& waypoint,
+                     double time, unsigned int flags) {
+    Vector2D apparent = GetApparentWind(wind, boat.vx, boat.vy);
+    record.time = time;
+    record.x = boat.x;
+    record.y = boat.y;
+    record.vx = boat.vx;
+    record.vy = boat.vy;
+    record.heading = boat.heading;
+    record.heel = boat.heel;
+    record.sailAngle = boat.sailAngle;
+    record.sailAngularVel = boat.sailAngularVel;
+    record.apparentWindSpeed = apparent.magnitude();
+    record.apparentWindAngle = NormalizeAngle(atan2f(-apparent.x, -apparent.y) - (boat.heading + M_PI));
+    record.vmg = waypoint.active ? CalculateVMG(boat, waypoint) : 0.0f;
+    record.rudder = boat.rudder;
+    record.sheet = boat.sheet;
+    record.flags = flags;
+}
+
+static void PutVarint(std::vector<unsigned char>& out, long long value) {
+    unsigned long long zigzag = ((unsigned long long)value << 1) ^ (unsigned long long)(value >> 63);
+    while (zigzag >= 0x80) {
+        out.push_back((unsigned char)(zigzag | 0x80));
+        zigzag >>= 7;
+    }
+    out.push_back((unsigned char)zigzag);
+}
+
+static void FlushChunk(TrackLog& log) {
+    if (log.chunkHeader.recordCount == 0) return;
+    log.chunkHeader.payloadBytes = (unsigned int)log.chunk.size();
+    TrackIndexEntry entry = {log.chunkHeader.firstTime, log.chunkHeader.lastTime, log.offset,
+                             log.chunkHeader.recordCount, 0};
+    log.index.push_back(entry);
+    log.offset += sizeof(log.chunkHeader) + log.chunk.size();
+    
+    if (fwrite(&log.chunkHeader, sizeof(log.chunkHeader), 1, log.file) != 1 ||
+        fwrite(log.chunk.data(), 1, log.chunk.size(), log.file) != log.chunk.size()) {
+        log.failed = true;
+    }
+    log.chunk.clear();
+    log.chunkHeader.recordCount = 0;
+}
+
+static void EncodeRecord(TrackLog& log, const TrackRecord& record) {
+    if (log.chunkHeader.recordCount > 0 &&
+        (record.time - log.chunkHeader.firstTime >= TRACKLOG_CHUNK_SECONDS ||
+         (int)log.chunk.size() + TRACKLOG_MAX_RECORD_BYTES > TRACKLOG_MAX_CHUNK_BYTES)) {
+        FlushChunk(log);
+    }
+    if (log.chunkHeader.recordCount == 0) {
+        memset(log.previous, 0, sizeof(log.previous));
+        log.chunkHeader.firstTime = record.time;
+    }
+    
+    long long values[TRACK_FIELD_COUNT];
+    QuantizeTrackRecord(record, values);
+    for (int f = 0; f < TRACK_FIELD_COUNT; f++) {
+        PutVarint(log.chunk, values[f] - log.previous[f]);
+        log.previous[f] = values[f];
+    }
+    log.chunkHeader.lastTime = record.time;
+    log.chunkHeader.recordCount++;
+}
+
+static void WriterLoop(TrackLog* log) {
+    for (;;) {
+        // Read stopping first: once it's set, everything pushed before it is visible below
+        bool stopping = log->stopping.load(std::memory_order_acquire);
+        unsigned int tail = log->tail.load(std::memory_order_relaxed);
+        unsigned int head = log->head.load(std::memory_order_acquire);
+    
+        for (; tail != head; tail++) EncodeRecord(*log, log->ring[tail & (TRACKLOG_RING_SIZE - 1)]);
+        log->tail.store(tail, std::memory_order_release);
+    
+        if (stopping) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(TRACKLOG_IDLE_MS));
+    }
+    FlushChunk(*log);
+    
+    TrackLogFooter footer = {log->offset, (unsigned int)log->index.size(), {'T', 'I', 'D', 'X'}};
+    if (fwrite(log->index.data(), sizeof(TrackIndexEntry), log->index.size(), log->file) != log->index.size() ||
+        fwrite(&footer, sizeof(footer), 1, log->file) != 1) {
+        log->failed = true;
+    }
+}
+
+bool OpenTrackLog(TrackLog& log, const char* path) {
+    log.file = fopen(path, "wb");
+    if (!log.file) return false;
+    
+    unsigned int header[4] = {0, TRACKLOG_VERSION, TRACK_FIELD_COUNT, 0};
+    memcpy(header, "TLOG", 4);
+    fwrite(header, sizeof(header), 1, log.file);
+    fwrite(TRACK_FIELD_SCALES, sizeof(TRACK_FIELD_SCALES), 1, log.file);
+    
+    log.head.store(0, std::memory_order_relaxed);
+    log.tail.store(0, std::memory_order_relaxed);
+    log.stopping.store(false, std::memory_order_relaxed);
+    log.dropped = 0;
+    log.chunk.clear();
+    log.chunk.reserve(TRACKLOG_MAX_CHUNK_BYTES);
+    memset(&log.chunkHeader, 0, sizeof(log.chunkHeader));
+    memcpy(log.chunkHeader.magic, "TCHK", 4);
+    log.index.clear();
+    log.offset = TRACKLOG_HEADER_BYTES;
+    log.failed = ferror(log.file) != 0;
+    log.writer = std::thread(WriterLoop, &log);
+    return true;
+}
+
+bool LogTrackRecord(TrackLog& log, const TrackRecord& record) {
+    unsigned int head = log.head.load(std::memory_order_relaxed);
+    if (head - log.tail.load(std::memory_order_acquire) == TRACKLOG_RING_SIZE) {
+        log.dropped++;
+        return false;
+    }
+    log.ring[head & (TRACKLOG_RING_SIZE - 1)] = record;
+    log.head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+bool CloseTrackLog(TrackLog& log) {
+    log.stopping.store(true, std::memory_order_release);
+    log.writer.join();
+    bool ok = !log.failed && !ferror(log.file);
+    ok = fclose(log.file) == 0 && ok;
+    log.file = nullptr;
+    return ok;
+}
@@ -0,0 +1,118 @@
+#ifndef TRACKLOG_H
+#define TRACKLOG_H
+
+#include "types.h"
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+// Full-rate session log. The simulation hands records to a writer thread through a
+// single-producer single-consumer ring and never waits on it: when the ring is full the
+// record is dropped and counted.
+//
+// File layout, little-endian:
+//   header: "TLOG", u32 version, u32 field count, u32 0, then f32 scale per field
+//   chunks: TrackChunkHeader, then the records as zigzag varints, one per field, each the
+//           difference from the previous record in quantized units (value * scale, rounded).
+//           A chunk's first record is a keyframe: the difference from zero.
+//   footer: TrackIndexEntry per chunk, then TrackLogFooter. Written on close, so a session
+//           that died without one can still be read by walking the chunk headers.
+
+enum TrackField {
+    TRACK_TIME,
+    TRACK_X,
+    TRACK_Y,
+    TRACK_VX,
+    TRACK_VY,
+    TRACK_HEADING,
+    TRACK_HEEL,
+    TRACK_SAIL_ANGLE,
+    TRACK_SAIL_ANGULAR_VEL,
+    TRACK_APPARENT_WIND_SPEED,
+    TRACK_APPARENT_WIND_ANGLE,
+    TRACK_VMG,
+    TRACK_RUDDER,
+    TRACK_SHEET,
+    TRACK_FLAGS,
+    TRACK_FIELD_COUNT
+};
+
+extern const char* const TRACK_FIELD_NAMES[TRACK_FIELD_COUNT];
+extern const float TRACK_FIELD_SCALES[TRACK_FIELD_COUNT];   // quantization steps per unit
+
+enum TrackFlag {
+    TRACK_FLAG_AUTOPILOT = 1,
+    TRACK_FLAG_COURSE_HOLD = 2,
+    TRACK_FLAG_CONTROL_INPUT = 4
+};
+
+struct TrackRecord {
+    double time;
+    float x, y;
+    float vx, vy;
+    float heading, heel;
+    float sailAngle, sailAngularVel;
+    float apparentWindSpeed, apparentWindAngle;   // angle off the bow, radians
+    float vmg;                                    // towards the current waypoint
+    float rudder, sheet;
+    unsigned int flags;
+};
+
+struct TrackChunkHeader {
+    char magic[4];              // "TCHK"
+    unsigned int recordCount;
+    unsigned int payloadBytes;
+    unsigned int reserved;
+    double firstTime, lastTime;
+};
+
+struct TrackIndexEntry {
+    double firstTime, lastTime;
+    unsigned long long offset;  // of the chunk header, from the start of the file
+    unsigned int recordCount;
+    unsigned int reserved;
+};
+
+struct TrackLogFooter {
+    unsigned long long indexOffset;
+    unsigned int entryCount;
+    char magic[4];              // "TIDX"
+};
+
+const unsigned int TRACKLOG_VERSION = 2;
+const int TRACKLOG_HEADER_BYTES = 16 + TRACK_FIELD_COUNT * 4;
+const int TRACKLOG_RING_SIZE = 1 << 14;            // records; a power of two, ~4.5 minutes at 60 Hz
+const float TRACKLOG_CHUNK_SECONDS = 10.0f;
+const int TRACKLOG_MAX_CHUNK_BYTES = 1 << 20;
+const int TRACKLOG_MAX_RECORD_BYTES = TRACK_FIELD_COUNT * 10;
+
+struct TrackLog {
+    TrackRecord ring[TRACKLOG_RING_SIZE];
+    alignas(64) std::atomic<unsigned int> head;   // next slot the simulation fills
+    alignas(64) std::atomic<unsigned int> tail;   // next slot the writer drains
+    alignas(64) unsigned long long dropped;       // simulation side only
+    std::atomic<bool> stopping;
+    
+    // Writer thread only
+    std::thread writer;
+    FILE* file;
+    std::vector<unsigned char> chunk;
+    TrackChunkHeader chunkHeader;
+    long long previous[TRACK_FIELD_COUNT];
+    std::vector<TrackIndexEntry> index;
+    unsigned long long offset;
+    bool failed;
+};
+
+void QuantizeTrackRecord(const TrackRecord& record, long long values[TRACK_FIELD_COUNT]);
+void DequantizeTrackRecord(const long long values[TRACK_FIELD_COUNT], TrackRecord& record);
+void FillTrackRecord(TrackRecord& record, const Boat& boat, const Wind& wind, const Waypoint& waypoint,
+                     double time, unsigned int flags);
+
+// The log is large; give it static storage
+bool OpenTrackLog(TrackLog& log, const char* path);
+bool LogTrackRecord(TrackLog& log, const TrackRecord& record);   // false if the ring was full
+bool CloseTrackLog(TrackLog& log);                               // drains the ring; false on a write error
+
+#endif
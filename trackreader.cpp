@@ -0,0 +1,239 @@
+#include "trackreader.h"
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static bool ReadVarint(const unsigned char*& p, const unsigned char* end, long long& value) {
+    unsigned long long zigzag = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        unsigned char byte = *p++;
+        zigzag |= (unsigned long long)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            value = (long long)(zigzag >> 1) ^ -(long long)(zigzag & 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+// A chunk header at `offset` whose payload ends by `limit`, with at least a byte per field per record
+static bool ReadChunkHeader(const TrackReader& reader, unsigned long long offset, unsigned long long limit,
+                            TrackChunkHeader& header) {
+    if (offset < (unsigned long long)TRACKLOG_HEADER_BYTES || limit > reader.size ||
+        offset > limit || limit - offset < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, reader.data + offset, sizeof(header));
+    return memcmp(header.magic, "TCHK", 4) == 0 && header.payloadBytes <= limit - offset - sizeof(header) &&
+           (unsigned long long)header.recordCount * TRACK_FIELD_COUNT <= header.payloadBytes;
+}
+
+static bool LoadFooterIndex(TrackReader& reader) {
+    TrackLogFooter footer;
+    if (reader.size < TRACKLOG_HEADER_BYTES + sizeof(footer)) return false;
+    memcpy(&footer, reader.data + reader.size - sizeof(footer), sizeof(footer));
+    if (memcmp(footer.magic, "TIDX", 4) != 0) return false;
+    
+    unsigned long long indexBytes = (unsigned long long)footer.entryCount * sizeof(TrackIndexEntry);
+    if (footer.indexOffset < (unsigned long long)TRACKLOG_HEADER_BYTES ||
+        footer.indexOffset + indexBytes + sizeof(footer) != reader.size) {
+        return false;
+    }
+    reader.index.resize(footer.entryCount);
+    memcpy(reader.index.data(), reader.data + footer.indexOffset, indexBytes);
+    
+    // Entries are trusted from here on, so a footer that disagrees with the chunks is thrown away
+    unsigned long long chunkEnd = TRACKLOG_HEADER_BYTES;
+    for (const TrackIndexEntry& entry : reader.index) {
+        TrackChunkHeader header;
+        if (entry.offset < chunkEnd || !ReadChunkHeader(reader, entry.offset, footer.indexOffset, header) ||
+            header.recordCount != entry.recordCount) {
+            reader.index.clear();
+            return false;
+        }
+        chunkEnd = entry.offset + sizeof(header) + header.payloadBytes;
+    }
+    return true;
+}
+
+// No footer: the writer didn't close. Every complete chunk before the damage is still good.
+static void WalkChunks(TrackReader& reader) {
+    reader.index.clear();
+    size_t offset = TRACKLOG_HEADER_BYTES;
+    TrackChunkHeader header;
+    while (ReadChunkHeader(reader, offset, reader.size, header)) {
+        TrackIndexEntry entry = {header.firstTime, header.lastTime, offset, header.recordCount, 0};
+        reader.index.push_back(entry);
+        offset += sizeof(header) + header.payloadBytes;
+    }
+}
+
+bool OpenTrackReader(TrackReader& reader, const char* path) {
+    reader.data = nullptr;
+    reader.size = 0;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    
+    struct stat info;
+    void* mapping = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size >= TRACKLOG_HEADER_BYTES) {
+        mapping = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (mapping == MAP_FAILED) return false;
+    reader.data = (const unsigned char*)mapping;
+    reader.size = (size_t)info.st_size;
+    
+    // Quantization is fixed by the format; a log with other fields or scales is another format
+    unsigned int header[4];
+    memcpy(header, reader.data, sizeof(header));
+    bool ok = memcmp(header, "TLOG", 4) == 0 && header[1] >= 1 && header[1] <= TRACKLOG_VERSION &&
+              header[2] == TRACK_FIELD_COUNT &&
+              memcmp(reader.data + 16, TRACK_FIELD_SCALES, sizeof(TRACK_FIELD_SCALES)) == 0;
+    if (!ok) {
+        CloseTrackReader(reader);
+        return false;
+    }
+    
+    reader.indexed = LoadFooterIndex(reader);
+    if (!reader.indexed) WalkChunks(reader);
+    reader.recordCount = 0;
+    for (const TrackIndexEntry& entry : reader.index) reader.recordCount += entry.recordCount;
+    return true;
+}
+
+void CloseTrackReader(TrackReader& reader) {
+    if (reader.data) munmap((void*)reader.data, reader.size);
+    reader.data = nullptr;
+    reader.size = 0;
+    reader.index.clear();
+}
+
+double GetTrackStartTime(const TrackReader& reader) {
+    return reader.index.empty() ? 0.0 : reader.index.front().firstTime;
+}
+
+double GetTrackEndTime(const TrackReader& reader) {
+    return reader.index.empty() ? 0.0 : reader.index.back().lastTime;
+}
+
+int FindTrackChunk(const TrackReader& reader, double time) {
+    int low = 0, high = (int)reader.index.size() - 1;
+    while (low < high) {
+        int mid = (low + high + 1) / 2;
+        if (reader.index[mid].firstTime <= time) low = mid;
+        else high = mid - 1;
+    }
+    return low;
+}
+
+static bool EnterChunk(TrackCursor& cursor, int chunk) {
+    const TrackReader& reader = *cursor.reader;
+    if (chunk < 0 || chunk >= (int)reader.index.size()) return false;
+    
+    const TrackIndexEntry& entry = reader.index[chunk];
+    TrackChunkHeader header;
+    if (!ReadChunkHeader(reader, entry.offset, reader.size, header)) return false;
+    cursor.chunk = chunk;
+    cursor.next = reader.data + entry.offset + sizeof(header);
+    cursor.end = cursor.next + header.payloadBytes;
+    cursor.remaining = header.recordCount;
+    memset(cursor.values, 0, sizeof(cursor.values));   // the keyframe is relative to zero
+    return true;
+}
+
+static bool DecodeNext(TrackCursor& cursor) {
+    while (cursor.remaining == 0) {
+        if (cursor.singleChunk || !EnterChunk(cursor, cursor.chunk + 1)) return false;
+    }
+    for (int f = 0; f < TRACK_FIELD_COUNT; f++) {
+        long long delta;
+        if (!ReadVarint(cursor.next, cursor.end, delta)) {
+            cursor.remaining = 0;
+            cursor.singleChunk = true;   // corrupt payload: stop here rather than guess
+            return false;
+        }
+        cursor.values[f] += delta;
+    }
+    cursor.remaining--;
+    return true;
+}
+
+bool SeekTrack(const TrackReader& reader, double from, double to, TrackCursor& cursor) {
+    cursor.reader = &reader;
+    cursor.endTime = to;
+    cursor.singleChunk = false;
+    cursor.remaining = 0;
+    cursor.chunk = (int)reader.index.size();
+    if (reader.index.empty() || !EnterChunk(cursor, FindTrackChunk(reader, from))) return false;
+    
+    // Decode up to the first record at or after `from`, then step back so Next returns it
+    for (;;) {
+        const unsigned char* next = cursor.next;
+        unsigned int remaining = cursor.remaining;
+        int chunk = cursor.chunk;
+        long long values[TRACK_FIELD_COUNT];
+        memcpy(values, cursor.values, sizeof(values));
+        if (!DecodeNext(cursor)) return false;
+        if (cursor.values[TRACK_TIME] / (double)TRACK_FIELD_SCALES[TRACK_TIME] >= from) {
+            if (cursor.chunk != chunk) EnterChunk(cursor, cursor.chunk);
+            else {
+                cursor.next = next;
+                cursor.remaining = remaining;
+                memcpy(cursor.values, values, sizeof(values));
+            }
+            return true;
+        }
+    }
+}
+
+bool OpenTrackChunk(const TrackReader& reader, int chunk, TrackCursor& cursor) {
+    cursor.reader = &reader;
+    cursor.endTime = INFINITY;
+    cursor.singleChunk = true;
+    return EnterChunk(cursor, chunk);
+}
+
+bool NextTrackRecord(TrackCursor& cursor, TrackRecord& record) {
+    if (!DecodeNext(cursor)) return false;
+    DequantizeTrackRecord(cursor.values, record);
+    if (record.time > cursor.endTime) {
+        cursor.remaining = 0;
+        cursor.singleChunk = true;
+        return false;
+    }
+    return true;
+}
+
+struct ChunkScan {
+    const TrackReader* reader;
+    int firstChunk;
+    TrackChunkFunc func;
+    void* context;
+};
+
+static void ScanJob(void* context, int index) {
+    ChunkScan& scan = *(ChunkScan*)context;
+    scan.func(scan.context, *scan.reader, scan.firstChunk + index);
+}
+
+void ScanTrackChunks(const TrackReader& reader, JobPool& pool, double from, double to,
+                     TrackChunkFunc func, void* context) {
+    if (reader.index.empty()) return;
+    int first = FindTrackChunk(reader, from);
+    if (reader.index[first].lastTime < from) first++;
+    int last = FindTrackChunk(reader, to);
+    if (first > last) return;
+    
+    // Every page of the range is about to be touched; start reading it in while the pool spins up
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t begin = reader.index[first].offset / page * page;
+    size_t end = last + 1 < (int)reader.index.size() ? reader.index[last + 1].offset : reader.size;
+    madvise((void*)(reader.data + begin), end - begin, MADV_WILLNEED);
+    
+    ChunkScan scan = {&reader, first, func, context};
+    RunJobsStealing(pool, ScanJob, &scan, last - first + 1);
+}
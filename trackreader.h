@@ -0,0 +1,50 @@
+#ifndef TRACKREADER_H
+#define TRACKREADER_H
+
+#include "tracklog.h"
+#include "jobs.h"
+#include <cstddef>
+#include <vector>
+
+// Reads a track log in place through a read-only mapping: opening costs the footer index,
+// not the file. Records are decoded straight out of the mapping as a cursor walks them.
+struct TrackReader {
+    const unsigned char* data;
+    size_t size;
+    std::vector<TrackIndexEntry> index;   // one keyframe per chunk, in time order
+    long long recordCount;
+    bool indexed;                         // false when the footer was missing and the chunks were walked
+};
+
+struct TrackCursor {
+    const TrackReader* reader;
+    int chunk;
+    const unsigned char* next;
+    const unsigned char* end;             // of the current chunk's payload
+    unsigned int remaining;               // records left in the current chunk
+    long long values[TRACK_FIELD_COUNT];  // last decoded record, quantized
+    double endTime;                       // stop after this time
+    bool singleChunk;
+};
+
+bool OpenTrackReader(TrackReader& reader, const char* path);
+void CloseTrackReader(TrackReader& reader);
+double GetTrackStartTime(const TrackReader& reader);
+double GetTrackEndTime(const TrackReader& reader);
+
+// Last chunk starting at or before `time`, by binary search over the index; 0 before the start
+int FindTrackChunk(const TrackReader& reader, double time);
+
+// Records with from <= time <= to, in order. Seeking decodes at most one chunk up to `from`.
+bool SeekTrack(const TrackReader& reader, double from, double to, TrackCursor& cursor);
+// Just one chunk, for scans that split the log between threads
+bool OpenTrackChunk(const TrackReader& reader, int chunk, TrackCursor& cursor);
+bool NextTrackRecord(TrackCursor& cursor, TrackRecord& record);
+
+// Calls func once per chunk overlapping [from, to], chunks spread over the pool; each call
+// opens its own cursor with OpenTrackChunk
+typedef void (*TrackChunkFunc)(void* context, const TrackReader& reader, int chunk);
+void ScanTrackChunks(const TrackReader& reader, JobPool& pool, double from, double to,
+                     TrackChunkFunc func, void* context);
+
+#endif
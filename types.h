@@ -29,6 +29,7 @@ struct Boat {
     float length;
     float sailAngle;         // ADD: actual current sail angle
     float sailAngularVel;    // ADD: how fast sail is rotating
+    int boatClass;           // index into the boat class table, see physics.h
 };
 
 struct Wind {
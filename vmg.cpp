@@ -0,0 +1,108 @@
+#include "vmg.h"
+#include "polar.h"
+#include "physics.h"
+#include <cmath>
+
+const float GOLDEN_RATIO = 0.618034f;
+
+typedef float (*GoldenObjective)(void* context, float x);
+
+// Maximum of a unimodal function on [a, b]; returns its argument. Only used once the peak is bracketed.
+static float GoldenSection(GoldenObjective f, void* context, float a, float b, float& best) {
+    float x1 = b - GOLDEN_RATIO * (b - a);
+    float x2 = a + GOLDEN_RATIO * (b - a);
+    float f1 = f(context, x1), f2 = f(context, x2);
+    for (int i = 0; i < VMG_GOLDEN_ITERATIONS; i++) {
+        if (f1 < f2) {
+            a = x1;
+            x1 = x2; f1 = f2;
+            x2 = a + GOLDEN_RATIO * (b - a);
+            f2 = f(context, x2);
+        } else {
+            b = x2;
+            x2 = x1; f2 = f1;
+            x1 = b - GOLDEN_RATIO * (b - a);
+            f1 = f(context, x1);
+        }
+    }
+    if (f1 > f2) { best = f1; return x1; }
+    best = f2;
+    return x2;
+}
+
+// Steady speed at the sheet with the most drive in [sheetMin, sheetMax]
+float SolveBestSheet(float windSpeed, float twa, float sheetMin, float sheetMax, float& sheet) {
+    return SolveBestSpeed(GetBoatCoefficients(BOAT_CLASS_DINGHY), windSpeed, twa, sheet, sheetMin, sheetMax);
+}
+
+struct AngleSearch {
+    float windSpeed, bearing, sheetMin, sheetMax;
+};
+
+static float AngleVMG(void* context, float twa) {
+    const AngleSearch& search = *(const AngleSearch*)context;
+    float sheet;
+    return SolveBestSheet(search.windSpeed, twa, search.sheetMin, search.sheetMax, sheet) * cosf(twa - search.bearing);
+}
+
+// relativeBearing is the direction to make good measured from the wind direction. Inside the
+// no-go zone VMG is flat at zero, so a coarse scan brackets the peak before the golden search.
+VMGTarget SolveVMGTarget(float windSpeed, float relativeBearing, float sheetMin, float sheetMax) {
+    AngleSearch search = {windSpeed, fabsf(NormalizeAngle(relativeBearing)), sheetMin, sheetMax};
+    
+    float bracket = 0.0f, bracketVMG = -INFINITY;
+    for (float twa = 0.0f; twa <= M_PI + 0.001f; twa += VMG_BRACKET_STEP) {
+        float vmg = AngleVMG(&search, twa);
+        if (vmg > bracketVMG) {
+            bracketVMG = vmg;
+            bracket = twa;
+        }
+    }
+    
+    VMGTarget target;
+    float low = fmaxf(bracket - VMG_BRACKET_STEP, 0.0f);
+    float high = fminf(bracket + VMG_BRACKET_STEP, M_PI);
+    target.twa = GoldenSection(AngleVMG, &search, low, high, target.vmg);
+    if (bracketVMG > target.vmg) {
+        target.twa = bracket;   // peak at the end of the range, e.g. a dead run
+        target.vmg = bracketVMG;
+    }
+    target.speed = SolveBestSheet(windSpeed, target.twa, sheetMin, sheetMax, target.sheet);
+    return target;
+}
+
+void InitVMGCache(VMGCache& cache, float sheetMin, float sheetMax) {
+    cache.sheetMin = sheetMin;
+    cache.sheetMax = sheetMax;
+    for (int i = 0; i < VMG_CACHE_BINS; i++) cache.valid[i] = false;
+}
+
+static int CacheBin(VMGCache& cache, float windSpeed) {
+    int bin = (int)roundf(windSpeed / VMG_CACHE_STEP);
+    if (bin < 0) bin = 0;
+    if (bin >= VMG_CACHE_BINS) bin = VMG_CACHE_BINS - 1;
+    if (!cache.valid[bin]) {
+        float speed = bin * VMG_CACHE_STEP;
+        cache.upwind[bin] = SolveVMGTarget(speed, 0.0f, cache.sheetMin, cache.sheetMax);
+        cache.downwind[bin] = SolveVMGTarget(speed, M_PI, cache.sheetMin, cache.sheetMax);
+        cache.valid[bin] = true;
+    }
+    return bin;
+}
+
+static void FillBinJob(void* context, int bin) {
+    CacheBin(*(VMGCache*)context, bin * VMG_CACHE_STEP);
+}
+
+// Bins are independent, so they are spread over the pool
+void FillVMGCache(VMGCache& cache, JobPool& pool) {
+    RunJobs(pool, FillBinJob, &cache, VMG_CACHE_BINS);
+}
+
+const VMGTarget& GetUpwindTarget(VMGCache& cache, float windSpeed) {
+    return cache.upwind[CacheBin(cache, windSpeed)];
+}
+
+const VMGTarget& GetDownwindTarget(VMGCache& cache, float windSpeed) {
+    return cache.downwind[CacheBin(cache, windSpeed)];
+}
@@ -0,0 +1,35 @@
+#ifndef VMG_H
+#define VMG_H
+
+#include "types.h"
+#include "jobs.h"
+
+const float VMG_CACHE_STEP = 0.25f;          // m/s per cached wind speed
+const int VMG_CACHE_BINS = 121;              // 0..30 m/s
+const int VMG_GOLDEN_ITERATIONS = 16;         // shrinks the interval to 0.05% of its width
+const float VMG_BRACKET_STEP = 10.0f * (float)M_PI / 180.0f;
+
+// Best angle to sail for a given true wind, with the steady-state speed and sheet there
+struct VMGTarget {
+    float twa;       // true wind angle, same on either tack
+    float speed;
+    float sheet;
+    float vmg;       // along the bearing the target was solved for
+};
+
+// Targets straight upwind and downwind, solved on first use per wind speed bin
+struct VMGCache {
+    float sheetMin, sheetMax;
+    bool valid[VMG_CACHE_BINS];
+    VMGTarget upwind[VMG_CACHE_BINS];
+    VMGTarget downwind[VMG_CACHE_BINS];
+};
+
+float SolveBestSheet(float windSpeed, float twa, float sheetMin, float sheetMax, float& sheet);
+VMGTarget SolveVMGTarget(float windSpeed, float relativeBearing, float sheetMin, float sheetMax);
+void InitVMGCache(VMGCache& cache, float sheetMin, float sheetMax);
+void FillVMGCache(VMGCache& cache, JobPool& pool);   // solves every bin now, so threads can share the cache read-only
+const VMGTarget& GetUpwindTarget(VMGCache& cache, float windSpeed);
+const VMGTarget& GetDownwindTarget(VMGCache& cache, float windSpeed);
+
+#endif
@@ -1,10 +1,10 @@
 #include "wind.h"
-#include "physics.h"
 #include <raylib.h>
 #include <cmath>
 
-void UpdateWindParticles(WindParticle particles[], const Boat& boat, const Wind& wind, float dt) {
-    Vector2D trueWind = GetWindVector(wind);
+void UpdateWindParticles(WindParticle particles[], const Boat& boat, const WindField& field, float time, float dt) {
+    static float posX[MAX_PARTICLES], posY[MAX_PARTICLES];
+    static float windX[MAX_PARTICLES], windY[MAX_PARTICLES];
     
     for (int i = 0; i < MAX_PARTICLES; i++) {
         if (particles[i].lifetime <= 0) {
@@ -32,6 +32,15 @@ void UpdateWindParticles(WindParticle particles[], const Boat& boat, const Wind&
             }
         }
         
+        posX[i] = particles[i].x;
+        posY[i] = particles[i].y;
+    }
+    
+    // One batched query for the whole particle set instead of a lookup per particle
+    SampleWindFieldBatch(field, posX, posY, MAX_PARTICLES, time, windX, windY);
+    
+    for (int i = 0; i < MAX_PARTICLES; i++) {
+        Vector2D trueWind(windX[i], windY[i]);
         particles[i].x += trueWind.x * dt;
         particles[i].y += trueWind.y * dt;
         
@@ -2,9 +2,10 @@
 #define WIND_H
 
 #include "types.h"
+#include "windfield.h"
 
 const int MAX_PARTICLES = 400;
 
-void UpdateWindParticles(WindParticle particles[], const Boat& boat, const Wind& wind, float dt);
+void UpdateWindParticles(WindParticle particles[], const Boat& boat, const WindField& field, float time, float dt);
 
 #endif
\ No newline at end of file
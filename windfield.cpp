@@ -0,0 +1,313 @@
+#include "windfield.h"
+#include "physics.h"
+#include <cmath>
+#include <cstdlib>
+
+void InitWindField(WindField& field, const Wind& wind, float cellSize) {
+    field.cellSize = cellSize;
+    field.keyframeCount = 1;
+    field.keyTimes[0] = 0.0f;
+    field.baseWind[0] = GetWindVector(wind);
+    field.period = 0.0f;
+    field.generator = nullptr;
+    field.generatorUser = nullptr;
+    field.gusts = nullptr;
+    field.gustAnchor = Vector2D(0.0f, 0.0f);
+    field.gustAnchorTime = 0.0f;
+    for (int b = 0; b < WIND_TILE_BUCKETS; b++) field.buckets[b] = nullptr;
+    field.tileCount = 0;
+    field.tick = 0;
+}
+
+static void FreeWindTiles(WindField& field) {
+    for (int b = 0; b < WIND_TILE_BUCKETS; b++) {
+        WindTile* tile = field.buckets[b];
+        while (tile) {
+            WindTile* next = tile->next;
+            free(tile);
+            tile = next;
+        }
+        field.buckets[b] = nullptr;
+    }
+    field.tileCount = 0;
+}
+
+void FreeWindField(WindField& field) {
+    FreeWindTiles(field);
+}
+
+static void BakeTileKeyframe(const WindField& field, WindTile* tile, int k) {
+    float originX = tile->tx * WIND_TILE_SIZE * field.cellSize;
+    float originY = tile->ty * WIND_TILE_SIZE * field.cellSize;
+    for (int j = 0; j < WIND_TILE_POINTS; j++) {
+        for (int i = 0; i < WIND_TILE_POINTS; i++) {
+            tile->samples[k][j * WIND_TILE_POINTS + i] = field.generator(field.generatorUser,
+                originX + i * field.cellSize, originY + j * field.cellSize, field.keyTimes[k]);
+        }
+    }
+}
+
+// Keyframes must be set in increasing time order. Baked tiles re-bake just this keyframe,
+// so samples taken straight after a revision still see the local wind everywhere else.
+void SetWindFieldKeyframe(WindField& field, int index, float time, const Wind& baseWind) {
+    if (index < 0 || index >= MAX_WIND_KEYFRAMES) return;
+    field.keyTimes[index] = time;
+    field.baseWind[index] = GetWindVector(baseWind);
+    if (index > field.keyframeCount) {
+        FreeWindTiles(field);   // keyframes skipped over have nothing baked
+    } else {
+        for (int b = 0; b < WIND_TILE_BUCKETS; b++) {
+            for (WindTile* tile = field.buckets[b]; tile; tile = tile->next) BakeTileKeyframe(field, tile, index);
+        }
+    }
+    if (index >= field.keyframeCount) field.keyframeCount = index + 1;
+}
+
+void SetWindFieldGenerator(WindField& field, WindFieldGenerator generator, void* user) {
+    field.generator = generator;
+    field.generatorUser = user;
+    FreeWindTiles(field);
+}
+
+// Gusts are sampled at query time rather than baked, so they can move independently of the tiles
+void SetWindFieldGusts(WindField& field, const GustModel* gusts) {
+    field.gusts = gusts;
+}
+
+Wind WindFromVector(const Vector2D& v) {
+    Wind wind;
+    wind.speed = v.magnitude();
+    wind.direction = atan2f(-v.x, -v.y);   // inverse of GetWindVector
+    return wind;
+}
+
+static void FindKeyframes(const WindField& field, float time, int& k0, int& k1, float& alpha) {
+    int last = field.keyframeCount - 1;
+    k0 = k1 = 0;
+    alpha = 0.0f;
+    if (last == 0) return;
+
+    float t = time;
+    if (field.period > 0.0f) {
+        t = fmodf(t, field.period);
+        if (t < 0.0f) t += field.period;
+    }
+
+    if (t < field.keyTimes[0]) {
+        if (field.period > 0.0f) {
+            // Wrapping from the last keyframe back to the first
+            float span = field.period - field.keyTimes[last] + field.keyTimes[0];
+            k0 = last;
+            k1 = 0;
+            alpha = (t + field.period - field.keyTimes[last]) / span;
+        }
+        return;
+    }
+
+    k0 = last;
+    for (int k = 0; k < last; k++) {
+        if (t < field.keyTimes[k + 1]) {
+            k0 = k;
+            break;
+        }
+    }
+    if (k0 < last) {
+        k1 = k0 + 1;
+        alpha = (t - field.keyTimes[k0]) / (field.keyTimes[k1] - field.keyTimes[k0]);
+    } else if (field.period > 0.0f) {
+        float span = field.period - field.keyTimes[last] + field.keyTimes[0];
+        k1 = 0;
+        alpha = (t - field.keyTimes[last]) / span;
+    } else {
+        k1 = k0;
+    }
+}
+
+static Vector2D GetBaseWind(const WindField& field, float time) {
+    int k0, k1;
+    float alpha;
+    FindKeyframes(field, time, k0, k1, alpha);
+    return field.baseWind[k0] + (field.baseWind[k1] - field.baseWind[k0]) * alpha;
+}
+
+// Integral of the base wind from 0 to `time` (0 <= time, within one period when looping).
+// The base wind is linear between keyframes, so a trapezoid per span is exact.
+static Vector2D IntegrateBaseWind(const WindField& field, float time) {
+    Vector2D offset(0.0f, 0.0f);
+    float from = 0.0f;
+    Vector2D fromWind = GetBaseWind(field, 0.0f);
+    for (int k = 0; k <= field.keyframeCount; k++) {
+        float to = k < field.keyframeCount ? fminf(field.keyTimes[k], time) : time;
+        if (to <= from) continue;
+        Vector2D toWind = GetBaseWind(field, to);
+        offset = offset + (fromWind + toWind) * (0.5f * (to - from));
+        from = to;
+        fromWind = toWind;
+    }
+    return offset;
+}
+
+static Vector2D IntegrateLoopedBaseWind(const WindField& field, float time) {
+    if (field.period <= 0.0f) return IntegrateBaseWind(field, time);
+    float cycles = floorf(time / field.period);
+    Vector2D offset = IntegrateBaseWind(field, time - cycles * field.period);
+    if (cycles != 0.0f) offset = offset + IntegrateBaseWind(field, field.period) * cycles;
+    return offset;
+}
+
+// Gusts are advected by the integrated base wind rather than base * time, which would make
+// the pattern's speed grow with the session whenever the keyframes change the wind
+Vector2D GetGustOffset(const WindField& field, float time) {
+    if (field.keyframeCount == 1) return field.gustAnchor + field.baseWind[0] * (time - field.gustAnchorTime);
+    return field.gustAnchor + IntegrateLoopedBaseWind(field, time) -
+           IntegrateLoopedBaseWind(field, field.gustAnchorTime);
+}
+
+void AnchorWindFieldGusts(WindField& field, float time) {
+    field.gustAnchor = GetGustOffset(field, time);
+    field.gustAnchorTime = time;
+}
+
+static unsigned int HashTile(int tx, int ty) {
+    return ((unsigned int)tx * 73856093u ^ (unsigned int)ty * 19349663u) & (WIND_TILE_BUCKETS - 1);
+}
+
+static WindTile* FindTile(const WindField& field, int tx, int ty) {
+    for (WindTile* tile = field.buckets[HashTile(tx, ty)]; tile; tile = tile->next) {
+        if (tile->tx == tx && tile->ty == ty) return tile;
+    }
+    return nullptr;
+}
+
+static WindTile* BakeTile(WindField& field, int tx, int ty) {
+    WindTile* tile = (WindTile*)malloc(sizeof(WindTile));
+    tile->tx = tx;
+    tile->ty = ty;
+    for (int k = 0; k < field.keyframeCount; k++) BakeTileKeyframe(field, tile, k);
+
+    unsigned int bucket = HashTile(tx, ty);
+    tile->next = field.buckets[bucket];
+    field.buckets[bucket] = tile;
+    field.tileCount++;
+    return tile;
+}
+
+static void EvictStaleTiles(WindField& field) {
+    for (int b = 0; b < WIND_TILE_BUCKETS; b++) {
+        WindTile** link = &field.buckets[b];
+        while (*link) {
+            WindTile* tile = *link;
+            if (field.tick - tile->lastTouched > WIND_TILE_EVICT_TICKS) {
+                *link = tile->next;
+                free(tile);
+                field.tileCount--;
+            } else {
+                link = &tile->next;
+            }
+        }
+    }
+}
+
+// Keeps the 3x3 tiles around every boat baked and frees the ones nobody has been near for a while
+void StreamWindFieldTiles(WindField& field, const Boat boats[], int count) {
+    if (!field.generator) return;
+    field.tick++;
+
+    float tileSpan = WIND_TILE_SIZE * field.cellSize;
+    int prevTx = 0, prevTy = 0;
+    bool havePrev = false;
+
+    for (int i = 0; i < count; i++) {
+        int tx = (int)floorf(boats[i].x / tileSpan);
+        int ty = (int)floorf(boats[i].y / tileSpan);
+        // Neighbouring boats usually share a tile, skip the repeat lookups
+        if (havePrev && tx == prevTx && ty == prevTy) continue;
+        prevTx = tx;
+        prevTy = ty;
+        havePrev = true;
+
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                WindTile* tile = FindTile(field, tx + dx, ty + dy);
+                if (!tile) tile = BakeTile(field, tx + dx, ty + dy);
+                tile->lastTouched = field.tick;
+            }
+        }
+    }
+
+    if (field.tick % 60 == 0) EvictStaleTiles(field);
+}
+
+static Vector2D SampleTile(const WindTile& tile, int k0, int k1, float alpha, float gx, float gy) {
+    int i = (int)gx;
+    int j = (int)gy;
+    if (i > WIND_TILE_SIZE - 1) i = WIND_TILE_SIZE - 1;
+    if (j > WIND_TILE_SIZE - 1) j = WIND_TILE_SIZE - 1;
+    float fx = gx - i;
+    float fy = gy - j;
+    int index = j * WIND_TILE_POINTS + i;
+
+    const Vector2D* a = tile.samples[k0];
+    const Vector2D* b = tile.samples[k1];
+    float w00 = (1.0f - fx) * (1.0f - fy), w10 = fx * (1.0f - fy);
+    float w01 = (1.0f - fx) * fy, w11 = fx * fy;
+
+    Vector2D va = a[index] * w00 + a[index + 1] * w10 + a[index + WIND_TILE_POINTS] * w01 + a[index + WIND_TILE_POINTS + 1] * w11;
+    if (k0 == k1) return va;
+    Vector2D vb = b[index] * w00 + b[index + 1] * w10 + b[index + WIND_TILE_POINTS] * w01 + b[index + WIND_TILE_POINTS + 1] * w11;
+    return va + (vb - va) * alpha;
+}
+
+Vector2D SampleWindField(const WindField& field, float x, float y, float time) {
+    float outX, outY;
+    SampleWindFieldBatch(field, &x, &y, 1, time, &outX, &outY);
+    return Vector2D(outX, outY);
+}
+
+void SampleWindFieldBatch(const WindField& field, const float xs[], const float ys[], int count, float time,
+                          float outX[], float outY[]) {
+    int k0, k1;
+    float alpha;
+    FindKeyframes(field, time, k0, k1, alpha);
+
+    Vector2D base = field.baseWind[k0] + (field.baseWind[k1] - field.baseWind[k0]) * alpha;
+    if (field.tileCount == 0) {
+        for (int i = 0; i < count; i++) {
+            outX[i] = base.x;
+            outY[i] = base.y;
+        }
+        if (field.gusts) ApplyGusts(*field.gusts, xs, ys, count, GetGustOffset(field, time), outX, outY);
+        return;
+    }
+
+    float invCell = 1.0f / field.cellSize;
+    const WindTile* tile = nullptr;
+    int tileX = 0, tileY = 0;
+    bool haveLookup = false;
+
+    for (int i = 0; i < count; i++) {
+        float gx = xs[i] * invCell;
+        float gy = ys[i] * invCell;
+        int tx = (int)floorf(gx / WIND_TILE_SIZE);
+        int ty = (int)floorf(gy / WIND_TILE_SIZE);
+
+        // Consecutive queries are usually close together, so reuse the last tile
+        if (!haveLookup || tx != tileX || ty != tileY) {
+            tile = FindTile(field, tx, ty);
+            tileX = tx;
+            tileY = ty;
+            haveLookup = true;
+        }
+
+        if (tile) {
+            Vector2D v = SampleTile(*tile, k0, k1, alpha, gx - tx * WIND_TILE_SIZE, gy - ty * WIND_TILE_SIZE);
+            outX[i] = v.x;
+            outY[i] = v.y;
+        } else {
+            outX[i] = base.x;
+            outY[i] = base.y;
+        }
+    }
+    
+    if (field.gusts) ApplyGusts(*field.gusts, xs, ys, count, GetGustOffset(field, time), outX, outY);
+}
@@ -0,0 +1,59 @@
+#ifndef WINDFIELD_H
+#define WINDFIELD_H
+
+#include "types.h"
+#include "gusts.h"
+
+const int WIND_TILE_SIZE = 16;                 // cells per tile side
+const int WIND_TILE_POINTS = WIND_TILE_SIZE + 1;  // samples per side, edges duplicated so tiles stand alone
+const int MAX_WIND_KEYFRAMES = 8;
+const int WIND_TILE_BUCKETS = 256;
+const int WIND_TILE_EVICT_TICKS = 600;         // streaming calls a tile may go untouched before it is freed
+
+// Wind vectors use the GetWindVector convention: the direction the air is moving
+typedef Vector2D (*WindFieldGenerator)(void* user, float x, float y, float time);
+
+struct WindTile {
+    int tx, ty;
+    int lastTouched;
+    WindTile* next;
+    Vector2D samples[MAX_WIND_KEYFRAMES][WIND_TILE_POINTS * WIND_TILE_POINTS];
+};
+
+// Wind over the race area as keyframed grids. Tiles are only baked (from the
+// generator) around boats; everywhere else the per-keyframe base wind applies.
+struct WindField {
+    float cellSize;
+    int keyframeCount;
+    float keyTimes[MAX_WIND_KEYFRAMES];
+    Vector2D baseWind[MAX_WIND_KEYFRAMES];
+    float period;                              // > 0 loops the keyframes, 0 holds the last one
+    
+    WindFieldGenerator generator;
+    void* generatorUser;
+    const GustModel* gusts;                    // optional, applied on top of every sample
+    Vector2D gustAnchor;                       // gust offset at gustAnchorTime, see AnchorWindFieldGusts
+    float gustAnchorTime;
+    
+    WindTile* buckets[WIND_TILE_BUCKETS];
+    int tileCount;
+    int tick;
+};
+
+void InitWindField(WindField& field, const Wind& wind, float cellSize);
+void SetWindFieldKeyframe(WindField& field, int index, float time, const Wind& baseWind);
+void SetWindFieldGenerator(WindField& field, WindFieldGenerator generator, void* user);
+void SetWindFieldGusts(WindField& field, const GustModel* gusts);
+// Fixes where the gusts are at `time`, so keyframes changed afterwards only move them from then on
+void AnchorWindFieldGusts(WindField& field, float time);
+void FreeWindField(WindField& field);
+
+void StreamWindFieldTiles(WindField& field, const Boat boats[], int count);
+Vector2D SampleWindField(const WindField& field, float x, float y, float time);
+Vector2D GetGustOffset(const WindField& field, float time);   // how far the gusts have drifted by `time`
+void SampleWindFieldBatch(const WindField& field, const float xs[], const float ys[], int count, float time,
+                          float outX[], float outY[]);
+
+Wind WindFromVector(const Vector2D& v);
+
+#endif
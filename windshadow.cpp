@@ -0,0 +1,91 @@
+#include "windshadow.h"
+#include <cmath>
+
+static void SplatShadowCone(WindShadowGrid& grid, const Boat& boat, Vector2D downwind) {
+    float length = boat.length * WIND_SHADOW_LENGTH;
+    float start = boat.length;   // cone starts a hull length back
+    float spread = tanf(WIND_SHADOW_HALF_ANGLE);
+    
+    // Cell range covering the cone's bounding box
+    float farHalfWidth = length * spread;
+    float tipX = boat.x + downwind.x * length;
+    float tipY = boat.y + downwind.y * length;
+    float minX = fminf(boat.x, tipX) - farHalfWidth;
+    float maxX = fmaxf(boat.x, tipX) + farHalfWidth;
+    float minY = fminf(boat.y, tipY) - farHalfWidth;
+    float maxY = fmaxf(boat.y, tipY) + farHalfWidth;
+    
+    int cx0 = (int)floorf((minX - grid.originX) / WIND_SHADOW_CELL);
+    int cx1 = (int)floorf((maxX - grid.originX) / WIND_SHADOW_CELL);
+    int cy0 = (int)floorf((minY - grid.originY) / WIND_SHADOW_CELL);
+    int cy1 = (int)floorf((maxY - grid.originY) / WIND_SHADOW_CELL);
+    if (cx0 < 0) cx0 = 0;
+    if (cy0 < 0) cy0 = 0;
+    if (cx1 >= WIND_SHADOW_GRID) cx1 = WIND_SHADOW_GRID - 1;
+    if (cy1 >= WIND_SHADOW_GRID) cy1 = WIND_SHADOW_GRID - 1;
+    
+    for (int cy = cy0; cy <= cy1; cy++) {
+        for (int cx = cx0; cx <= cx1; cx++) {
+            float px = grid.originX + (cx + 0.5f) * WIND_SHADOW_CELL - boat.x;
+            float py = grid.originY + (cy + 0.5f) * WIND_SHADOW_CELL - boat.y;
+            float along = px * downwind.x + py * downwind.y;
+            if (along < start || along > length) continue;
+            // The bilinear sample at the boat reads every cell whose center is within a cell of it
+            if (fabsf(px) < WIND_SHADOW_CELL && fabsf(py) < WIND_SHADOW_CELL) continue;
+            
+            float across = fabsf(px * downwind.y - py * downwind.x);
+            float halfWidth = along * spread;
+            if (across > halfWidth) continue;
+            
+            // Strongest on the centerline close behind, fading out to the edges and the tip
+            float deficit = WIND_SHADOW_MAX_DEFICIT * (1.0f - along / length) * (1.0f - across / halfWidth);
+            grid.factor[cy * WIND_SHADOW_GRID + cx] *= 1.0f - deficit;
+        }
+    }
+}
+
+void ClearWindShadow(WindShadowGrid& grid) {
+    grid.originX = grid.originY = -WIND_SHADOW_GRID * WIND_SHADOW_CELL * 0.5f;
+    for (int i = 0; i < WIND_SHADOW_GRID * WIND_SHADOW_GRID; i++) grid.factor[i] = 1.0f;
+}
+
+// windX/windY: true wind vector at each boat
+void BuildWindShadow(WindShadowGrid& grid, const Boat boats[], int count, const float windX[], const float windY[]) {
+    ClearWindShadow(grid);
+    if (count == 0) return;
+    
+    float minX = boats[0].x, maxX = boats[0].x;
+    float minY = boats[0].y, maxY = boats[0].y;
+    for (int i = 1; i < count; i++) {
+        minX = fminf(minX, boats[i].x);
+        maxX = fmaxf(maxX, boats[i].x);
+        minY = fminf(minY, boats[i].y);
+        maxY = fmaxf(maxY, boats[i].y);
+    }
+    float halfSpan = WIND_SHADOW_GRID * WIND_SHADOW_CELL * 0.5f;
+    grid.originX = floorf(((minX + maxX) * 0.5f - halfSpan) / WIND_SHADOW_CELL) * WIND_SHADOW_CELL;
+    grid.originY = floorf(((minY + maxY) * 0.5f - halfSpan) / WIND_SHADOW_CELL) * WIND_SHADOW_CELL;
+    
+    for (int i = 0; i < count; i++) {
+        Vector2D downwind = Vector2D(windX[i], windY[i]).normalized();
+        if (downwind.x == 0.0f && downwind.y == 0.0f) continue;
+        SplatShadowCone(grid, boats[i], downwind);
+    }
+}
+
+float SampleWindShadow(const WindShadowGrid& grid, float x, float y) {
+    // Bilinear between cell centers
+    float gx = (x - grid.originX) / WIND_SHADOW_CELL - 0.5f;
+    float gy = (y - grid.originY) / WIND_SHADOW_CELL - 0.5f;
+    int x0 = (int)floorf(gx);
+    int y0 = (int)floorf(gy);
+    if (x0 < 0 || y0 < 0 || x0 >= WIND_SHADOW_GRID - 1 || y0 >= WIND_SHADOW_GRID - 1) return 1.0f;
+    
+    float fx = gx - x0;
+    float fy = gy - y0;
+    const float* row0 = grid.factor + y0 * WIND_SHADOW_GRID + x0;
+    const float* row1 = row0 + WIND_SHADOW_GRID;
+    float top = row0[0] + (row0[1] - row0[0]) * fx;
+    float bottom = row1[0] + (row1[1] - row1[0]) * fx;
+    return top + (bottom - top) * fy;
+}
@@ -0,0 +1,23 @@
+#ifndef WINDSHADOW_H
+#define WINDSHADOW_H
+
+#include "types.h"
+
+const int WIND_SHADOW_GRID = 128;             // cells per side
+const float WIND_SHADOW_CELL = 4.0f;          // meters, so the grid spans 512 m
+const float WIND_SHADOW_LENGTH = 8.0f;        // cone length in boat lengths
+const float WIND_SHADOW_HALF_ANGLE = 0.35f;   // radians either side of dead downwind
+const float WIND_SHADOW_MAX_DEFICIT = 0.35f;  // speed lost right behind the sail
+
+// Fraction of the true wind left in each cell (1 = clean air). The grid is
+// recentered on the fleet every tick and boats outside it sail in clean air.
+struct WindShadowGrid {
+    float originX, originY;   // world position of cell (0, 0)'s corner
+    float factor[WIND_SHADOW_GRID * WIND_SHADOW_GRID];
+};
+
+void ClearWindShadow(WindShadowGrid& grid);   // clean air everywhere
+void BuildWindShadow(WindShadowGrid& grid, const Boat boats[], int count, const float windX[], const float windY[]);
+float SampleWindShadow(const WindShadowGrid& grid, float x, float y);
+
+#endif
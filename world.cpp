@@ -0,0 +1,268 @@
+#include "world.h"
+#include "boat.h"
+#include "physics.h"
+#include <cmath>
+#include <cstdlib>
+
+void InitWorld(World& world) {
+    world.boatCount = 0;
+    world.contactCount = 0;
+    world.groundedCount = 0;
+    world.coast = nullptr;
+    world.course = nullptr;
+    world.hash.cellSize = 1.0f;
+    ClearWindShadow(world.shadow);
+}
+
+int AddBoat(World& world, const Boat& boat) {
+    if (world.boatCount >= MAX_BOATS) return -1;
+    world.boats[world.boatCount] = boat;
+    world.windX[world.boatCount] = 0.0f;
+    world.windY[world.boatCount] = 0.0f;
+    world.landFactor[world.boatCount] = 1.0f;
+    ResetCourseProgress(world.progress[world.boatCount], boat);
+    return world.boatCount++;
+}
+
+// Boats abreast along a line through (centerX, centerY), all on the same heading
+void SpawnStartLine(World& world, int count, float centerX, float centerY, float lineDirection, float spacing, float heading) {
+    float dirX = sinf(lineDirection);
+    float dirY = cosf(lineDirection);
+    
+    for (int i = 0; i < count; i++) {
+        float offset = (i - (count - 1) * 0.5f) * spacing;
+        Boat boat;
+        InitBoat(boat);
+        boat.x = centerX + dirX * offset;
+        boat.y = centerY + dirY * offset;
+        boat.heading = heading;
+        if (AddBoat(world, boat) < 0) return;
+    }
+}
+
+// Everyone starts the course from scratch
+void SetWorldCourse(World& world, const Course* course) {
+    world.course = course;
+    for (int i = 0; i < world.boatCount; i++) ResetCourseProgress(world.progress[i], world.boats[i]);
+}
+
+static unsigned int HashCell(int cx, int cy) {
+    return ((unsigned int)cx * 73856093u ^ (unsigned int)cy * 19349663u) & (SPATIAL_HASH_BUCKETS - 1);
+}
+
+void RebuildSpatialHash(SpatialHash& hash, const Boat boats[], int count) {
+    // Any two touching hulls are within one cell of each other
+    float maxLength = 0.0f;
+    for (int i = 0; i < count; i++) maxLength = fmaxf(maxLength, boats[i].length);
+    hash.cellSize = fmaxf(maxLength, HULL_BEAM);
+    float invCell = 1.0f / hash.cellSize;
+    
+    for (int b = 0; b <= SPATIAL_HASH_BUCKETS; b++) hash.cellStart[b] = 0;
+    
+    for (int i = 0; i < count; i++) {
+        hash.cellX[i] = (int)floorf(boats[i].x * invCell);
+        hash.cellY[i] = (int)floorf(boats[i].y * invCell);
+        hash.cellStart[HashCell(hash.cellX[i], hash.cellY[i]) + 1]++;
+    }
+    for (int b = 0; b < SPATIAL_HASH_BUCKETS; b++) hash.cellStart[b + 1] += hash.cellStart[b];
+    
+    // cellStart[b] doubles as the write cursor, then gets shifted back into place
+    for (int i = 0; i < count; i++) {
+        unsigned int bucket = HashCell(hash.cellX[i], hash.cellY[i]);
+        hash.entries[hash.cellStart[bucket]++] = i;
+    }
+    for (int b = SPATIAL_HASH_BUCKETS; b > 0; b--) hash.cellStart[b] = hash.cellStart[b - 1];
+    hash.cellStart[0] = 0;
+}
+
+// Closest points between segments p1-q1 and p2-q2 (Ericson, Real-Time Collision Detection 5.1.9)
+static void ClosestSegmentPoints(Vector2D p1, Vector2D q1, Vector2D p2, Vector2D q2, Vector2D& c1, Vector2D& c2) {
+    Vector2D d1 = q1 - p1;
+    Vector2D d2 = q2 - p2;
+    Vector2D r = p1 - p2;
+    float a = d1.x*d1.x + d1.y*d1.y;
+    float e = d2.x*d2.x + d2.y*d2.y;
+    float f = d2.x*r.x + d2.y*r.y;
+    float s, t;
+    
+    if (a <= 1e-6f && e <= 1e-6f) {
+        c1 = p1;
+        c2 = p2;
+        return;
+    }
+    if (a <= 1e-6f) {
+        s = 0.0f;
+        t = fminf(fmaxf(f / e, 0.0f), 1.0f);
+    } else {
+        float c = d1.x*r.x + d1.y*r.y;
+        if (e <= 1e-6f) {
+            t = 0.0f;
+            s = fminf(fmaxf(-c / a, 0.0f), 1.0f);
+        } else {
+            float b = d1.x*d2.x + d1.y*d2.y;
+            float denom = a*e - b*b;
+            s = denom != 0.0f ? fminf(fmaxf((b*f - c*e) / denom, 0.0f), 1.0f) : 0.0f;
+            t = (b*s + f) / e;
+            if (t < 0.0f) {
+                t = 0.0f;
+                s = fminf(fmaxf(-c / a, 0.0f), 1.0f);
+            } else if (t > 1.0f) {
+                t = 1.0f;
+                s = fminf(fmaxf((b - c) / a, 0.0f), 1.0f);
+            }
+        }
+    }
+    c1 = p1 + d1 * s;
+    c2 = p2 + d2 * t;
+}
+
+static void HullSegment(const Boat& boat, Vector2D& bow, Vector2D& stern) {
+    float half = fmaxf(boat.length * 0.5f - HULL_BEAM * 0.5f, 0.0f);
+    Vector2D axis(sinf(boat.heading) * half, cosf(boat.heading) * half);
+    Vector2D center(boat.x, boat.y);
+    bow = center + axis;
+    stern = center - axis;
+}
+
+static bool CollideHulls(Boat& a, Boat& b) {
+    Vector2D bowA, sternA, bowB, sternB, closestA, closestB;
+    HullSegment(a, bowA, sternA);
+    HullSegment(b, bowB, sternB);
+    ClosestSegmentPoints(sternA, bowA, sternB, bowB, closestA, closestB);
+    
+    Vector2D delta = closestB - closestA;
+    float dist = delta.magnitude();
+    if (dist >= HULL_BEAM) return false;
+    
+    // Normal from a to b; fall back to the center line when the centerlines cross
+    Vector2D normal = dist > 1e-5f ? delta * (1.0f / dist) : (Vector2D(b.x - a.x, b.y - a.y)).normalized();
+    if (normal.x == 0.0f && normal.y == 0.0f) normal = Vector2D(1.0f, 0.0f);
+    
+    // Push apart half each, then remove the approaching velocity, shared by mass
+    const float SLOP = 0.01f;
+    float correction = fmaxf(HULL_BEAM - dist - SLOP, 0.0f) * 0.5f;
+    a.x -= normal.x * correction;
+    a.y -= normal.y * correction;
+    b.x += normal.x * correction;
+    b.y += normal.y * correction;
+    
+    float approach = (b.vx - a.vx) * normal.x + (b.vy - a.vy) * normal.y;
+    if (approach < 0.0f) {
+        float invMassA = GetBoatCoefficients(a.boatClass).inverseMass;
+        float invMassB = GetBoatCoefficients(b.boatClass).inverseMass;
+        float impulse = -(1.0f + COLLISION_RESTITUTION) * approach / (invMassA + invMassB);
+        a.vx -= normal.x * impulse * invMassA;
+        a.vy -= normal.y * impulse * invMassA;
+        b.vx += normal.x * impulse * invMassB;
+        b.vy += normal.y * impulse * invMassB;
+    }
+    return true;
+}
+
+int ResolveBoatCollisions(World& world) {
+    SpatialHash& hash = world.hash;
+    int contacts = 0;
+    
+    for (int i = 0; i < world.boatCount; i++) {
+        unsigned int visited[9];
+        int visitedCount = 0;
+        
+        for (int oy = -1; oy <= 1; oy++) {
+            for (int ox = -1; ox <= 1; ox++) {
+                unsigned int bucket = HashCell(hash.cellX[i] + ox, hash.cellY[i] + oy);
+                
+                // Two neighbour cells can land in the same bucket; scan it once
+                bool seen = false;
+                for (int v = 0; v < visitedCount; v++) seen = seen || visited[v] == bucket;
+                if (seen) continue;
+                visited[visitedCount++] = bucket;
+                
+                for (int e = hash.cellStart[bucket]; e < hash.cellStart[bucket + 1]; e++) {
+                    int j = hash.entries[e];
+                    if (j <= i) continue;
+                    // Bucket collisions bring in far cells too; the cell check rejects them cheaply
+                    if (abs(hash.cellX[j] - hash.cellX[i]) > 1 || abs(hash.cellY[j] - hash.cellY[i]) > 1) continue;
+                    if (CollideHulls(world.boats[i], world.boats[j])) contacts++;
+                }
+            }
+        }
+    }
+    return contacts;
+}
+
+// Bow, middle and stern circles against the distance field: any that are closer to
+// the shore than half the beam push the whole boat out and lose their shoreward speed
+int ResolveGrounding(World& world, float dt) {
+    if (!world.coast) return 0;
+    const Coastline& coast = *world.coast;
+    const float radius = HULL_BEAM * 0.5f;
+    int grounded = 0;
+    
+    for (int i = 0; i < world.boatCount; i++) {
+        Boat& boat = world.boats[i];
+        // Far from land a single lookup is enough to skip the boat
+        if (GetShoreDistance(coast, boat.x, boat.y) > boat.length) continue;
+    
+        Vector2D bow, stern;
+        HullSegment(boat, bow, stern);
+        // Offsets from the center, since each push moves the boat before the next point is tested
+        Vector2D offsets[3] = {bow - Vector2D(boat.x, boat.y), Vector2D(0.0f, 0.0f), stern - Vector2D(boat.x, boat.y)};
+        bool touched = false;
+    
+        for (int p = 0; p < 3; p++) {
+            Vector2D point = Vector2D(boat.x, boat.y) + offsets[p];
+            float depth = radius - GetShoreDistance(coast, point.x, point.y);
+            if (depth <= 0.0f) continue;
+    
+            Vector2D normal = GetShoreNormal(coast, point.x, point.y);
+            boat.x += normal.x * depth;
+            boat.y += normal.y * depth;
+            float into = boat.vx * normal.x + boat.vy * normal.y;
+            if (into < 0.0f) {
+                boat.vx -= normal.x * into;
+                boat.vy -= normal.y * into;
+            }
+            touched = true;
+        }
+    
+        if (touched) {
+            float drag = expf(-GROUNDING_DRAG * dt);
+            boat.vx *= drag;
+            boat.vy *= drag;
+            grounded++;
+        }
+    }
+    return grounded;
+}
+
+// True wind at a boat after land and the fleet's dirty air, as of the last UpdateWorld
+Wind GetBoatWind(const World& world, int index) {
+    const Boat& boat = world.boats[index];
+    Wind local = WindFromVector(Vector2D(world.windX[index], world.windY[index]));
+    local.speed *= SampleWindShadow(world.shadow, boat.x, boat.y) * world.landFactor[index];
+    return local;
+}
+
+void UpdateWorld(World& world, WindField& field, float time, float dt) {
+    StreamWindFieldTiles(field, world.boats, world.boatCount);
+    for (int i = 0; i < world.boatCount; i++) {
+        world.sampleX[i] = world.boats[i].x;
+        world.sampleY[i] = world.boats[i].y;
+    }
+    SampleWindFieldBatch(field, world.sampleX, world.sampleY, world.boatCount, time, world.windX, world.windY);
+    if (world.coast) {
+        for (int i = 0; i < world.boatCount; i++) {
+            world.landFactor[i] = GetLandWindFactor(*world.coast, world.sampleX[i], world.sampleY[i], world.windX[i], world.windY[i]);
+        }
+    }
+    
+    // Shadows come from the start-of-tick positions so update order doesn't matter
+    BuildWindShadow(world.shadow, world.boats, world.boatCount, world.windX, world.windY);
+    for (int i = 0; i < world.boatCount; i++) {
+        UpdateBoat(world.boats[i], GetBoatWind(world, i), dt);
+    }
+    RebuildSpatialHash(world.hash, world.boats, world.boatCount);
+    world.contactCount = ResolveBoatCollisions(world);
+    world.groundedCount = ResolveGrounding(world, dt);
+    if (world.course) UpdateCourseProgress(*world.course, world.boats, world.progress, world.boatCount, time, dt);
+}
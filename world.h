@@ -0,0 +1,51 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include "types.h"
+#include "windshadow.h"
+#include "windfield.h"
+#include "coastline.h"
+#include "course.h"
+
+const int MAX_BOATS = 512;
+const int SPATIAL_HASH_BUCKETS = 2048;     // power of two
+const float HULL_BEAM = 1.6f;              // capsule diameter around the hull centerline
+const float COLLISION_RESTITUTION = 0.2f;
+const float GROUNDING_DRAG = 3.0f;           // 1/s, how quickly a boat scraping along the shore stops
+
+// Uniform grid hashed into a fixed bucket table, rebuilt from scratch every tick
+// with a counting sort so insert cost is O(N) and there is nothing to update incrementally
+struct SpatialHash {
+    float cellSize;
+    int cellStart[SPATIAL_HASH_BUCKETS + 1];
+    int entries[MAX_BOATS];       // boat indices grouped by bucket
+    int cellX[MAX_BOATS];
+    int cellY[MAX_BOATS];
+};
+
+struct World {
+    Boat boats[MAX_BOATS];
+    int boatCount;
+    SpatialHash hash;
+    WindShadowGrid shadow;
+    float sampleX[MAX_BOATS], sampleY[MAX_BOATS];   // boat positions gathered for batch wind queries
+    float windX[MAX_BOATS], windY[MAX_BOATS];       // true wind at each boat this tick
+    float landFactor[MAX_BOATS];                    // wind left after blanketing by land upwind
+    const Coastline* coast;       // optional, open water when null
+    const Course* course;         // optional, no race when null
+    CourseProgress progress[MAX_BOATS];
+    int contactCount;             // contacts resolved in the last tick
+    int groundedCount;            // boats pushed off the shore in the last tick
+};
+
+void InitWorld(World& world);
+int AddBoat(World& world, const Boat& boat);
+void SpawnStartLine(World& world, int count, float centerX, float centerY, float lineDirection, float spacing, float heading);
+void SetWorldCourse(World& world, const Course* course);
+void UpdateWorld(World& world, WindField& field, float time, float dt);
+Wind GetBoatWind(const World& world, int index);
+void RebuildSpatialHash(SpatialHash& hash, const Boat boats[], int count);
+int ResolveBoatCollisions(World& world);
+int ResolveGrounding(World& world, float dt);
+
+#endif